@@ -0,0 +1,156 @@
+#version 330 core
+
+out vec4 FragColor;
+
+uniform vec3  iResolution;   // frame resolution (in pixels)
+uniform float iTime;         // play time (in seconds)
+uniform int   iFrame;        // frame number (at 30 fps)
+uniform int   iPattern;      // index of pattern (see Pattern::patterns_)
+
+const float PI = 3.14159265359;
+
+// pixel coordinates from top left corner (rows of texture are top-down)
+vec2 pixel()
+{
+    return floor(gl_FragCoord.xy);
+}
+
+// pseudo random value in [0 1] for a pixel and a frame
+float noise(vec2 p, int f)
+{
+    vec3 q = fract( vec3(p.xyx + float(f) * vec3(17.0, 59.0, 83.0)) * vec3(0.1031, 0.1030, 0.0973) );
+    q += dot(q, q.yxz + 33.33);
+    return fract( (q.x + q.y) * q.z );
+}
+
+// vertical bars of given colors
+vec3 bars(float x, vec3 colors[7])
+{
+    return colors[ clamp( int(x * 7.0), 0, 6 ) ];
+}
+
+// SMPTE color bars
+vec3 smpte(vec2 uv)
+{
+    vec3 top[7] = vec3[7]( vec3(0.75), vec3(0.75, 0.75, 0.0), vec3(0.0, 0.75, 0.75), vec3(0.0, 0.75, 0.0),
+                           vec3(0.75, 0.0, 0.75), vec3(0.75, 0.0, 0.0), vec3(0.0, 0.0, 0.75) );
+    vec3 middle[7] = vec3[7]( vec3(0.0, 0.0, 0.75), vec3(0.075), vec3(0.75, 0.0, 0.75), vec3(0.075),
+                              vec3(0.0, 0.75, 0.75), vec3(0.075), vec3(0.75) );
+    if (uv.y < 0.67)
+        return bars(uv.x, top);
+    if (uv.y < 0.75)
+        return bars(uv.x, middle);
+
+    // -I, white, +Q, black, and pluge (below black, black, above black)
+    float x = uv.x * 7.0;
+    if (x < 1.25)
+        return vec3(0.0, 0.13, 0.3);
+    if (x < 2.5)
+        return vec3(1.0);
+    if (x < 3.75)
+        return vec3(0.2, 0.0, 0.42);
+    if (x < 5.0)
+        return vec3(0.075);
+    if (x < 5.33)
+        return vec3(0.035);
+    if (x < 5.67)
+        return vec3(0.075);
+    if (x < 6.0)
+        return vec3(0.115);
+    return vec3(0.075);
+}
+
+// phase of a zone plate (as videotestsrc with kx2 = width/10, ky2 = height/10, kt = 4)
+float zoneplate(vec2 p)
+{
+    vec2 c = (p - 0.5 * iResolution.xy) / iResolution.xy;
+    return PI * ( 0.1 * iResolution.x * c.x * c.x + 0.1 * iResolution.y * c.y * c.y ) * 2.0 + 4.0 * PI * float(iFrame) / 30.0;
+}
+
+// anti-aliased disk
+float disk(vec2 p, vec2 center, float radius)
+{
+    return 1.0 - smoothstep(radius - 1.0, radius + 1.0, distance(p, center));
+}
+
+void main()
+{
+    vec2 p = pixel();
+    vec2 uv = (p + 0.5) / iResolution.xy;
+    vec2 c = p + 0.5 - 0.5 * iResolution.xy;
+    float a = atan(c.y, c.x) / (2.0 * PI) + 0.5;
+    vec3 color = vec3(0.0);
+
+    switch (iPattern) {
+    case 1:  // White
+        color = vec3(1.0);
+        break;
+    case 2:  // Gradient
+        color = vec3(uv.y);
+        break;
+    case 3:  // Checkers 1x1 px
+        color = vec3( mod(p.x + p.y, 2.0) );
+        break;
+    case 4:  // Checkers 8x8 px
+        color = vec3( mod(floor(p.x / 8.0) + floor(p.y / 8.0), 2.0) );
+        break;
+    case 5:  // Circles
+        color = vec3( 0.5 + 0.5 * cos( 40.0 * PI * dot(c, c) / (iResolution.y * iResolution.y) ) );
+        break;
+    case 7:  // Pinwheel
+        color = vec3( step(0.5, fract(a * 10.0)) );
+        break;
+    case 8:  // Spokes
+        color = vec3( 1.0 - smoothstep(0.5, 1.5, min(fract(a * 24.0), 1.0 - fract(a * 24.0)) * 2.0 * PI * length(c) / 24.0 ) );
+        break;
+    case 9:  // Red
+        color = vec3(1.0, 0.0, 0.0);
+        break;
+    case 10: // Green
+        color = vec3(0.0, 1.0, 0.0);
+        break;
+    case 11: // Blue
+        color = vec3(0.0, 0.0, 1.0);
+        break;
+    case 12: // Color bars
+        color = bars(uv.x, vec3[7]( vec3(1.0), vec3(1.0, 1.0, 0.0), vec3(0.0, 1.0, 1.0), vec3(0.0, 1.0, 0.0),
+                                    vec3(1.0, 0.0, 1.0), vec3(1.0, 0.0, 0.0), vec3(0.0, 0.0, 1.0) ));
+        break;
+    case 13: // RGB grid
+        color = vec3( mod(p.x, 256.0) / 255.0, mod(p.y, 256.0) / 255.0,
+                      mod(floor(p.x / 256.0) + 4.0 * floor(p.y / 256.0), 8.0) / 7.0 );
+        break;
+    case 14: // SMPTE test
+        color = smpte(uv);
+        break;
+    case 15: // Television snow
+        color = vec3( noise(p, iFrame) );
+        break;
+    case 16: // Blink
+        color = vec3( float(iFrame % 2) );
+        break;
+    case 17: // Fresnel zone plate
+        color = vec3( 0.5 + 0.5 * cos(zoneplate(p)) );
+        break;
+    case 18: // Chroma zone plate
+        color = 0.5 + 0.5 * cos( zoneplate(p) + vec3(0.0, 2.0 * PI / 3.0, 4.0 * PI / 3.0) );
+        break;
+    case 19: // Bar moving (5 pixels per frame)
+        color = vec3( step( mod(p.x - 5.0 * float(iFrame), iResolution.x), 0.1 * iResolution.x ) );
+        break;
+    case 20: // Ball bouncing
+        color = vec3( disk(p + 0.5, 0.5 * iResolution.xy + vec2(0.4, 0.35) * iResolution.xy *
+                           vec2(sin(iTime * 1.3), sin(iTime * 1.9)), 0.05 * min(iResolution.x, iResolution.y)) );
+        break;
+    case 25: // Frame
+        color = vec3( 1.0 - step(10.0, min( min(p.x, iResolution.x - 1.0 - p.x), min(p.y, iResolution.y - 1.0 - p.y) )) );
+        break;
+    case 30: // RGB noise
+        color = 0.6 * vec3( noise(p, iFrame), noise(p, iFrame + 1), noise(p, iFrame + 2) );
+        break;
+    default: // Black
+        break;
+    }
+
+    FragColor = vec4(color, 1.0);
+}
@@ -0,0 +1,19 @@
+#version 330 core
+
+out vec4 FragColor;
+
+uniform sampler2D iChannel0;   // Y plane
+uniform sampler2D iChannel1;   // U plane
+uniform sampler2D iChannel2;   // V plane
+uniform vec3 iResolution;      // frame resolution (in pixels)
+uniform mat4 iConversion;      // YUV to RGB colorimetry matrix
+
+// Render the RGB image of a planar YUV frame, from one single channel
+// texture per plane (chroma planes are interpolated from lower resolution)
+void main()
+{
+    vec2 uv = gl_FragCoord.xy / iResolution.xy;
+    vec4 yuv = vec4( texture(iChannel0, uv).r, texture(iChannel1, uv).r, texture(iChannel2, uv).r, 1.0 );
+
+    FragColor = vec4( clamp( (iConversion * yuv).rgb, 0.0, 1.0), 1.0 );
+}
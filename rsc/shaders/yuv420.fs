@@ -0,0 +1,42 @@
+#version 330 core
+
+out vec4 FragColor;
+
+uniform sampler2D iChannel0;   // input RGB frame
+uniform vec3 iResolution;      // input frame resolution (in pixels)
+
+// RGB to YUV BT.709 coefficients (limited range)
+const vec3 Ycoef = vec3( 0.1826,  0.6142,  0.0620);
+const vec3 Ucoef = vec3(-0.1006, -0.3386,  0.4392);
+const vec3 Vcoef = vec3( 0.4392, -0.3989, -0.0403);
+
+// Render the I420 planar image of a frame (width x height) into a single
+// channel target of size (width x 3/2 height), in the exact memory layout
+// of a GStreamer I420 buffer: Y plane, followed by U and V planes
+void main()
+{
+    ivec2 p = ivec2(gl_FragCoord.xy);
+    int w = int(iResolution.x);
+    int h = int(iResolution.y);
+    float value = 0.0;
+
+    // Y plane : one luma per pixel
+    if (p.y < h) {
+        vec3 rgb = texture(iChannel0, (vec2(p) + 0.5) / iResolution.xy).rgb;
+        value = dot(rgb, Ycoef) + 0.0625;
+    }
+    // U and V planes : one chroma per block of 2x2 pixels, half width rows
+    else {
+        int i = (p.y - h) * w + p.x;
+        int plane = (w / 2) * (h / 2);
+        bool v = i >= plane;
+        if (v)
+            i -= plane;
+        ivec2 c = ivec2( i % (w / 2), i / (w / 2) );
+        // linear sampling at the center of the block averages the 4 pixels
+        vec3 rgb = texture(iChannel0, vec2(c * 2 + 1) / iResolution.xy).rgb;
+        value = dot(rgb, v ? Vcoef : Ucoef) + 0.5;
+    }
+
+    FragColor = vec4(value, 0.0, 0.0, 1.0);
+}
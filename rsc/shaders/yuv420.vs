@@ -0,0 +1,10 @@
+#version 330 core
+
+// full screen triangle generated from the vertex index (no vertex attribute)
+void main()
+{
+    vec2 pos = vec2( float(gl_VertexID & 1) * 4.0 - 1.0, float(gl_VertexID & 2) * 2.0 - 1.0 );
+
+    // output
+    gl_Position = vec4(pos, 0.0, 1.0);
+}
@@ -19,6 +19,8 @@
 
 #include <string>
 #include <thread>
+#include <map>
+#include <zlib.h>
 
 #include "Log.h"
 #include "View.h"
@@ -37,13 +39,82 @@
 #define ACTION_DEBUG
 #endif
 
-#define HISTORY_NODE(i) std::to_string(i).insert(0,1,'H')
-
 using namespace tinyxml2;
 
 
-Action::Action(): history_step_(0), history_max_step_(0), locked_(false),
-    snapshot_id_(0), snapshot_node_(nullptr), interpolator_(nullptr), interpolator_node_(nullptr)
+// HistoryBlob holds a zlib compressed binary description of a source (or a jpeg thumbnail)
+// Blobs are shared between history steps: a step only allocates new blobs
+// for the sources that changed since the previous step.
+struct HistoryBlob
+{
+    static std::atomic<size_t> allocated;
+
+    std::vector<unsigned char> data;
+    size_t size;
+    size_t hash;
+
+    HistoryBlob(const std::string &text) : size(text.size()), hash(std::hash<std::string>{}(text))
+    {
+        uLongf compressed_size = compressBound(size);
+        data.resize(compressed_size);
+        if ( Z_OK == compress2(data.data(), &compressed_size, (const Bytef *) text.data(), size, Z_BEST_SPEED) )
+            data.resize(compressed_size);
+        else
+            data.clear();
+        data.shrink_to_fit();
+        allocated += data.size();
+    }
+
+    HistoryBlob(const unsigned char *buffer, size_t len) : data(buffer, buffer + len), size(0), hash(0)
+    {
+        allocated += data.size();
+    }
+
+    ~HistoryBlob()
+    {
+        allocated -= data.size();
+    }
+
+    std::string text() const
+    {
+        std::string t(size, '\0');
+        uLongf uncompressed_size = size;
+        if ( data.empty() || Z_OK != uncompress((Bytef *) &t[0], &uncompressed_size, data.data(), data.size()) )
+            t.clear();
+        return t;
+    }
+};
+
+std::atomic<size_t> HistoryBlob::allocated(0);
+
+struct HistoryStep
+{
+    std::string label;
+    int view;
+    float threshold;
+    bool captured;
+    std::shared_ptr<HistoryBlob> thumbnail;
+    std::vector< std::pair< uint64_t, std::shared_ptr<HistoryBlob> > > sources;
+
+    HistoryStep(const std::string &l) : label(l), view(View::MIXING), threshold(MIXING_MIN_THRESHOLD), captured(false) {}
+
+    // memory freed if this step is deleted (blobs not shared with other steps)
+    size_t owned() const
+    {
+        size_t s = 0;
+        if (thumbnail && thumbnail.use_count() == 1)
+            s += thumbnail->data.size();
+        for (auto it = sources.begin(); it != sources.end(); ++it) {
+            if (it->second.use_count() == 1)
+                s += it->second->data.size();
+        }
+        return s;
+    }
+};
+
+Action::Action(): history_step_(0), history_max_step_(0), locked_(false), coalesce_id_(0),
+    snapshot_id_(0), snapshot_node_(nullptr), interpolator_(nullptr),
+    interpolator_from_(0), interpolator_to_(0), interpolator_session_(0)
 {
 
 }
@@ -51,26 +122,46 @@ Action::Action(): history_step_(0), history_max_step_(0), locked_(false),
 void Action::init()
 {
     // clean the history
-    history_doc_.Clear();
+    history_mutex_.lock();
+    history_.clear();
     history_step_ = 0;
     history_max_step_ = 0;
+    history_mutex_.unlock();
+    coalesce_id_ = 0;
+    coalesce_kind_.clear();
 
     // reset snapshot
     snapshot_id_ = 0;
     snapshot_node_ = nullptr;
+    snapshot_cores_.clear();
+    if (interpolator_) {
+        delete interpolator_;
+        interpolator_ = nullptr;
+    }
 
     store("Session start");
 }
 
+// compact binary description of a source
+std::string sourceToBinary(Source *s)
+{
+    XMLDocument doc;
+    XMLElement *root = doc.NewElement("H");
+    doc.InsertEndChild(root);
+    SessionVisitor sv(&doc, root);
+    s->accept(sv);
+
+    return XMLToBinary(root);
+}
+
 // must be called in a thread running in parrallel of the rendering
 // (needs opengl update to get thumbnail)
 void captureMixerSession(Session *se, tinyxml2::XMLDocument *doc, std::string node, std::string label)
 {
     if (se != nullptr) {
 
-        // create node
+        // create node (inserted in document once complete)
         XMLElement *sessionNode = doc->NewElement( node.c_str() );
-        doc->InsertEndChild(sessionNode);
         // label describes the action
         sessionNode->SetAttribute("label", label.c_str() );
         // label describes the action
@@ -95,34 +186,110 @@ void captureMixerSession(Session *se, tinyxml2::XMLDocument *doc, std::string no
         for (auto iter = se->begin(); iter != se->end(); ++iter, sv.setRoot(sessionNode) )
             (*iter)->accept(sv);
 
+        doc->InsertEndChild(sessionNode);
     }
 }
 
-void Action::store(const std::string &label)
+
+// must be called in a thread running in parrallel of the rendering
+// (needs opengl update to get thumbnail)
+void Action::capture(Session *se, std::shared_ptr<HistoryStep> step, std::shared_ptr<HistoryStep> previous)
 {
-    // TODO: set a maximum amount of stored steps? (even very big, just to ensure memory limit)
+    if (se == nullptr)
+        return;
+
+    // get the thumbnail (requires one opengl update to render)
+    std::shared_ptr<HistoryBlob> thumbnail;
+    FrameBufferImage *img = se->renderThumbnail();
+    if (img) {
+        FrameBufferImage::jpegBuffer jpgimg = img->getJpeg();
+        if (jpgimg.buffer != nullptr) {
+            thumbnail = std::make_shared<HistoryBlob>(jpgimg.buffer, jpgimg.len);
+            free(jpgimg.buffer);
+        }
+        delete img;
+    }
 
+    // get the description of sources in previous step
+    std::map< uint64_t, std::shared_ptr<HistoryBlob> > previous_sources;
+    history_mutex_.lock();
+    if (previous)
+        previous_sources.insert(previous->sources.begin(), previous->sources.end());
+    history_mutex_.unlock();
+
+    // serialize all sources using source visitor, and keep only
+    // the description of sources which changed since previous step
+    std::vector< std::pair< uint64_t, std::shared_ptr<HistoryBlob> > > sources;
+    for (auto iter = se->begin(); iter != se->end(); ++iter) {
+        std::string text = sourceToBinary(*iter);
+
+        auto p = previous_sources.find( (*iter)->id() );
+        if ( p != previous_sources.end() && p->second->size == text.size()
+             && p->second->hash == std::hash<std::string>{}(text) )
+            sources.push_back( { p->first, p->second } );
+        else
+            sources.push_back( { (*iter)->id(), std::make_shared<HistoryBlob>(text) } );
+    }
+
+    history_mutex_.lock();
+    // fill history step
+    step->view = (int) Mixer::manager().view()->mode();
+    step->threshold = se->activationThreshold();
+    step->thumbnail = thumbnail;
+    step->sources.swap(sources);
+    step->captured = true;
+    history_mutex_.unlock();
+}
+
+void Action::store(const std::string &label, uint64_t id, const std::string &kind)
+{
     // ignore if locked or if no label is given
     if (locked_ || label.empty())
         return;
 
-    // incremental naming of history nodes
-    history_step_++;
+    // rapid edits of the same kind are coalesced into the last step
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    bool coalesce = !kind.empty() && id == coalesce_id_ && kind == coalesce_kind_
+            && history_step_ > 1 && history_step_ == history_max_step_
+            && now - coalesce_time_ < std::chrono::milliseconds(Settings::application.action_history_coalesce);
+    coalesce_id_ = id;
+    coalesce_kind_ = kind;
+    coalesce_time_ = now;
+
+    std::shared_ptr<HistoryStep> step = std::make_shared<HistoryStep>(label);
+    std::shared_ptr<HistoryStep> previous;
+
+    history_mutex_.lock();
+    if (coalesce)
+        // replace last step
+        history_.pop_back();
+    else
+        // incremental naming of history steps
+        history_step_++;
 
     // erase future
-    for (uint e = history_step_; e <= history_max_step_; e++) {
-        XMLElement *node = history_doc_.FirstChildElement( HISTORY_NODE(e).c_str() );
-        if ( node )
-            history_doc_.DeleteChild(node);
-    }
+    history_.resize(history_step_ - 1);
+    if (!history_.empty())
+        previous = history_.back();
+    history_.push_back(step);
     history_max_step_ = history_step_;
 
+    // forget oldest steps to fit into the memory budget, as long as it frees
+    // memory (blobs can be shared with later steps); never forget the current step
+    size_t budget = (size_t) CLAMP(Settings::application.action_history_memory, 1, 4096) * 1048576;
+    while ( HistoryBlob::allocated > budget && history_step_ > 1 && history_.size() > 2
+            && history_.front()->owned() > 0 ) {
+        history_.pop_front();
+        history_step_--;
+        history_max_step_--;
+    }
+    history_mutex_.unlock();
+
     // threaded capturing state of current session
-    std::thread(captureMixerSession, Mixer::manager().session(), &history_doc_, HISTORY_NODE(history_step_), label).detach();
+    std::thread(&Action::capture, this, Mixer::manager().session(), step, previous).detach();
 
 #ifdef ACTION_DEBUG
-    Log::Info("Action stored %d '%s'", history_step_, label.c_str());
-//        XMLSaveDoc(&history_doc_, "/home/bhbn/history.xml");
+    Log::Info("Action %s %d '%s'", coalesce ? "coalesced" : "stored", history_step_, label.c_str());
 #endif
 }
 
@@ -161,11 +328,10 @@ std::string Action::label(uint s) const
 {
     std::string l = "";
 
-    if (s > 0 && s <= history_max_step_) {
-        const XMLElement *sessionNode = history_doc_.FirstChildElement( HISTORY_NODE(s).c_str());
-        if  (sessionNode)
-            l = sessionNode->Attribute("label");
-    }
+    std::lock_guard<std::mutex> lock(history_mutex_);
+    if (s > 0 && s <= history_.size())
+        l = history_[s-1]->label;
+
     return l;
 }
 
@@ -173,34 +339,83 @@ FrameBufferImage *Action::thumbnail(uint s) const
 {
     FrameBufferImage *img = nullptr;
 
-    if (s > 0 && s <= history_max_step_) {
-        const XMLElement *sessionNode = history_doc_.FirstChildElement( HISTORY_NODE(s).c_str());
-        if  (sessionNode)
-            img = SessionLoader::XMLToImage(sessionNode);
+    std::lock_guard<std::mutex> lock(history_mutex_);
+    if (s > 0 && s <= history_.size()) {
+        std::shared_ptr<HistoryBlob> t = history_[s-1]->thumbnail;
+        if (t) {
+            FrameBufferImage::jpegBuffer jpgimg;
+            jpgimg.buffer = t->data.data();
+            jpgimg.len = t->data.size();
+            img = new FrameBufferImage(jpgimg);
+        }
     }
 
     return img;
 }
 
+size_t Action::memory() const
+{
+    return HistoryBlob::allocated;
+}
+
 void Action::restore(uint target)
 {
     // lock
     locked_ = true;
 
-    // get history node of target step
+    std::list<std::string> texts;
+    XMLDocument xmlDoc;
+    XMLElement *sessionNode = nullptr;
+    SourceIdList unchanged;
+    int view = Settings::application.current_view;
+
+    // get history step of target
+    history_mutex_.lock();
     history_step_ = CLAMP(target, 1, history_max_step_);
-    XMLElement *sessionNode = history_doc_.FirstChildElement( HISTORY_NODE(history_step_).c_str() );
+    std::shared_ptr<HistoryStep> step = history_[history_step_ - 1];
+    if (step->captured) {
+
+        // sources of the session which description is identical in the step are unchanged
+        // (compared with the current state, which can differ from the last stored step)
+        std::map< uint64_t, std::shared_ptr<HistoryBlob> > step_sources(step->sources.begin(), step->sources.end());
+        Session *se = Mixer::manager().session();
+        for (auto iter = se->begin(); iter != se->end(); ++iter) {
+            auto p = step_sources.find( (*iter)->id() );
+            if ( p != step_sources.end() ) {
+                std::string text = sourceToBinary(*iter);
+                if ( p->second->size == text.size() && p->second->hash == std::hash<std::string>{}(text) )
+                    unchanged.push_back(p->first);
+            }
+        }
+
+        // rebuild xml description of the session
+        // (arrays are read in the binary descriptions, kept until restored)
+        XMLElement *root = xmlDoc.NewElement("H");
+        xmlDoc.InsertEndChild(root);
+        bool valid = true;
+        for (auto it = step->sources.begin(); it != step->sources.end(); ++it) {
+            texts.push_back( it->second->text() );
+            valid &= XMLFromBinary(root, texts.back().data(), texts.back().size(), true);
+        }
+
+        if ( !valid )
+            Log::Warning("Could not restore action '%s'.", step->label.c_str());
+        else {
+            sessionNode = root;
+            sessionNode->SetAttribute("activationThreshold", step->threshold);
+            if (Settings::application.action_history_follow_view)
+                view = step->view;
+        }
+    }
+    history_mutex_.unlock();
 
     if (sessionNode) {
 
         // ask view to refresh, and switch to action view if user prefers
-        int view = Settings::application.current_view ;
-        if (Settings::application.action_history_follow_view)
-            sessionNode->QueryIntAttribute("view", &view);
         Mixer::manager().setView( (View::Mode) view);
 
-        // actually restore
-        Mixer::manager().restore(sessionNode);
+        // actually restore, only applying changes to sources
+        Mixer::manager().restore(sessionNode, unchanged);
     }
 
     // free
@@ -256,8 +471,6 @@ void Action::open(uint64_t snapshotid)
             snapshot_id_ = snapshotid;
         else
             snapshot_id_ = 0;
-
-        interpolator_node_ = nullptr;
     }
 }
 
@@ -278,6 +491,7 @@ void Action::replace(uint64_t snapshotid)
         Session *se = Mixer::manager().session();
         if (se) {
             se->snapshots()->xmlDoc_->DeleteChild( snapshot_node_ );
+            forget(snapshot_id_);
 
             // threaded capture state of current session
             std::thread(captureMixerSession, se, se->snapshots()->xmlDoc_, SNAPSHOT_NODE(snapshot_id_), label).detach();
@@ -380,6 +594,7 @@ void Action::remove(uint64_t snapshotid)
         Session *se = Mixer::manager().session();
         se->snapshots()->xmlDoc_->DeleteChild( snapshot_node_ );
         se->snapshots()->keys_.remove( snapshot_id_ );
+        forget(snapshot_id_);
     }
 
     snapshot_node_ = nullptr;
@@ -404,63 +619,108 @@ void Action::restore(uint64_t snapshotid)
     store("Snapshot " + label(snapshot_id_));
 }
 
-float Action::interpolation()
+std::shared_ptr<SnapshotCore> Action::compile(uint64_t snapshotid)
 {
-    float ret = 0.f;
-    if ( interpolator_node_ == snapshot_node_  && interpolator_)
-        ret = interpolator_->current();
+    auto it = snapshot_cores_.find(snapshotid);
+    if (it != snapshot_cores_.end())
+        return it->second;
 
-    return ret;
+    // read the state of sources in the snapshot xml
+    std::shared_ptr<SnapshotCore> core;
+    Session *se = Mixer::manager().session();
+    XMLElement *snap = se->snapshots()->xmlDoc_->FirstChildElement( SNAPSHOT_NODE(snapshotid).c_str() );
+    if (snap) {
+        core = std::make_shared<SnapshotCore>();
+        XMLElement* N = snap->FirstChildElement("Source");
+        for( ; N ; N = N->NextSiblingElement("Source")) {
+            uint64_t id_xml_ = 0;
+            N->QueryUnsigned64Attribute("id", &id_xml_);
+            SessionLoader::XMLToSourcecore(N, core->sources[id_xml_]);
+        }
+        snapshot_cores_[snapshotid] = core;
+    }
+
+    return core;
 }
 
-void Action::interpolate(float val, uint64_t snapshotid)
+void Action::forget(uint64_t snapshotid)
 {
-    if (snapshotid > 0)
-        open(snapshotid);
+    snapshot_cores_.erase(snapshotid);
 
-    if (snapshot_node_) {
+    // interpolator is invalid if it uses this snapshot
+    if ( interpolator_ && (interpolator_from_ == snapshotid || interpolator_to_ == snapshotid) ) {
+        delete interpolator_;
+        interpolator_ = nullptr;
+    }
+}
 
-        if ( interpolator_node_ != snapshot_node_ ) {
+bool Action::prepareInterpolator(uint64_t from, uint64_t to)
+{
+    Session *se = Mixer::manager().session();
 
-            // change interpolator
-            if (interpolator_)
-                delete interpolator_;
+    // keep interpolator if unchanged (sources it holds are still in the session)
+    if ( interpolator_ && interpolator_from_ == from && interpolator_to_ == to
+         && interpolator_session_ == se->modified() )
+        return true;
+
+    // get start (current state if from is 0) and target of interpolation
+    std::shared_ptr<SnapshotCore> start;
+    std::shared_ptr<SnapshotCore> target = compile(to);
+    if (from > 0)
+        start = compile(from);
+    if ( !target || (from > 0 && !start) )
+        return false;
+
+    // (re)create interpolator
+    if (interpolator_)
+        interpolator_->clear();
+    else
+        interpolator_ = new Interpolator;
 
-            // create new interpolator
-            interpolator_ = new Interpolator;
+    for (auto t = target->sources.begin(); t != target->sources.end(); ++t) {
 
-            // current session
-            Session *se = Mixer::manager().session();
+        // check if a source with the given id exists in the session
+        SourceList::iterator sit = se->find(t->first);
+        if ( sit == se->end() )
+            continue;
 
-            XMLElement* N = snapshot_node_->FirstChildElement("Source");
-            for( ; N ; N = N->NextSiblingElement()) {
+        // add an interpolator for this source
+        std::map<uint64_t, SourceCore>::const_iterator f;
+        if ( start && (f = start->sources.find(t->first)) != start->sources.end() )
+            interpolator_->add(*sit, f->second, t->second);
+        else
+            interpolator_->add(*sit, t->second);
+    }
 
-                // check if a source with the given id exists in the session
-                uint64_t id_xml_ = 0;
-                N->QueryUnsigned64Attribute("id", &id_xml_);
-                SourceList::iterator sit = se->find(id_xml_);
+    interpolator_from_ = from;
+    interpolator_to_ = to;
+    interpolator_session_ = se->modified();
 
-                // a source with this id exists
-                if ( sit != se->end() ) {
-                    // read target in the snapshot xml
-                    SourceCore target;
-                    SessionLoader::XMLToSourcecore(N, target);
+    return true;
+}
 
-                    // add an interpolator for this source
-                    interpolator_->add(*sit, target);
-                }
-            }
+float Action::interpolation()
+{
+    float ret = 0.f;
+    if ( interpolator_ && interpolator_from_ == 0 && interpolator_to_ == snapshot_id_ )
+        ret = interpolator_->current();
 
-            // operate interpolation on opened snapshot
-            interpolator_node_ = snapshot_node_;
-        }
+    return ret;
+}
 
-        if (interpolator_) {
-//            Log::Info("Action::interpolate %f", val);
-            interpolator_->apply( val );
-        }
-    }
+void Action::interpolate(float val, uint64_t snapshotid)
+{
+    if (snapshotid > 0)
+        open(snapshotid);
 
+    if ( snapshot_node_ && prepareInterpolator(0, snapshot_id_) )
+        interpolator_->apply( val );
+}
+
+void Action::crossfade(float val, uint64_t from, uint64_t to)
+{
+    if ( from > 0 && to > 0 && from != to && prepareInterpolator(from, to) )
+        interpolator_->apply( val );
 }
 
 
@@ -480,7 +740,8 @@ static void saveSnapshot(const std::string& filename, tinyxml2::XMLElement *snap
 
     // load the file: is it a session?
     tinyxml2::XMLDocument xmlDoc;
-    XMLError eResult = xmlDoc.LoadFile(filename.c_str());
+    bool binary = false;
+    int eResult = XMLLoadDoc(&xmlDoc, filename, &binary);
     if ( XMLResultError(eResult)){
         Log::Warning("%s could not be opened for re-export.", filename.c_str());
         return;
@@ -507,7 +768,7 @@ static void saveSnapshot(const std::string& filename, tinyxml2::XMLElement *snap
     newfilename.insert(filename.size()-4, "_" + std::string(l));
 
     // save new file to disk
-    if ( XMLSaveDoc(&xmlDoc, newfilename) )
+    if ( XMLSaveDoc(&xmlDoc, newfilename, binary) )
         Log::Notify("Version exported to %s.", newfilename.c_str());
     else
         // error
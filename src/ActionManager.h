@@ -2,14 +2,21 @@
 #define ACTIONMANAGER_H
 
 #include <list>
+#include <deque>
 #include <string>
 #include <atomic>
+#include <mutex>
+#include <memory>
+#include <chrono>
+#include <map>
 
 #include <tinyxml2.h>
 
 class Session;
 class Interpolator;
+struct SnapshotCore;
 class FrameBufferImage;
+struct HistoryStep;
 
 class Action
 {
@@ -29,7 +36,8 @@ public:
     void init ();
 
     // Undo History
-    void store (const std::string &label);
+    // (rapid edits of the same kind on the same object id are coalesced)
+    void store (const std::string &label, uint64_t id = 0, const std::string &kind = "");
     void undo ();
     void redo ();
     void stepTo (uint target);
@@ -38,6 +46,7 @@ public:
     inline uint max () const { return history_max_step_; }
     std::string label (uint s) const;
     FrameBufferImage *thumbnail (uint s) const;
+    size_t memory () const;
 
     // Snapshots
     static void takeSnapshot (Session *se, const std::string &label, bool create_thread);
@@ -58,22 +67,39 @@ public:
     void setLabel (uint64_t snapshotid, const std::string &label);
     FrameBufferImage *thumbnail (uint64_t snapshotid) const;
 
+    // interpolate from current state to snapshot
     float interpolation ();
     void interpolate (float val, uint64_t snapshotid = 0);
+    // interpolate between two snapshots
+    void crossfade (float val, uint64_t from, uint64_t to);
 
 private:
 
-    tinyxml2::XMLDocument history_doc_;
+    std::deque< std::shared_ptr<HistoryStep> > history_;
+    mutable std::mutex history_mutex_;
     uint history_step_;
     uint history_max_step_;
     std::atomic<bool> locked_;
     void restore(uint target);
+    void capture(Session *se, std::shared_ptr<HistoryStep> step, std::shared_ptr<HistoryStep> previous);
+
+    uint64_t coalesce_id_;
+    std::string coalesce_kind_;
+    std::chrono::steady_clock::time_point coalesce_time_;
 
     uint64_t snapshot_id_;
     tinyxml2::XMLElement *snapshot_node_;
 
+    // snapshots read once from xml for interpolation
+    std::map< uint64_t, std::shared_ptr<SnapshotCore> > snapshot_cores_;
+    std::shared_ptr<SnapshotCore> compile (uint64_t snapshotid);
+    void forget (uint64_t snapshotid);
+
     Interpolator *interpolator_;
-    tinyxml2::XMLElement *interpolator_node_;
+    uint64_t interpolator_from_;
+    uint64_t interpolator_to_;
+    uint64_t interpolator_session_;
+    bool prepareInterpolator (uint64_t from, uint64_t to);
 
 };
 
@@ -0,0 +1,265 @@
+/*
+ * This file is part of vimix - video live mixer
+ *
+ * **Copyright** (C) 2019-2023 Bruno Herbelin <bruno.herbelin@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+**/
+
+
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#include <glm/gtc/constants.hpp>
+
+#include "defines.h"
+#include "Log.h"
+#include "SystemToolkit.h"
+#include "Mixer.h"
+#include "Session.h"
+#include "PatternSource.h"
+#include "CloneSource.h"
+#include "FrameBuffer.h"
+#include "FrameGrabber.h"
+#include "Recorder.h"
+#include "Profiler.h"
+
+#include "Benchmark.h"
+
+// frames rendered before measure, after the session is ready
+#define BENCHMARK_WARMUP 60
+// maximum time waiting for loading or for end of recording (seconds)
+#define BENCHMARK_TIMEOUT 30.0
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsed_ms(Clock::time_point begin, Clock::time_point end)
+{
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+//
+// Reference sessions
+//
+struct Reference {
+    const char *name;
+    glm::ivec2 resolution;
+    // animated patterns (see Pattern::patterns_)
+    std::vector<uint> patterns;
+    // filters of clones of the first pattern
+    std::vector<FrameBufferFilter::Type> clones;
+};
+
+static const std::vector<Reference> references_ = {
+    { "patterns", glm::ivec2(1280, 720), { 14, 15, 17, 18, 19, 20, 14, 15 }, { } },
+    { "fullhd",   glm::ivec2(1920, 1080), { 14, 17, 19, 20 }, { } },
+    { "clones",   glm::ivec2(1280, 720), { 17 }, { FrameBufferFilter::FILTER_BLUR,
+                                                   FrameBufferFilter::FILTER_SHARPEN,
+                                                   FrameBufferFilter::FILTER_SMOOTH,
+                                                   FrameBufferFilter::FILTER_EDGE,
+                                                   FrameBufferFilter::FILTER_PASSTHROUGH } },
+};
+
+std::list<std::string> Benchmark::references()
+{
+    std::list<std::string> names;
+    for (auto r = references_.begin(); r != references_.end(); ++r)
+        names.push_back(r->name);
+    return names;
+}
+
+Session *Benchmark::reference(const std::string &name)
+{
+    auto r = std::find_if(references_.begin(), references_.end(),
+                          [name](const Reference &ref) { return name == ref.name; });
+    if (r == references_.end())
+        return nullptr;
+
+    Session *session = new Session;
+    session->setResolution( glm::vec3(r->resolution, 0.f) );
+
+    // sources placed around the center of the mixing view
+    std::vector<Source *> sources;
+    for (auto p = r->patterns.begin(); p != r->patterns.end(); ++p) {
+        PatternSource *s = new PatternSource;
+        s->setPattern(*p, r->resolution);
+        sources.push_back(s);
+    }
+    Source *origin = sources.front();
+    for (auto f = r->clones.begin(); f != r->clones.end(); ++f) {
+        CloneSource *s = origin->clone();
+        s->setFilter(*f);
+        sources.push_back(s);
+    }
+
+    const float angle = glm::two_pi<float>() / (float) sources.size();
+    for (size_t i = 0; i < sources.size(); ++i) {
+        Source *s = sources[i];
+        s->setName( std::string(r->name) + "_" + std::to_string(i) );
+        s->group(View::MIXING)->translation_ = glm::vec3(0.4f * cos(angle * i), 0.4f * sin(angle * i), 0.f);
+        s->group(View::LAYER)->translation_.z = LAYER_BACKGROUND + (float) (i + 1) * LAYER_STEP;
+        session->addSource(s);
+    }
+
+    return session;
+}
+
+//
+// Statistics of a serie of measures
+//
+struct Measure {
+    double mean, p50, p95, p99, max;
+
+    explicit Measure(std::vector<double> v) : mean(0.0), p50(0.0), p95(0.0), p99(0.0), max(0.0) {
+        if (v.empty())
+            return;
+        for (auto x = v.begin(); x != v.end(); ++x)
+            mean += *x;
+        mean /= (double) v.size();
+        std::sort(v.begin(), v.end());
+        p50 = v[ (v.size() - 1) * 50 / 100 ];
+        p95 = v[ (v.size() - 1) * 95 / 100 ];
+        p99 = v[ (v.size() - 1) * 99 / 100 ];
+        max = v.back();
+    }
+
+    void print(const char *label) const {
+        printf("  %-28s %8.2f %8.2f %8.2f %8.2f %8.2f\n", label, mean, p50, p95, p99, max);
+    }
+};
+
+static bool runSession(const std::string &name, const Benchmark::Configuration &conf)
+{
+    //
+    // load session file or reference session
+    //
+    Session *previous = Mixer::manager().session();
+    if ( SystemToolkit::has_extension(name, VIMIX_FILE_EXT) ) {
+        if ( !SystemToolkit::file_exists(name) ) {
+            fprintf(stderr, "Benchmark: cannot open '%s'.\n", name.c_str());
+            return false;
+        }
+        Mixer::manager().load(name);
+    }
+    else {
+        Session *session = Benchmark::reference(name);
+        if ( session == nullptr ) {
+            fprintf(stderr, "Benchmark: '%s' is not a session file nor a reference session.\n", name.c_str());
+            return false;
+        }
+        Mixer::manager().set(session);
+    }
+
+    // wait for the session to be loaded, its sources started, and warm up
+    Mixer::manager().setFixedStep(0.f);
+    Clock::time_point start = Clock::now();
+    int warmup = BENCHMARK_WARMUP;
+    while ( warmup > 0 ) {
+        Mixer::manager().update();
+        glFinish();
+        const Session *se = Mixer::manager().session();
+        if ( se != previous && !Mixer::manager().busy() && se->ready() && !se->loading() )
+            --warmup;
+        if ( elapsed_ms(start, Clock::now()) > BENCHMARK_TIMEOUT * 1000.0 ) {
+            fprintf(stderr, "Benchmark: timeout loading '%s'.\n", name.c_str());
+            return false;
+        }
+    }
+    Session *session = Mixer::manager().session();
+
+    //
+    // measure
+    //
+    if ( conf.record )
+        FrameGrabbing::manager().add( new VideoRecorder( "benchmark_" + SystemToolkit::base_filename(name) ) );
+    Mixer::manager().setFixedStep( conf.fps > 0.f ? 1000.f / conf.fps : 0.f );
+    Profiler::manager().setEnabled(true);
+
+    std::vector<double> update_times;
+    std::vector<double> frame_times;
+    start = Clock::now();
+    Clock::time_point now = start;
+    while ( conf.seconds > 0.f ? elapsed_ms(start, now) < conf.seconds * 1000.0
+                               : frame_times.size() < conf.frames ) {
+        Clock::time_point begin = now;
+        Profiler::manager().frame();
+        Mixer::manager().update();
+        Clock::time_point updated = Clock::now();
+        // wait for the graphics card to complete the frame
+        glFinish();
+        now = Clock::now();
+        update_times.push_back( elapsed_ms(begin, updated) );
+        frame_times.push_back( elapsed_ms(begin, now) );
+    }
+    const double total = elapsed_ms(start, now);
+
+    // statistics of scopes measured by the profiler (last frames)
+    Profiler::manager().frame();
+    std::vector<Profiler::Statistics> scopes = Profiler::manager().statistics();
+    Profiler::manager().setEnabled(false);
+    Mixer::manager().setFixedStep(0.f);
+
+    //
+    // report
+    //
+    const FrameBuffer *frame = session->frame();
+    printf("Benchmark '%s': %d sources, %d x %d, %d frames in %.2f s (%.1f fps), %s\n",
+           name.c_str(), (int) session->size(),
+           frame ? (int) frame->width() : 0, frame ? (int) frame->height() : 0,
+           (int) frame_times.size(), total / 1000.0,
+           total > 0.0 ? 1000.0 * (double) frame_times.size() / total : 0.0,
+           conf.fps > 0.f ? ("fixed step " + std::to_string(1000.f / conf.fps) + " ms").c_str() : "free-running");
+    printf("  %-28s %8s %8s %8s %8s %8s\n", "(ms)", "mean", "p50", "p95", "p99", "max");
+    Measure(update_times).print("update");
+    Measure(frame_times).print("frame");
+    std::sort(scopes.begin(), scopes.end(),
+              [](const Profiler::Statistics &a, const Profiler::Statistics &b) { return a.mean > b.mean; });
+    for (auto s = scopes.begin(); s != scopes.end(); ++s) {
+        std::string label = s->category + " " + s->name + (s->gpu ? " (gpu)" : "");
+        printf("  %-28.28s %8.2f %8.2f %8.2f %8.2f %8.2f\n", label.c_str(), s->mean, s->p50, s->p95, s->p99, s->max);
+    }
+    fflush(stdout);
+
+    //
+    // end recording
+    //
+    if ( conf.record ) {
+        FrameGrabbing::manager().stopAll();
+        start = Clock::now();
+        while ( FrameGrabbing::manager().busy() && elapsed_ms(start, Clock::now()) < BENCHMARK_TIMEOUT * 1000.0 )
+            Mixer::manager().update();
+    }
+
+    return true;
+}
+
+int Benchmark::run(const Configuration &conf)
+{
+    std::list<std::string> sessions;
+    if ( conf.session.empty() )
+        sessions = references();
+    else
+        sessions.push_back(conf.session);
+
+    int ret = 0;
+    for (auto s = sessions.begin(); s != sessions.end(); ++s) {
+        if ( !runSession(*s, conf) )
+            ret = 1;
+    }
+
+    return ret;
+}
@@ -0,0 +1,50 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+#include <list>
+
+class Session;
+
+/**
+ * Benchmark of session rendering, without user interface.
+ *
+ * A session (.mix file or reference session) is loaded and updated
+ * for a number of frames or seconds, at the pace of the clock (free-running)
+ * or with a fixed time step. Frames are discarded, or recorded in a video file.
+ * A report of the time spent in each frame is printed at the end.
+ *
+ * The reference sessions are built with patterns (generated by the graphics
+ * card, or by gstreamer videotestsrc if Settings render.gpu_patterns is off)
+ * and only need a software OpenGL implementation; they are meant to
+ * compare performance across versions on the same machine.
+ *
+ * Rendering must be initialized (headless) before running a benchmark.
+ */
+namespace Benchmark
+{
+    struct Configuration {
+        // .mix file or name of a reference session (all references if empty)
+        std::string session;
+        // duration of the measure, in frames or in seconds (if > 0)
+        unsigned int frames;
+        float seconds;
+        // fixed time step at given framerate (free-running clock if 0)
+        float fps;
+        // record frames in a video file (discarded otherwise)
+        bool record;
+
+        Configuration() : frames(600), seconds(0.f), fps(0.f), record(false) {}
+    };
+
+    // run the benchmark and print report; returns 0 on success
+    int run(const Configuration &conf);
+
+    // names of reference sessions
+    std::list<std::string> references();
+
+    // create reference session (nullptr if invalid name)
+    Session *reference(const std::string &name);
+}
+
+#endif // BENCHMARK_H
@@ -31,6 +31,7 @@
 #include "FrameBufferFilter.h"
 #include "DelayFilter.h"
 #include "ImageFilter.h"
+#include "Profiler.h"
 
 #include "CloneSource.h"
 
@@ -95,7 +96,10 @@ void CloneSource::render()
         init();
     else {
         // render filter image
-        filter_->draw( origin_->frame() );
+        {
+            PROFILE_GPU_SCOPE("filter", name());
+            filter_->draw( origin_->frame() );
+        }
 
         // ensure correct output texture is displayed (could have changed if filter changed)
         texturesurface_->setTextureIndex( filter_->texture() );
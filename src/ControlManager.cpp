@@ -18,10 +18,11 @@
 **/
 
 #include <thread>
+#include <algorithm>
 #include <mutex>
+#include <cstring>
 #include <sstream>
 #include <iomanip>
-#include <regex>
 
 #include <GLFW/glfw3.h>
 #if ((ULONG_MAX) != (UINT_MAX))
@@ -43,6 +44,7 @@
 #include "NetworkToolkit.h"
 #include "UserInterfaceManager.h"
 #include "Streamer.h"
+#include "Profiler.h"
 
 #include "ControlManager.h"
 
@@ -54,16 +56,245 @@
 
 //bool  Control::input_active[INPUT_MAX]{};
 //float Control::input_values[INPUT_MAX]{};
-//std::mutex Control::input_access_;
 
 
+// split the OSC address in at most max segments starting with '/' (no allocation)
+static size_t splitAddress(std::string_view address, std::string_view *segments, size_t max)
+{
+    size_t count = 0;
+    size_t start = 0;
+    size_t end = 0;
+    while ( count < max && (start = address.find_first_not_of(OSC_SEPARATOR, end)) != std::string_view::npos ) {
+        end = address.find(OSC_SEPARATOR, start);
+        size_t delta = start > 0 ? 1 : 0;
+        segments[count++] = address.substr(start - delta, end == std::string_view::npos ? end : end - start + delta);
+    }
+    return count;
+}
+
+// OSC pattern matching of name: '?', '*', '[a-z]', '[!abc]' and '{foo,bar}'
+static bool matchPattern(std::string_view pattern, std::string_view name)
+{
+    while ( !pattern.empty() ) {
+        const char c = pattern.front();
+        if ( c == '*' ) {
+            // skip consecutive stars, and try all possible remaining parts of name
+            while ( !pattern.empty() && pattern.front() == '*' )
+                pattern.remove_prefix(1);
+            if ( pattern.empty() )
+                return true;
+            for (size_t i = 0; i <= name.size(); ++i) {
+                if ( matchPattern(pattern, name.substr(i)) )
+                    return true;
+            }
+            return false;
+        }
+        else if ( c == '{' ) {
+            // try each alternative followed by the rest of the pattern
+            const size_t close = pattern.find('}');
+            if ( close == std::string_view::npos )
+                return false;
+            std::string_view choices = pattern.substr(1, close - 1);
+            std::string_view rest = pattern.substr(close + 1);
+            while ( true ) {
+                const size_t comma = choices.find(',');
+                std::string_view choice = choices.substr(0, comma);
+                if ( name.substr(0, choice.size()) == choice
+                     && matchPattern(rest, name.substr(choice.size())) )
+                    return true;
+                if ( comma == std::string_view::npos )
+                    return false;
+                choices.remove_prefix(comma + 1);
+            }
+        }
+        else if ( name.empty() )
+            return false;
+        else if ( c == '[' ) {
+            // character in (or not in) a set of characters or ranges
+            const size_t close = pattern.find(']', 1);
+            if ( close == std::string_view::npos )
+                return false;
+            std::string_view set = pattern.substr(1, close - 1);
+            const bool negate = !set.empty() && set.front() == '!';
+            if ( negate )
+                set.remove_prefix(1);
+            bool found = false;
+            for (size_t i = 0; i < set.size() && !found; ++i) {
+                if ( i + 2 < set.size() && set[i + 1] == '-' ) {
+                    found = name.front() >= set[i] && name.front() <= set[i + 2];
+                    i += 2;
+                }
+                else
+                    found = name.front() == set[i];
+            }
+            if ( found == negate )
+                return false;
+            pattern.remove_prefix(close + 1);
+            name.remove_prefix(1);
+        }
+        else if ( c == '?' || c == name.front() ) {
+            pattern.remove_prefix(1);
+            name.remove_prefix(1);
+        }
+        else
+            return false;
+    }
+    return name.empty();
+}
+
+// Absolute setters of attributes: only the last of consecutive messages
+// with the same address needs to be applied in a frame
+static bool coalescable(std::string_view address_pattern)
+{
+    static const std::string_view attributes[] = {
+        OSC_SOURCE_ALPHA, OSC_SOURCE_TRANSPARENCY, OSC_SOURCE_DEPTH, OSC_SOURCE_ANGLE,
+        OSC_SOURCE_SEEK, OSC_SOURCE_SPEED, OSC_SOURCE_BRIGHTNESS, OSC_SOURCE_CONTRAST,
+        OSC_SOURCE_SATURATION, OSC_SOURCE_HUE, OSC_SOURCE_THRESHOLD, OSC_SOURCE_GAMMA,
+        OSC_SOURCE_COLOR, OSC_SOURCE_POSTERIZE, OSC_SOURCE_INVERT,
+        OSC_OUTPUT_FADING, OSC_SESSION_CROSSFADE };
+
+    std::string_view address[3];
+    if ( splitAddress(address_pattern, address, 3) != 3 || address[0] != OSC_PREFIX )
+        return false;
+    // not for multitouch, where the arguments tell which input is set
+    if ( address[1] == OSC_MULTITOUCH )
+        return false;
+
+    return std::find(std::begin(attributes), std::end(attributes), address[2]) != std::end(attributes);
+}
+
+Control::RequestListener::RequestListener() : queue_(new Packet[CONTROL_OSC_QUEUE_SIZE]),
+    enqueue_(0), dequeue_(0), received_(0), dropped_(0)
+{
+    for (uint64_t i = 0; i < CONTROL_OSC_QUEUE_SIZE; ++i)
+        queue_[i].sequence.store(i, std::memory_order_relaxed);
+    statistics_ = { 0, 0, 0.f, 0.f, 0, 0, 0 };
+    messages_.reserve(CONTROL_OSC_QUEUE_SIZE);
+}
+
+void Control::RequestListener::ProcessPacket( const char *data, int size,
+                                              const IpEndpointName& remoteEndpoint )
+{
+    received_++;
+    if ( size > CONTROL_OSC_PACKET_MAX ) {
+        dropped_++;
+        return;
+    }
+
+    // reserve a free slot in the queue (lock-free, any number of listener threads)
+    Packet *p = nullptr;
+    uint64_t pos = enqueue_.load(std::memory_order_relaxed);
+    for (;;) {
+        p = &queue_[pos & (CONTROL_OSC_QUEUE_SIZE - 1)];
+        const int64_t diff = (int64_t) p->sequence.load(std::memory_order_acquire) - (int64_t) pos;
+        if ( diff == 0 ) {
+            if ( enqueue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) )
+                break;
+        }
+        else if ( diff < 0 ) {
+            // queue is full: drop the packet
+            dropped_++;
+            return;
+        }
+        else
+            pos = enqueue_.load(std::memory_order_relaxed);
+    }
+
+    // keep a copy of the packet to process it in the rendering thread
+    memcpy(p->data, data, size);
+    p->size = size;
+    p->endpoint = remoteEndpoint;
+    p->arrival = std::chrono::steady_clock::now();
+    p->sequence.store(pos + 1, std::memory_order_release);
+}
+
+void Control::RequestListener::queueMessage( const osc::ReceivedMessage& m, const Packet *p )
+{
+    const size_t index = messages_.size();
+    messages_.push_back( { m, p, false } );
+
+    std::string_view address = Control::manager().translate(m.AddressPattern());
+    if ( coalescable(address) ) {
+        // a previous message with the same address is replaced by this one
+        auto previous = coalescing_.find(address);
+        if ( previous != coalescing_.end() ) {
+            messages_[previous->second].coalesced = true;
+            previous->second = index;
+            statistics_.coalesced++;
+        }
+        else
+            coalescing_[address] = index;
+    }
+    else
+        // any other message can change the targets: do not coalesce across it
+        coalescing_.clear();
+}
+
+void Control::RequestListener::queueMessages( const osc::ReceivedBundle& b, const Packet *p )
+{
+    for (auto i = b.ElementsBegin(); i != b.ElementsEnd(); ++i) {
+        if ( i->IsBundle() )
+            queueMessages( osc::ReceivedBundle(*i), p );
+        else
+            queueMessage( osc::ReceivedMessage(*i), p );
+    }
+}
+
+void Control::RequestListener::processQueue()
+{
+    // take the packets queued since last frame
+    uint64_t end = dequeue_;
+    while ( end - dequeue_ < CONTROL_OSC_QUEUE_SIZE &&
+            queue_[end & (CONTROL_OSC_QUEUE_SIZE - 1)].sequence.load(std::memory_order_acquire) == end + 1 )
+        ++end;
+
+    // list their messages in order (bundles entirely) and coalesce repeated setters
+    for (uint64_t pos = dequeue_; pos < end; ++pos) {
+        const Packet *p = &queue_[pos & (CONTROL_OSC_QUEUE_SIZE - 1)];
+        try {
+            osc::ReceivedPacket packet(p->data, p->size);
+            if ( packet.IsBundle() )
+                queueMessages( osc::ReceivedBundle(packet), p );
+            else
+                queueMessage( osc::ReceivedMessage(packet), p );
+        }
+        catch( osc::Exception& e ){
+            Log::Info(CONTROL_OSC_MSG "Ignoring malformed packet: %s", e.what());
+        }
+    }
+
+    // apply messages
+    for (auto m = messages_.begin(); m != messages_.end(); ++m) {
+        if ( !m->coalesced )
+            ProcessMessage( m->message, m->packet->endpoint );
+    }
+
+    // statistics on packets applied in this frame
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    statistics_.depth = (size_t) (end - dequeue_);
+    statistics_.messages = messages_.size();
+    statistics_.latency_mean = 0.f;
+    statistics_.latency_max = 0.f;
+    for (uint64_t pos = dequeue_; pos < end; ++pos) {
+        const float l = std::chrono::duration<float, std::milli>(now - queue_[pos & (CONTROL_OSC_QUEUE_SIZE - 1)].arrival).count();
+        statistics_.latency_mean += l;
+        statistics_.latency_max = std::max(statistics_.latency_max, l);
+    }
+    if ( statistics_.depth > 0 )
+        statistics_.latency_mean /= (float) statistics_.depth;
+    statistics_.received = received_;
+    statistics_.dropped = dropped_;
+
+    // release the slots to the listener threads
+    messages_.clear();
+    coalescing_.clear();
+    for (; dequeue_ < end; ++dequeue_)
+        queue_[dequeue_ & (CONTROL_OSC_QUEUE_SIZE - 1)].sequence.store(dequeue_ + CONTROL_OSC_QUEUE_SIZE, std::memory_order_release);
+}
+
 void Control::RequestListener::ProcessMessage( const osc::ReceivedMessage& m,
                                                const IpEndpointName& remoteEndpoint )
 {
-    // regular expression to check for batch
-    static std::regex osc_batch_reg_exp( OSC_BATCH );
-    static std::regex osc_sourceid_reg_exp( OSC_SOURCEID );
-
     char sender[IpEndpointName::ADDRESS_AND_PORT_STRING_LENGTH];
     remoteEndpoint.AddressAndPortAsString(sender);
 
@@ -72,25 +303,38 @@ void Control::RequestListener::ProcessMessage( const osc::ReceivedMessage& m,
         Log::Info(CONTROL_OSC_MSG "received '%s' from %s", FullMessage(m).c_str(), sender);
 #endif
         // Preprocessing with Translator
-        std::string address_pattern = Control::manager().translate(m.AddressPattern());
+        std::string_view address_pattern = Control::manager().translate(m.AddressPattern());
 
         // structured OSC address
-        std::list<std::string> address = BaseToolkit::splitted(address_pattern, OSC_SEPARATOR);
+        std::string_view address[3];
         //
         // A wellformed OSC address is in the form '/vimix/target/attribute {arguments}'
         // First test: should have 3 elements and start with APP_NAME ('vimix')
         //
-        if (address.size() > 2 && address.front().compare(OSC_PREFIX) == 0 ){
-            // done with the first part of the OSC address
-            address.pop_front();
-            // next part of the OSC message is the target, after alias correction
-            std::string target = Control::manager().alias( address.front() );
-            // next part of the OSC message is the attribute
-            address.pop_front();
-            std::string attribute = address.front();
+        if ( splitAddress(address_pattern, address, 3) > 2 && address[0] == OSC_PREFIX ){
+            // last part of the OSC message is the attribute
+            const std::string attribute( address[2] );
+
+            // Pattern target: apply attribute to all sources with a name matching the pattern
+            if ( address[1].find_first_of("?*[{") != std::string_view::npos )
+            {
+                std::string_view pattern = address[1].substr(1);
+                for (SourceList::iterator it = Mixer::manager().session()->begin(); it != Mixer::manager().session()->end(); ++it) {
+                    if ( matchPattern(pattern, (*it)->name()) ) {
+                        // apply attributes
+                        if ( Control::manager().receiveSourceAttribute( *it, attribute, m.ArgumentStream()) )
+                            // and send back feedback if needed
+                            Control::manager().sendSourceAttibutes(remoteEndpoint, "/" + (*it)->name(), *it);
+                    }
+                }
+                return;
+            }
+
+            // next part of the OSC message is the target (after alias correction)
+            Control::Target &target = Control::manager().target( address[1] );
 
             // Log target: just print text in log window
-            if ( target.compare(OSC_INFO) == 0 )
+            if ( target.kind == Control::Target::INFO )
             {
                 if ( attribute.compare(OSC_INFO_NOTIFY) == 0) {
                     Log::Notify(CONTROL_OSC_MSG "Received '%s' from %s", FullMessage(m).c_str(), sender);
@@ -98,9 +342,17 @@ void Control::RequestListener::ProcessMessage( const osc::ReceivedMessage& m,
                 else if ( attribute.compare(OSC_INFO_LOG) == 0) {
                     Log::Info(CONTROL_OSC_MSG "Received '%s' from %s", FullMessage(m).c_str(), sender);
                 }
+                else if ( attribute.compare(OSC_INFO_TRACE) == 0) {
+                    // trace duration in seconds (10 by default)
+                    float t = 10.f;
+                    osc::ReceivedMessageArgumentStream arguments = m.ArgumentStream();
+                    if (!arguments.Eos())
+                        arguments >> t;
+                    Profiler::manager().trace(t);
+                }
             }
             // Output target: concerns attributes of the rendering output
-            else if ( target.compare(OSC_OUTPUT) == 0 )
+            else if ( target.kind == Control::Target::OUTPUT )
             {
                 if ( Control::manager().receiveOutputAttribute(attribute, m.ArgumentStream())) {
                     // send the global status
@@ -108,12 +360,12 @@ void Control::RequestListener::ProcessMessage( const osc::ReceivedMessage& m,
                 }
             }
             // Multitouch target: user input on 'Multitouch' tab
-            else if ( target.compare(OSC_MULTITOUCH) == 0 )
+            else if ( target.kind == Control::Target::MULTITOUCH )
             {
                 Control::manager().receiveMultitouchAttribute(attribute, m.ArgumentStream());
             }
             // Session target: concerns attributes of the session
-            else if ( target.compare(OSC_SESSION) == 0 )
+            else if ( target.kind == Control::Target::SESSION )
             {
                 if ( Control::manager().receiveSessionAttribute(attribute, m.ArgumentStream()) ) {
                     // send the global status
@@ -125,12 +377,12 @@ void Control::RequestListener::ProcessMessage( const osc::ReceivedMessage& m,
                 }
             }
             // Request stream
-            else if ( target.compare(OSC_STREAM) == 0 )
+            else if ( target.kind == Control::Target::STREAM )
             {
                 Control::manager().receiveStreamAttribute(attribute, m.ArgumentStream(), sender);
             }
             // ALL sources target: apply attribute to all sources of the session
-            else if ( target.compare(OSC_ALL) == 0 )
+            else if ( target.kind == Control::Target::ALL )
             {
                 // Loop over selected sources
                 for (SourceList::iterator it = Mixer::manager().session()->begin(); it != Mixer::manager().session()->end(); ++it) {
@@ -141,7 +393,7 @@ void Control::RequestListener::ProcessMessage( const osc::ReceivedMessage& m,
                 }
             }
             // Selection sources target: apply attribute to all sources of the selection
-            else if (target.compare(OSC_SELECTION) == 0) {
+            else if ( target.kind == Control::Target::SELECTION ) {
                 // Loop over dynamically selected sources
                 for (SourceList::iterator it = Mixer::selection().begin(); it != Mixer::selection().end(); ++it) {
                     // apply attributes
@@ -151,7 +403,7 @@ void Control::RequestListener::ProcessMessage( const osc::ReceivedMessage& m,
                 }
             }
             // Current source target: apply attribute to the current sources
-            else if ( target.compare(OSC_CURRENT) == 0 )
+            else if ( target.kind == Control::Target::CURRENT )
             {
                 int sourceid = -1;
                 if ( attribute.compare(OSC_SYNC) == 0) {
@@ -184,70 +436,50 @@ void Control::RequestListener::ProcessMessage( const osc::ReceivedMessage& m,
                         Control::manager().sendSourceAttibutes(remoteEndpoint, OSC_CURRENT);
                 }
             }
-            // Batch sources target: apply attribute to all sources in the Batch
-            else if ( std::regex_match(target, osc_batch_reg_exp) )
+            // Batch sources target: apply attribute to all sources in the Batch (e.g. '/batch#2')
+            else if ( target.kind == Control::Target::BATCH )
             {
-                int i = 0;
-                std::string num = target.substr( target.find_last_of("#") + 1);
-                if ( BaseToolkit::is_a_number(num, &i)){
-                    // confirmed : the target is a Player Batch (e.g. '/batch#2')
-                    if ( Control::manager().receiveBatchAttribute(i, attribute, m.ArgumentStream()) ) {
-                        // send batch status
-                        Control::manager().sendBatchStatus(remoteEndpoint);
-                    }
+                if ( Control::manager().receiveBatchAttribute(target.index, attribute, m.ArgumentStream()) ) {
+                    // send batch status
+                    Control::manager().sendBatchStatus(remoteEndpoint);
                 }
             }
-            // #ID sources target
-            else if ( std::regex_match(target, osc_sourceid_reg_exp) )
+            // special case of creating an alias for given source target (#ID or name)
+            else if ( attribute.compare(OSC_SOURCE_ALIAS) == 0 )
             {
-                int i = 0;
-                std::string num = target.substr( target.find("#") == std::string::npos ? 1 : 2 );
-                if ( BaseToolkit::is_a_number(num, &i)){
-                    // special case of creating an alias for given source target
-                    if (attribute.compare(OSC_SOURCE_ALIAS) == 0) {
-                        const char *label = nullptr;
-                        m.ArgumentStream() >> label >> osc::EndMessage;
-                        Control::manager().aliases_[std::string("/").append(label)] = target;
-                        Log::Info(CONTROL_OSC_MSG "New alias /%s for target %s.", label, target.c_str());
-
-                    }
-                    // usual case, addressing the source by '#n'
-                    else {
-                        Source *s = Mixer::manager().sourceAtIndex(i);
-                        if (s) {
-                            // apply attributes to source
-                            if ( Control::manager().receiveSourceAttribute(s, attribute, m.ArgumentStream()) )
-                                // and send back feedback if needed
-                                Control::manager().sendSourceAttibutes(remoteEndpoint, target, s);
-                        }
-                        else
-                            Log::Info(CONTROL_OSC_MSG "No source at ID %s targetted by %s.", num.c_str(), sender);
-                    }
+                const char *label = nullptr;
+                m.ArgumentStream() >> label >> osc::EndMessage;
+                // NB: target is invalid after changing aliases
+                const std::string name = target.name;
+                Control::manager().setAlias(std::string("/").append(label), name);
+                Log::Info(CONTROL_OSC_MSG "New alias /%s for target %s.", label, name.c_str());
+            }
+            // #ID sources target: addressing the source by '#n'
+            else if ( target.kind == Control::Target::INDEX )
+            {
+                Source *s = Mixer::manager().sourceAtIndex(target.index);
+                if (s) {
+                    // apply attributes to source
+                    if ( Control::manager().receiveSourceAttribute(s, attribute, m.ArgumentStream()) )
+                        // and send back feedback if needed
+                        Control::manager().sendSourceAttibutes(remoteEndpoint, target.name, s);
                 }
+                else
+                    Log::Info(CONTROL_OSC_MSG "No source at ID %d targetted by %s.", target.index, sender);
             }
-            // General case: try to identify the target by name
+            // General case: addressing the source by its name
             else {
-                // special case of creating an alias for given source target
-                if (attribute.compare(OSC_SOURCE_ALIAS) == 0) {
-                    const char *label = nullptr;
-                    m.ArgumentStream() >> label >> osc::EndMessage;
-                    Control::manager().aliases_[std::string("/").append(label)] = target;
-                    Log::Info(CONTROL_OSC_MSG "New alias /%s for target %s.", label, target.c_str());
-                }
-                // usual case, addressing the source by its name
-                else {
-                    // try to find source by given name
-                    Source *s = Mixer::manager().findSource(target.substr(1));
-                    // if a source with the given target name or index was found
-                    if (s) {
-                        // apply attributes to source
-                        if ( Control::manager().receiveSourceAttribute(s, attribute, m.ArgumentStream()) )
-                            // and send back feedback if needed
-                            Control::manager().sendSourceAttibutes(remoteEndpoint, target, s);
-                    }
-                    else
-                        Log::Info(CONTROL_OSC_MSG "Unknown target '%s' requested by %s.", target.c_str(), sender);
+                // try to find source by given name
+                Source *s = Control::manager().targetSource(target);
+                // if a source with the given target name was found
+                if (s) {
+                    // apply attributes to source
+                    if ( Control::manager().receiveSourceAttribute(s, attribute, m.ArgumentStream()) )
+                        // and send back feedback if needed
+                        Control::manager().sendSourceAttibutes(remoteEndpoint, target.name, s);
                 }
+                else
+                    Log::Info(CONTROL_OSC_MSG "Unknown target '%s' requested by %s.", target.name.c_str(), sender);
             }
         }
         else {
@@ -331,7 +563,7 @@ Control::~Control()
     terminate();
 }
 
-std::string Control::alias (std::string target)
+std::string Control::alias (const std::string &target) const
 {
     auto it_alias  = aliases_.find(target);
     if ( it_alias != aliases_.end() )
@@ -340,7 +572,15 @@ std::string Control::alias (std::string target)
         return target;
 }
 
-std::string Control::translate (std::string addresspattern)
+void Control::setAlias (const std::string &label, const std::string &target)
+{
+    aliases_[label] = target;
+
+    // targets have to be resolved again
+    targets_.clear();
+}
+
+std::string_view Control::translate (std::string_view addresspattern) const
 {
     auto it_translation  = translation_.find(addresspattern);
     if ( it_translation != translation_.end() )
@@ -349,6 +589,67 @@ std::string Control::translate (std::string addresspattern)
         return addresspattern;
 }
 
+Control::Target &Control::target (std::string_view name)
+{
+    // target already in dispatch table
+    auto it_target = targets_.find(name);
+    if ( it_target != targets_.end() )
+        return it_target->second;
+
+    // limit size of dispatch table (e.g. many unknown targets)
+    if ( targets_.size() > CONTROL_OSC_TARGETS_MAX )
+        targets_.clear();
+
+    // identify the kind of target, after alias correction
+    static const std::map<std::string, Target::Kind> kinds = {
+        { OSC_INFO, Target::INFO },
+        { OSC_OUTPUT, Target::OUTPUT },
+        { OSC_MULTITOUCH, Target::MULTITOUCH },
+        { OSC_SESSION, Target::SESSION },
+        { OSC_STREAM, Target::STREAM },
+        { OSC_ALL, Target::ALL },
+        { OSC_SELECTION, Target::SELECTION },
+        { OSC_CURRENT, Target::CURRENT }
+    };
+    Target t;
+    t.name = alias( std::string(name) );
+    t.index = -1;
+    t.source = 0;
+    t.kind = Target::NAME;
+
+    auto k = kinds.find(t.name);
+    if ( k != kinds.end() )
+        t.kind = k->second;
+    else {
+        // Batch target (e.g. '/batch#2') or #ID target (e.g. '/#2' or '/2')
+        static const std::string batch = "/batch#";
+        const bool isbatch = t.name.compare(0, batch.size(), batch) == 0;
+        std::string num;
+        if ( isbatch )
+            num = t.name.substr(batch.size());
+        else
+            num = t.name.substr( t.name.size() > 1 && t.name[1] == '#' ? 2 : 1 );
+        if ( !num.empty() && num.size() < 10 && std::all_of(num.begin(), num.end(), ::isdigit) ) {
+            t.kind = isbatch ? Target::BATCH : Target::INDEX;
+            t.index = std::stoi(num);
+        }
+    }
+
+    return targets_.emplace(std::string(name), t).first->second;
+}
+
+Source *Control::targetSource (Target &t)
+{
+    // source found previously, if its name did not change
+    Source *s = Mixer::manager().findSource(t.source);
+    if ( s == nullptr || t.name.compare(1, std::string::npos, s->name()) != 0 ) {
+        // find source by name
+        s = Mixer::manager().findSource( t.name.substr(1) );
+        t.source = s ? s->id() : 0;
+    }
+    return s;
+}
+
 void Control::loadOscConfig()
 {
     // reset translations
@@ -463,6 +764,19 @@ bool Control::init()
     return receiver_ != nullptr;
 }
 
+void Control::receive()
+{
+    PROFILE_SCOPE("control", "osc");
+
+    // apply OSC messages received since last frame
+    listener_.processQueue();
+}
+
+Control::QueueStatistics Control::queueStatistics() const
+{
+    return listener_.statistics();
+}
+
 void Control::update()
 {
     // read joystick buttons
@@ -470,20 +784,16 @@ void Control::update()
     const unsigned char *state_buttons = glfwGetJoystickButtons(GLFW_JOYSTICK_1, &num_buttons );
     // map to Control input array
     for (int b = 0; b < num_buttons; ++b) {
-        input_access_.lock();
         input_active[INPUT_JOYSTICK_FIRST_BUTTON + b] = state_buttons[b] == GLFW_PRESS;
         input_values[INPUT_JOYSTICK_FIRST_BUTTON + b] = state_buttons[b] == GLFW_PRESS ? 1.f : 0.f;
-        input_access_.unlock();
     }
 
     // read joystick axis
     int num_axis = 0;
     const float *state_axis = glfwGetJoystickAxes(GLFW_JOYSTICK_1, &num_axis );
     for (int a = 0; a < num_axis; ++a) {
-        input_access_.lock();
         input_active[INPUT_JOYSTICK_FIRST_AXIS + a] = ABS(state_axis[a]) > 0.02 ? true : false;
         input_values[INPUT_JOYSTICK_FIRST_AXIS + a] = state_axis[a];
-        input_access_.unlock();
     }
 
     // multitouch input needs to be cleared when no more OSC input comes in
@@ -491,11 +801,9 @@ void Control::update()
         if ( multitouch_active[m] > 0 )
             multitouch_active[m] -= 1;
         else {
-            input_access_.lock();
             input_active[INPUT_MULTITOUCH_FIRST + m] = false;
             input_values[INPUT_MULTITOUCH_FIRST + m] = 0.f;
             multitouch_values[m] = glm::vec2(0.f);
-            input_access_.unlock();
         }
     }
 
@@ -518,6 +826,8 @@ void Control::update()
 
 void Control::listen()
 {
+    Log::SetThreadName("osc");
+
     if (Control::manager().receiver_)
         Control::manager().receiver_->Run();
 
@@ -1078,6 +1388,20 @@ bool Control::receiveBatchAttribute(int i, const std::string &attribute,
     return send_feedback;
 }
 
+// snapshot at index given by value (0 for the latest version), 0 if none
+uint64_t snapshotAtIndex(float v)
+{
+    uint64_t snap = 0;
+    size_t id = (int) ceil(v);
+    std::list<uint64_t> snapshots = Action::manager().snapshots();
+    if ( id <  snapshots.size() ) {
+        for (size_t i = 0; i < id; ++i)
+            snapshots.pop_back();
+        snap = snapshots.back();
+    }
+    return snap;
+}
+
 bool Control::receiveSessionAttribute(const std::string &attribute,
                        osc::ReceivedMessageArgumentStream arguments)
 {
@@ -1090,16 +1414,26 @@ bool Control::receiveSessionAttribute(const std::string &attribute,
         else if ( attribute.compare(OSC_SESSION_VERSION) == 0) {
             float v = 0.f;
             arguments >> v >> osc::EndMessage;
-            size_t id = (int) ceil(v);
-            std::list<uint64_t> snapshots = Action::manager().snapshots();
-            if ( id <  snapshots.size() ) {
-                for (size_t i = 0; i < id; ++i)
-                    snapshots.pop_back();
-                uint64_t snap = snapshots.back();
+            uint64_t snap = snapshotAtIndex(v);
+            if ( snap > 0 )
                 Action::manager().restore(snap);
-            }
             send_feedback = true;
         }
+        else if ( attribute.compare(OSC_SESSION_CROSSFADE) == 0) {
+            float v = 0.f;
+            arguments >> v;
+            // interpolate from current state to current version
+            if (arguments.Eos()) {
+                arguments >> osc::EndMessage;
+                Action::manager().interpolate(v);
+            }
+            // interpolate between two versions
+            else {
+                float a = 0.f, b = 0.f;
+                arguments >> a >> b >> osc::EndMessage;
+                Action::manager().crossfade(v, snapshotAtIndex(a), snapshotAtIndex(b));
+            }
+        }
         else if ( attribute.compare(OSC_SESSION_OPEN) == 0) {
             const char *filename;
             arguments >> filename;
@@ -1165,8 +1499,6 @@ void Control::receiveMultitouchAttribute(const std::string &attribute,
             if ( !arguments.Eos())
                 arguments >> x >> y >> osc::EndMessage;
 
-            input_access_.lock();
-
             // if the touch was already pressed
             if ( multitouch_active[t] > 0 ) {
                 // active value decreases with the distance from original press position
@@ -1183,8 +1515,6 @@ void Control::receiveMultitouchAttribute(const std::string &attribute,
             multitouch_active[t] = 3;
             // set array of active input
             input_active[INPUT_MULTITOUCH_FIRST + t] = true;
-
-            input_access_.unlock();
         }
     }
     catch (osc::MissingArgumentException &e) {
@@ -1459,7 +1789,6 @@ void Control::keyboardCalback(GLFWwindow* w, int key, int, int action, int mods)
         // keys without modifiers in any windows
         if (!mods) {
             int _key = layoutKey(key);
-            Control::manager().input_access_.lock();
             if (_key >= GLFW_KEY_A && _key <= GLFW_KEY_Z) {
                 Control::manager().input_active[INPUT_KEYBOARD_FIRST + _key - GLFW_KEY_A] = action > GLFW_RELEASE;
                 Control::manager().input_values[INPUT_KEYBOARD_FIRST + _key - GLFW_KEY_A] = action > GLFW_RELEASE ? 1.f : 0.f;
@@ -1468,7 +1797,6 @@ void Control::keyboardCalback(GLFWwindow* w, int key, int, int action, int mods)
                 Control::manager().input_active[INPUT_NUMPAD_FIRST + _key - GLFW_KEY_KP_0] = action > GLFW_RELEASE;
                 Control::manager().input_values[INPUT_NUMPAD_FIRST + _key - GLFW_KEY_KP_0] = action > GLFW_RELEASE ? 1.f : 0.f;
             }
-            Control::manager().input_access_.unlock();
         }
         // keys with modifiers in non-main window
         else if ( w != Rendering::manager().mainWindow().window() )
@@ -1501,20 +1829,13 @@ void Control::keyboardCalback(GLFWwindow* w, int key, int, int action, int mods)
 
 bool Control::inputActive (uint id)
 {
-    input_access_.lock();
-    const bool ret = input_active[MIN(id,INPUT_MAX)];
-    input_access_.unlock();
-
-    return ret && !Settings::application.mapping.disabled;
+    // input state is only changed in the rendering thread
+    return input_active[MIN(id,INPUT_MAX)] && !Settings::application.mapping.disabled;
 }
 
 float Control::inputValue (uint id)
 {
-    input_access_.lock();
-    const float ret = input_values[MIN(id,INPUT_MAX)];
-    input_access_.unlock();
-
-    return ret;
+    return input_values[MIN(id,INPUT_MAX)];
 }
 
 std::string Control::inputLabel(uint id)
@@ -4,8 +4,13 @@
 #include <glm/fwd.hpp>
 #include <map>
 #include <list>
+#include <vector>
 #include <string>
+#include <string_view>
 #include <atomic>
+#include <memory>
+#include <chrono>
+#include <unordered_map>
 #include <condition_variable>
 
 #include "osc/OscReceivedElements.h"
@@ -17,6 +22,7 @@
 #define OSC_INFO               "/info"
 #define OSC_INFO_LOG           "/log"
 #define OSC_INFO_NOTIFY        "/notify"
+#define OSC_INFO_TRACE         "/trace"
 
 #define OSC_OUTPUT             "/output"
 #define OSC_OUTPUT_ENABLE      "/enable"
@@ -75,6 +81,7 @@
 
 #define OSC_SESSION            "/session"
 #define OSC_SESSION_VERSION    "/version"
+#define OSC_SESSION_CROSSFADE  "/crossfade"
 #define OSC_SESSION_OPEN       "/open"
 #define OSC_SESSION_SAVE       "/save"
 #define OSC_SESSION_CLOSE      "/close"
@@ -103,6 +110,12 @@
 #define INPUT_CUSTOM_LAST      99
 #define INPUT_MAX              100
 
+// maximum number of OSC targets kept in dispatch table
+#define CONTROL_OSC_TARGETS_MAX 1024
+// number of OSC packets waiting for next frame (power of two), and their maximum size
+#define CONTROL_OSC_QUEUE_SIZE  256
+#define CONTROL_OSC_PACKET_MAX  4096
+
 
 class Session;
 class Source;
@@ -139,15 +152,83 @@ public:
     static std::string inputLabel(uint id);
     static int layoutKey(int key);
 
+    // apply OSC messages received since last frame (Mixer::update)
+    void receive();
+
+    // statistics of the OSC queue
+    struct QueueStatistics {
+        // packets and messages applied in last frame
+        size_t depth;
+        size_t messages;
+        // time from arrival of packets to last frame, in milliseconds
+        float latency_mean;
+        float latency_max;
+        // since start
+        uint64_t received;
+        uint64_t dropped;
+        uint64_t coalesced;
+    };
+    QueueStatistics queueStatistics() const;
+
 protected:
 
     // OSC management
     class RequestListener : public osc::OscPacketListener {
+    public:
+        RequestListener();
+        // push packet received (listener threads) in queue until next frame
+        void ProcessPacket( const char *data, int size,
+                            const IpEndpointName& remoteEndpoint ) override;
+        // process packets queued since last frame (rendering thread)
+        void processQueue();
+        inline const QueueStatistics &statistics() const { return statistics_; }
     protected:
         virtual void ProcessMessage( const osc::ReceivedMessage& m,
                                      const IpEndpointName& remoteEndpoint );
         std::string FullMessage( const osc::ReceivedMessage& m );
+    private:
+        // bounded multi-producer single-consumer ring of packets
+        struct Packet {
+            std::atomic<uint64_t> sequence;
+            int size;
+            IpEndpointName endpoint;
+            std::chrono::steady_clock::time_point arrival;
+            char data[CONTROL_OSC_PACKET_MAX];
+        };
+        std::unique_ptr<Packet[]> queue_;
+        std::atomic<uint64_t> enqueue_;
+        uint64_t dequeue_;
+        std::atomic<uint64_t> received_;
+        std::atomic<uint64_t> dropped_;
+        // messages of the packets processed in a frame
+        struct Message {
+            osc::ReceivedMessage message;
+            const Packet *packet;
+            bool coalesced;
+        };
+        std::vector<Message> messages_;
+        std::unordered_map<std::string_view, size_t> coalescing_;
+        void queueMessages( const osc::ReceivedBundle& b, const Packet *p );
+        void queueMessage( const osc::ReceivedMessage& m, const Packet *p );
+        QueueStatistics statistics_;
+    };
+
+    // OSC dispatch table of targets ('/vimix/target/attribute')
+    struct Target {
+        typedef enum {
+            INFO = 0, OUTPUT, MULTITOUCH, SESSION, STREAM,
+            ALL, SELECTION, CURRENT, BATCH, INDEX, NAME
+        } Kind;
+        Kind kind;
+        // target after alias (e.g. '/name' or '/#2')
+        std::string name;
+        // number of BATCH or INDEX
+        int index;
+        // id of the source last found for NAME
+        uint64_t source;
     };
+    Target &target (std::string_view name);
+    Source *targetSource (Target &t);
 
     bool receiveOutputAttribute(const std::string &attribute,
                             osc::ReceivedMessageArgumentStream arguments);
@@ -172,8 +253,9 @@ protected:
     static void keyboardCalback(GLFWwindow*, int, int, int, int);
 
     // OSC translation
-    std::string translate (std::string addresspqattern);
-    std::string alias (std::string target);
+    std::string_view translate (std::string_view addresspattern) const;
+    std::string alias (const std::string &target) const;
+    void setAlias (const std::string &label, const std::string &target);
 
 private:
 
@@ -183,13 +265,13 @@ private:
     UdpListeningReceiveSocket *receiver_;
 
     std::map<std::string, std::string> aliases_;
-    std::map<std::string, std::string> translation_;
+    std::map<std::string, std::string, std::less<> > translation_;
+    std::map<std::string, Target, std::less<> > targets_;
     void loadOscConfig();
     void resetOscConfig();
 
     bool  input_active[INPUT_MAX];
     float input_values[INPUT_MAX];
-    std::mutex input_access_;
 
     int   multitouch_active[INPUT_MULTITOUCH_COUNT];
     glm::vec2 multitouch_values[INPUT_MULTITOUCH_COUNT];
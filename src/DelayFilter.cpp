@@ -17,34 +17,113 @@
  * along with this program. If not, see <https://www.gnu.org/licenses/>.
 **/
 
+#include <cstring>
+
+#include <glad/glad.h>
+
 #include "Log.h"
+#include "Settings.h"
 #include "FrameBuffer.h"
 #include "Resource.h"
 #include "Primitives.h"
 #include "Visitor.h"
+#include "ThreadPool.h"
 
 #include "DelayFilter.h"
 
-DelayFilter::DelayFilter(): FrameBufferFilter(),
-    temp_frame_(nullptr), now_(0.0), delay_(0.5)
+/**
+ * Image of a frame stored in RAM; pixels or JPEG data
+ */
+struct DelayFilter::Image
 {
+    std::vector<uint8_t> data;
+    int width;
+    int height;
+    int channels;
+    bool jpeg;
 
+    // total memory used by all images
+    static std::atomic<size_t> allocated;
+
+    Image(std::vector<uint8_t> &&d, int w, int h, int c, bool j) :
+        data(std::move(d)), width(w), height(h), channels(c), jpeg(j) {
+        allocated += data.size();
+    }
+    ~Image() {
+        allocated -= data.size();
+    }
+};
+
+std::atomic<size_t> DelayFilter::Image::allocated(0);
+
+// memory reserved for all delay filters, in Bytes
+static size_t budget()
+{
+    return (size_t) CLAMP(Settings::application.render.delay_memory, 64, 65536) * 1048576;
 }
 
-DelayFilter::~DelayFilter()
+size_t DelayFilter::memory()
 {
-    // delete all frame buffers
-    while (!frames_.empty()) {
-        if (frames_.front() != nullptr)
-            delete frames_.front();
-        frames_.pop();
+    return Image::allocated;
+}
+
+// executed in worker thread: store pixels, compressed in JPEG if possible
+static DelayFilter::Image *encode(std::vector<uint8_t> pixels, int w, int h, int c, bool compress)
+{
+    // JPEG is only for RGB
+    if (compress && c == 3) {
+        FrameBufferImage img(w, h);
+        memcpy(img.rgb, pixels.data(), w * h * 3);
+        FrameBufferImage::jpegBuffer jpgimg = img.getJpeg();
+        if (jpgimg.buffer != nullptr) {
+            std::vector<uint8_t> data(jpgimg.buffer, jpgimg.buffer + jpgimg.len);
+            free(jpgimg.buffer);
+            return new DelayFilter::Image(std::move(data), w, h, c, true);
+        }
     }
 
-    while (!elapsed_.empty())
-        elapsed_.pop();
+    return new DelayFilter::Image(std::move(pixels), w, h, c, false);
 }
 
-void DelayFilter::reset ()
+// executed in worker thread: get pixels of a stored image (and delete it)
+static DelayFilter::Image *decode(DelayFilter::Image *image)
+{
+    if (image == nullptr || !image->jpeg)
+        return image;
+
+    DelayFilter::Image *pixels = nullptr;
+    FrameBufferImage::jpegBuffer jpgimg;
+    jpgimg.buffer = image->data.data();
+    jpgimg.len = image->data.size();
+    FrameBufferImage img(jpgimg);
+    if (img.rgb != nullptr && img.width == image->width && img.height == image->height) {
+        std::vector<uint8_t> data(img.rgb, img.rgb + img.width * img.height * 3);
+        pixels = new DelayFilter::Image(std::move(data), img.width, img.height, 3, false);
+    }
+    delete image;
+
+    return pixels;
+}
+
+DelayFilter::DelayFilter(): FrameBufferFilter(),
+    temp_frame_(nullptr), use_ram_(false), gpu_full_(false), output_(nullptr),
+    pbo_size_(0), pbo_index_(0), pbo_format_(0), now_(0.0), delay_(0.5)
+{
+    pbo_[0] = pbo_[1] = 0;
+    pbo_elapsed_[0] = pbo_elapsed_[1] = -1.0;
+}
+
+DelayFilter::~DelayFilter()
+{
+    clear();
+
+    if (output_)
+        delete output_;
+    if (pbo_[0])
+        glDeleteBuffers(2, pbo_);
+}
+
+void DelayFilter::clear ()
 {
     // delete all frame buffers
     while (!frames_.empty()) {
@@ -56,11 +135,29 @@ void DelayFilter::reset ()
     while (!elapsed_.empty())
         elapsed_.pop();
 
+    // delete all images in RAM (wait for workers)
+    for (auto it = stored_.begin(); it != stored_.end(); ++it)
+        delete it->image.get();
+    stored_.clear();
+    if (decoded_.image.valid())
+        delete decoded_.image.get();
+
+    pbo_elapsed_[0] = pbo_elapsed_[1] = -1.0;
+}
+
+void DelayFilter::reset ()
+{
+    clear();
+    gpu_full_ = false;
+
     now_ = 0.0;
 }
 
 double DelayFilter::updateTime ()
 {
+    if (use_ram_ && !stored_.empty())
+        return stored_.front().elapsed;
+
     if (!elapsed_.empty())
         return elapsed_.front();
 
@@ -74,6 +171,18 @@ void DelayFilter::update (float dt)
         // What time is it?
         now_ += double(dt) * 0.001;
 
+        // long delays are stored in RAM, as well as any delay if graphics card is full
+        bool ram = delay_ > DELAY_FILTER_GPU_MAX || gpu_full_;
+        if (ram != use_ram_) {
+            clear();
+            use_ram_ = ram;
+        }
+
+        if (use_ram_) {
+            updateRam(dt);
+            return;
+        }
+
         // if temporary FBO was pending to be deleted, delete it now
         if (temp_frame_ != nullptr) {
             delete temp_frame_;
@@ -107,17 +216,71 @@ void DelayFilter::update (float dt)
                 temp_frame_ = nullptr;
             }
             else {
-                // set delay to maximum affordable
-                delay_ = now_ - elapsed_.front() - (dt * 0.001);
-                Log::Warning("Cannot satisfy delay: not enough RAM in graphics card.");
+                // continue in RAM (restart accumulation of frames)
+                gpu_full_ = true;
+                Log::Info("Not enough RAM in graphics card for delay: using RAM instead.");
             }
         }
     }
 }
 
+void DelayFilter::updateRam (float dt)
+{
+    // skip frames older than delay if a more recent one is also due
+    // (NB: encoding can still be running with short delays; never wait for it)
+    while ( stored_.size() > 1 && now_ - stored_[1].elapsed > delay_ &&
+            stored_.front().image.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready ) {
+        delete stored_.front().image.get();
+        stored_.pop_front();
+    }
+
+    // decode next frame in background, one frame ahead of the time to show it
+    if ( !decoded_.image.valid() && !stored_.empty() && now_ + double(dt) * 0.001 - stored_.front().elapsed > delay_ &&
+         stored_.front().image.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready ) {
+        Image *image = stored_.front().image.get();
+        decoded_.elapsed = stored_.front().elapsed;
+        decoded_.image = ThreadPool::manager().async( [image]{ return decode(image); } );
+        stored_.pop_front();
+    }
+
+    // upload decoded image in output frame buffer when it is due
+    if ( decoded_.image.valid() && now_ - decoded_.elapsed > delay_ &&
+         decoded_.image.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready ) {
+        Image *image = decoded_.image.get();
+        if (image) {
+            // (re)create output frame buffer
+            if (output_ == nullptr || output_->width() != (uint) image->width || output_->height() != (uint) image->height) {
+                if (output_)
+                    delete output_;
+                output_ = new FrameBuffer(image->width, image->height,
+                                          image->channels > 3 ? FrameBuffer::FrameBuffer_alpha : FrameBuffer::FrameBuffer_rgb);
+                output_->begin();
+                output_->end();
+            }
+            // fill texture with pixels
+            glBindTexture(GL_TEXTURE_2D, output_->texture());
+            glPixelStorei(GL_UNPACK_ALIGNMENT, image->channels > 3 ? 4 : 1);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image->width, image->height,
+                            image->channels > 3 ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, image->data.data());
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glBindTexture(GL_TEXTURE_2D, 0);
+            delete image;
+        }
+    }
+
+    // limit memory used by all delay filters
+    if ( Image::allocated > budget() && !stored_.empty() && now_ - stored_.front().elapsed < delay_ - (dt * 0.001) ) {
+        // set delay to maximum affordable
+        delay_ = now_ - stored_.front().elapsed - (dt * 0.001);
+        Log::Warning("Cannot satisfy delay: %d MB of RAM reserved for delays used.", Settings::application.render.delay_memory);
+    }
+}
+
 uint DelayFilter::texture () const
 {
-    if (!frames_.empty())
+    if (use_ram_)
+        return output_ ? output_->texture() : Resource::getTextureBlack();
+    else if (!frames_.empty())
         return frames_.front()->texture();
     else if (input_)
         return input_->texture();
@@ -137,10 +300,57 @@ void DelayFilter::draw (FrameBuffer *input)
 {
     input_ = input;
 
-    if ( enabled() )
+    if ( enabled() && input_ )
     {
+        if (use_ram_) {
+            // do not store more when out of memory budget
+            if ( Image::allocated > budget() )
+                return;
+
+            // (re)create pixel buffers to read input
+            const glm::ivec3 format(input_->width(), input_->height(),
+                                    (input_->flags() & FrameBuffer::FrameBuffer_alpha) ? 4 : 3);
+            if ( format != pbo_format_ ) {
+                pbo_format_ = format;
+                pbo_size_ = format.x * format.y * format.z;
+                if (pbo_[0])
+                    glDeleteBuffers(2, pbo_);
+                glGenBuffers(2, pbo_);
+                for (int i = 0; i < 2; ++i) {
+                    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo_[i]);
+                    glBufferData(GL_PIXEL_PACK_BUFFER, pbo_size_, NULL, GL_STREAM_READ);
+                    pbo_elapsed_[i] = -1.0;
+                }
+            }
+
+            // asynchronous read of input pixels into a pixel buffer
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo_[pbo_index_]);
+            input_->readPixels();
+            pbo_elapsed_[pbo_index_] = now_;
+
+            // get pixels read at previous frame in the other pixel buffer
+            pbo_index_ = (pbo_index_ + 1) % 2;
+            if (pbo_elapsed_[pbo_index_] >= 0.0) {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo_[pbo_index_]);
+                uint8_t *ptr = (uint8_t *) glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+                if (ptr) {
+                    std::vector<uint8_t> pixels(ptr, ptr + pbo_size_);
+                    StoredFrame f;
+                    f.elapsed = pbo_elapsed_[pbo_index_];
+                    // compress in background
+                    f.image = ThreadPool::manager().async( [p = std::move(pixels), format = pbo_format_,
+                                                           compress = Settings::application.render.delay_compression]() mutable {
+                        return encode(std::move(p), format.x, format.y, format.z, compress);
+                    });
+                    stored_.push_back( std::move(f) );
+                }
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+                pbo_elapsed_[pbo_index_] = -1.0;
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
         // make sure the queue is not empty
-        if ( input_ && !frames_.empty() ) {
+        else if ( !frames_.empty() ) {
             // blit input framebuffer in the newest image in queue (back)
             input_->blit( frames_.back() );
         }
@@ -152,4 +362,3 @@ void DelayFilter::accept (Visitor& v)
     FrameBufferFilter::accept(v);
     v.visit(*this);
 }
-
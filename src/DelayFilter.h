@@ -2,13 +2,29 @@
 #define DELAYFILTER_H
 
 #include <queue>
+#include <deque>
+#include <future>
+#include <atomic>
 #include <glm/glm.hpp>
 
+#include "defines.h"
 #include "FrameBufferFilter.h"
 
+#define DELAY_FILTER_MAX 60.0
+#define DELAY_FILTER_GPU_MAX 2.0
+
 class Surface;
 class FrameBuffer;
 
+/**
+ * @brief The DelayFilter shows its input with a delay.
+ *
+ * Short delays keep the frames in graphics card memory (one FBO per frame).
+ * Longer delays (above DELAY_FILTER_GPU_MAX, or when the graphics card
+ * runs out of memory) read frames back into RAM, possibly compressed in JPEG
+ * by background threads of the ThreadPool, and upload them again when shown.
+ * The RAM used by all delay filters is limited by Settings render.delay_memory.
+ */
 class DelayFilter : public FrameBufferFilter
 {
 public:
@@ -16,7 +32,7 @@ public:
     ~DelayFilter();
 
     // delay property
-    inline void setDelay(double second) { delay_ = second; }
+    inline void setDelay(double second) { delay_ = CLAMP(second, 0.0, DELAY_FILTER_MAX); }
     inline double delay() const { return delay_; }
 
     // implementation of FrameBufferFilter
@@ -29,14 +45,40 @@ public:
     void draw   (FrameBuffer *input) override;
     void accept (Visitor& v) override;
 
+    // RAM used by all delay filters, in Bytes
+    static size_t memory ();
+
+    // a frame stored in RAM
+    struct Image;
+
 private:
-    // queue of frames
+    // queue of frames in graphics card
     std::queue<FrameBuffer *> frames_;
     std::queue<double> elapsed_;
 
     // render management
     FrameBuffer *temp_frame_;
 
+    // queue of frames in RAM
+    struct StoredFrame {
+        double elapsed;
+        std::future<Image *> image;
+    };
+    std::deque<StoredFrame> stored_;
+    bool use_ram_;
+    bool gpu_full_;
+    void updateRam (float dt);
+    void clear ();
+
+    // read back of input and upload of output in RAM mode
+    FrameBuffer *output_;
+    StoredFrame decoded_;
+    uint pbo_[2];
+    uint pbo_size_;
+    uint pbo_index_;
+    double pbo_elapsed_[2];
+    glm::ivec3 pbo_format_;
+
     // time management
     double now_;
     double delay_;
@@ -515,7 +515,8 @@ void DeviceSource::setDevice(const std::string &devicename)
                 // new stream
                 stream_ = h->stream = new Stream;
 
-                // open gstreamer
+                // open gstreamer (opaque frames can be converted on GPU)
+                h->stream->setYuvTexturing(true);
                 h->stream->open( pipeline.str(), best.width, best.height);
                 h->stream->play(true);
             }
@@ -29,14 +29,20 @@
 #include "Log.h"
 #include "GstToolkit.h"
 #include "BaseToolkit.h"
+#include "Settings.h"
+#include "Shader.h"
 #include "FrameBuffer.h"
+#include "SharedEncoder.h"
+#include "Profiler.h"
 
 #include "FrameGrabber.h"
 
 
 
 FrameGrabbing::FrameGrabbing(): pbo_index_(0), pbo_next_index_(0), size_(0),
-    width_(0), height_(0), use_alpha_(0), caps_(NULL)
+    width_(0), height_(0), use_alpha_(0), use_yuv_(false), caps_(NULL),
+    yuv_program_(nullptr), yuv_framebuffer_(0), yuv_texture_(0), yuv_vao_(0),
+    pool_(NULL), pool_hits_(0), pool_misses_(0)
 {
     pbo_[0] = 0;
     pbo_[1] = 0;
@@ -46,10 +52,17 @@ FrameGrabbing::~FrameGrabbing()
 {
     // stop and delete all frame grabbers
     clearAll();
+    SharedEncoder::clearAll();
 
     // cleanup
+    if (pool_) {
+        gst_buffer_pool_set_active (pool_, FALSE);
+        gst_object_unref (pool_);
+    }
     if (caps_)
         gst_caps_unref (caps_);
+    if (yuv_program_)
+        delete yuv_program_;
 //    if (pbo_[0] > 0) // automatically deleted at shutdown
 //        glDeleteBuffers(2, pbo_);
 }
@@ -135,16 +148,55 @@ void FrameGrabbing::grabFrame(FrameBuffer *frame_buffer)
     if (frame_buffer == nullptr)
         return;
 
+    PROFILE_GPU_SCOPE("grabber", "grab");
+
+    // GPU colorspace conversion only for RGB frames with size compatible with I420,
+    // and it cannot be changed while grabbers are running
+    bool yuv = grabbers_.empty() ? Settings::application.record.gpu_conversion : use_yuv_;
+    yuv = yuv && !(frame_buffer->flags() & FrameBuffer::FrameBuffer_alpha) &&
+          frame_buffer->width() % 8 == 0 && frame_buffer->height() % 2 == 0;
+
     // if different frame buffer from previous frame
     if ( frame_buffer->width() != width_ ||
          frame_buffer->height() != height_ ||
-         (frame_buffer->flags() & FrameBuffer::FrameBuffer_alpha) != use_alpha_) {
+         (frame_buffer->flags() & FrameBuffer::FrameBuffer_alpha) != use_alpha_ ||
+         yuv != use_yuv_ ) {
 
         // define stream properties
         width_ = frame_buffer->width();
         height_ = frame_buffer->height();
         use_alpha_ = (frame_buffer->flags() & FrameBuffer::FrameBuffer_alpha);
-        size_ = width_ * height_ * (use_alpha_ ? 4 : 3);
+        use_yuv_ = yuv;
+
+        // (re)create the single channel target of the YUV conversion
+        if (yuv_texture_ > 0) {
+            glDeleteTextures(1, &yuv_texture_);
+            yuv_texture_ = 0;
+        }
+        if (use_yuv_) {
+            if (yuv_framebuffer_ == 0)
+                glGenFramebuffers(1, &yuv_framebuffer_);
+            glGenTextures(1, &yuv_texture_);
+            glBindTexture(GL_TEXTURE_2D, yuv_texture_);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width_, (height_ * 3) / 2, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glBindTexture(GL_TEXTURE_2D, 0);
+            glBindFramebuffer(GL_FRAMEBUFFER, yuv_framebuffer_);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, yuv_texture_, 0);
+            if ( glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE ) {
+                Log::Warning("Frame capture : GPU colorspace conversion not supported.");
+                Settings::application.record.gpu_conversion = false;
+                use_yuv_ = false;
+            }
+            FrameBuffer::release();
+        }
+
+        // size of a frame : planar YUV 4:2:0 is 12 bits per pixel
+        if (use_yuv_)
+            size_ = (width_ * height_ * 3) / 2;
+        else
+            size_ = width_ * height_ * (use_alpha_ ? 4 : 3);
 
         // first time initialization
         if ( pbo_[0] == 0 )
@@ -163,11 +215,36 @@ void FrameGrabbing::grabFrame(FrameBuffer *frame_buffer)
         // new caps
         if (caps_)
             gst_caps_unref (caps_);
-        caps_ = gst_caps_new_simple ("video/x-raw",
-                                     "format", G_TYPE_STRING, use_alpha_ ? "RGBA" : "RGB",
-                                     "width",  G_TYPE_INT, width_,
-                                     "height", G_TYPE_INT, height_,
-                                     NULL);
+        if (use_yuv_)
+            caps_ = gst_caps_new_simple ("video/x-raw",
+                                         "format", G_TYPE_STRING, "I420",
+                                         "width",  G_TYPE_INT, width_,
+                                         "height", G_TYPE_INT, height_,
+                                         "colorimetry", G_TYPE_STRING, "bt709",
+                                         NULL);
+        else
+            caps_ = gst_caps_new_simple ("video/x-raw",
+                                         "format", G_TYPE_STRING, use_alpha_ ? "RGBA" : "RGB",
+                                         "width",  G_TYPE_INT, width_,
+                                         "height", G_TYPE_INT, height_,
+                                         NULL);
+
+        // new pool of buffers of the new size
+        // NB: buffers still in use by grabbers are freed when released to the inactive pool
+        if (pool_) {
+            gst_buffer_pool_set_active (pool_, FALSE);
+            gst_object_unref (pool_);
+        }
+        pool_ = gst_buffer_pool_new ();
+        GstStructure *config = gst_buffer_pool_get_config (pool_);
+        gst_buffer_pool_config_set_params (config, caps_, size_, MIN_POOL_BUFFERS, MAX_POOL_BUFFERS);
+        if ( !gst_buffer_pool_set_config (pool_, config) || !gst_buffer_pool_set_active (pool_, TRUE) ) {
+            Log::Warning("Frame capture : cannot allocate pool of buffers.");
+            gst_object_unref (pool_);
+            pool_ = NULL;
+        }
+        pool_hits_ = 0;
+        pool_misses_ = 0;
     }
 
     // fill a frame in buffer
@@ -175,17 +252,30 @@ void FrameGrabbing::grabFrame(FrameBuffer *frame_buffer)
 
         GstBuffer *buffer = nullptr;
 
+        // render frame into planar YUV
+        if (use_yuv_)
+            convertFrame(frame_buffer);
+
         // set buffer target for writing in a new frame
         glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo_[pbo_index_]);
 
+        if (use_yuv_) {
+            // get converted frame
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, yuv_framebuffer_);
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glReadPixels(0, 0, width_, (height_ * 3) / 2, GL_RED, GL_UNSIGNED_BYTE, 0);
+            FrameBuffer::release();
+        }
+        else {
 #ifdef USE_GLREADPIXEL
-        // get frame
-        frame_buffer->readPixels();
+            // get frame
+            frame_buffer->readPixels();
 #else
-        glBindTexture(GL_TEXTURE_2D, frame_buffer->texture());
-        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_UNSIGNED_BYTE, 0);
-        glBindTexture(GL_TEXTURE_2D, 0);
+            glBindTexture(GL_TEXTURE_2D, frame_buffer->texture());
+            glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_UNSIGNED_BYTE, 0);
+            glBindTexture(GL_TEXTURE_2D, 0);
 #endif
+        }
 
         // update case ; alternating indices
         if ( pbo_next_index_ != pbo_index_ ) {
@@ -193,8 +283,8 @@ void FrameGrabbing::grabFrame(FrameBuffer *frame_buffer)
             // set buffer target for saving the frame
             glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo_[pbo_next_index_]);
 
-            // new buffer
-            buffer = gst_buffer_new_and_alloc (size_);
+            // get a buffer
+            buffer = acquireBuffer();
 
             // map gst buffer into a memory  WRITE target
             GstMapInfo map;
@@ -221,6 +311,9 @@ void FrameGrabbing::grabFrame(FrameBuffer *frame_buffer)
         // a frame was successfully grabbed
         if ( buffer != nullptr && gst_buffer_get_size(buffer) > 0) {
 
+            // give the frame to shared encoders
+            SharedEncoder::grabFrame(buffer, caps_);
+
             // give the frame to all recorders
             std::list<FrameGrabber *>::iterator iter = grabbers_.begin();
             while (iter != grabbers_.end())
@@ -232,6 +325,9 @@ void FrameGrabbing::grabFrame(FrameBuffer *frame_buffer)
                 if (rec->finished()) {
                     iter = grabbers_.erase(iter);
                     delete rec;
+                    if (grabbers_.empty() && grabbers_chain_.empty())
+                        Log::Info("Frame capture : %lu frames in recycled buffers, %lu in new buffers.",
+                                  (unsigned long) pool_hits_, (unsigned long) pool_misses_);
                 }
                 else
                     ++iter;
@@ -267,8 +363,63 @@ void FrameGrabbing::grabFrame(FrameBuffer *frame_buffer)
 }
 
 
+void FrameGrabbing::convertFrame(FrameBuffer *frame_buffer)
+{
+    // first time initialization
+    if (yuv_program_ == nullptr) {
+        yuv_program_ = new ShadingProgram("shaders/yuv420.vs", "shaders/yuv420.fs");
+        // empty vertex array: the vertex shader generates the vertices
+        glGenVertexArrays(1, &yuv_vao_);
+    }
+
+    // draw in the YUV target
+    glBindFramebuffer(GL_FRAMEBUFFER, yuv_framebuffer_);
+    RenderingAttrib attrib;
+    attrib.viewport = glm::ivec2(width_, (height_ * 3) / 2);
+    attrib.clear_color = glm::vec4(0.f);
+    Rendering::manager().pushAttrib(attrib);
+    glDisable(GL_BLEND);
+
+    // render full screen with conversion shader reading the frame texture
+    yuv_program_->use();
+    yuv_program_->setUniform("iResolution", glm::vec3(width_, height_, 0.f));
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, frame_buffer->texture());
+    glBindVertexArray(yuv_vao_);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    ShadingProgram::enduse();
+
+    Rendering::manager().popAttrib();
+    FrameBuffer::release();
+}
+
+GstBuffer *FrameGrabbing::acquireBuffer()
+{
+    GstBuffer *buffer = nullptr;
+
+    // recycle a buffer from the pool if one was released by grabbers
+    // (do not wait if all buffers of the pool are still in use)
+    if (pool_) {
+        GstBufferPoolAcquireParams params = { GST_FORMAT_UNDEFINED, 0, 0, GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT };
+        if ( gst_buffer_pool_acquire_buffer (pool_, &buffer, &params) == GST_FLOW_OK )
+            ++pool_hits_;
+        else
+            buffer = nullptr;
+    }
+
+    // fallback to allocation of a new buffer
+    if (buffer == nullptr) {
+        buffer = gst_buffer_new_and_alloc (size_);
+        ++pool_misses_;
+    }
 
-FrameGrabber::FrameGrabber(): finished_(false), initialized_(false), active_(false),
+    return buffer;
+}
+
+FrameGrabber::FrameGrabber(): encoder_(nullptr), encoded_(false), encoded_resync_(true), encoded_offset_(0),
+    finished_(false), initialized_(false), active_(false),
     endofstream_(false), accept_buffer_(false), buffering_full_(false), pause_(false),
     pipeline_(nullptr), src_(nullptr), caps_(nullptr), timer_(nullptr), timer_firstframe_(0),
     timer_pauseframe_(0), timestamp_(0), duration_(0), pause_duration_(0), frame_count_(0),
@@ -282,6 +433,9 @@ FrameGrabber::FrameGrabber(): finished_(false), initialized_(false), active_(fal
 
 FrameGrabber::~FrameGrabber()
 {
+    if (encoder_ != nullptr)
+        SharedEncoder::unsubscribe(this);
+
     if (src_ != nullptr)
         gst_object_unref (src_);
     if (caps_ != nullptr)
@@ -321,7 +475,7 @@ void FrameGrabber::setPaused(bool pause)
     if (active_) {
 
         // keep time of switch from not-paused to paused
-        if (pause && !pause_)
+        if (pause && !pause_ && timer_)
             timer_pauseframe_ = gst_clock_get_time(timer_);
 
         // set to paused
@@ -344,6 +498,10 @@ void FrameGrabber::stop ()
     // stop recording
     active_ = false;
 
+    // no more encoded samples needed
+    if (encoder_ != nullptr)
+        SharedEncoder::unsubscribe(this);
+
     // send end of stream
     gst_element_send_event (pipeline_, gst_event_new_eos ());
 
@@ -475,7 +633,8 @@ void FrameGrabber::addFrame (GstBuffer *buffer, GstCaps *caps)
     }
 
     // store a frame if recording is active and if the encoder accepts data
-    if (active_)
+    // (unless frames are encoded by a SharedEncoder)
+    if (active_ && !encoded_)
     {
         // how much buffer is used
         buffering_count_ = gst_app_src_get_current_level_bytes(src_);
@@ -593,6 +752,48 @@ void FrameGrabber::addFrame (GstBuffer *buffer, GstCaps *caps)
 }
 
 
+void FrameGrabber::addEncodedSample (GstSample *sample)
+{
+    // NB: called in the streaming thread of the SharedEncoder
+    GstBuffer *buffer = gst_sample_get_buffer(sample);
+    if (!active_ || buffer == NULL || !GST_BUFFER_PTS_IS_VALID(buffer))
+        return;
+
+    // how much buffer is used
+    buffering_count_ = gst_app_src_get_current_level_bytes(src_);
+
+    // skip samples when paused or when appsrc is full, and resume on next key frame
+    if (pause_ || !accept_buffer_ || buffering_size_ - buffering_count_ < MIN_BUFFER_SIZE) {
+        encoded_resync_ = true;
+        return;
+    }
+    if (encoded_resync_) {
+        if ( GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT) )
+            return;
+        // offset timestamps to continue after last frame (start at zero)
+        GstClockTime next = frame_count_ > 0 ? timestamp_ + frame_duration_ : 0;
+        encoded_offset_ = GST_BUFFER_PTS(buffer) > next ? GST_BUFFER_PTS(buffer) - next : 0;
+        encoded_resync_ = false;
+    }
+
+    // shallow copy of the buffer (data is shared) to change timestamps
+    GstBuffer *b = gst_buffer_copy(buffer);
+    GST_BUFFER_PTS(b) -= encoded_offset_;
+    if ( GST_BUFFER_DTS_IS_VALID(b) )
+        GST_BUFFER_DTS(b) = GST_BUFFER_DTS(b) > encoded_offset_ ? GST_BUFFER_DTS(b) - encoded_offset_ : 0;
+    timestamp_ = GST_BUFFER_PTS(b);
+
+    // push sample with encoded caps
+    GstSample *s = gst_sample_new(b, gst_sample_get_caps(sample), NULL, NULL);
+    gst_app_src_push_sample (src_, s);
+    gst_sample_unref (s);
+    gst_buffer_unref (b);
+
+    // count frames
+    frame_count_++;
+    duration_ = timestamp_;
+}
+
 uint FrameGrabber::buffering() const
 {
     guint64 p = (100 * buffering_count_) / buffering_size_;
@@ -17,8 +17,13 @@
 #define USE_GLREADPIXEL
 #define DEFAULT_GRABBER_FPS 30
 #define MIN_BUFFER_SIZE 33177600  // 33177600 bytes = 1 frames 4K, 9 frames 720p
+// number of frames recycled by the buffer pool of FrameGrabbing
+#define MIN_POOL_BUFFERS 2
+#define MAX_POOL_BUFFERS 12
 
 class FrameBuffer;
+class ShadingProgram;
+class SharedEncoder;
 
 
 /**
@@ -28,10 +33,14 @@ class FrameBuffer;
  * Every subclass shall at least implement init() and terminate()
  *
  * The FrameGrabbing manager calls addFrame() for all its grabbers.
+ *
+ * A grabber subscribed to a SharedEncoder does not encode the frames
+ * itself: it receives H264 samples in addEncodedSample().
  */
 class FrameGrabber
 {
     friend class FrameGrabbing;
+    friend class SharedEncoder;
 
     uint64_t id_;
 
@@ -62,6 +71,13 @@ protected:
     virtual std::string init(GstCaps *caps) = 0;
     virtual void terminate() = 0;
 
+    // only SharedEncoder can add encoded samples
+    void addEncodedSample(GstSample *sample);
+    SharedEncoder *encoder_;
+    bool encoded_;
+    std::atomic<bool> encoded_resync_;
+    GstClockTime encoded_offset_;
+
     // thread-safe testing termination
     std::atomic<bool> finished_;
     std::atomic<bool> initialized_;
@@ -127,6 +143,11 @@ public:
 
     inline uint width() const { return width_; }
     inline uint height() const { return height_; }
+    inline bool yuv() const { return use_yuv_; }
+
+    // statistics of the frame buffer pool
+    inline guint64 poolHits() const { return pool_hits_; }
+    inline guint64 poolMisses() const { return pool_misses_; }
 
     void add(FrameGrabber *rec);
     void chain(FrameGrabber *rec, FrameGrabber *new_rec);
@@ -142,6 +163,9 @@ protected:
     void grabFrame(FrameBuffer *frame_buffer);
 
 private:
+    GstBuffer *acquireBuffer();
+    void convertFrame(FrameBuffer *frame_buffer);
+
     std::list<FrameGrabber *> grabbers_;
     std::map<FrameGrabber *, FrameGrabber *> grabbers_chain_;
     guint pbo_[2];
@@ -151,7 +175,19 @@ private:
     guint width_;
     guint height_;
     bool  use_alpha_;
+    bool  use_yuv_;
     GstCaps *caps_;
+
+    // GPU conversion of frames to planar YUV (I420)
+    ShadingProgram *yuv_program_;
+    guint yuv_framebuffer_;
+    guint yuv_texture_;
+    guint yuv_vao_;
+
+    // pool of buffers recycled for each frame
+    GstBufferPool *pool_;
+    guint64 pool_hits_;
+    guint64 pool_misses_;
 };
 
 
@@ -0,0 +1,176 @@
+/*
+ * This file is part of vimix - video live mixer
+ *
+ * **Copyright** (C) 2019-2023 Bruno Herbelin <bruno.herbelin@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "FrameRing.h"
+
+FrameRing::FrameRing(guint depth, bool reference) : slots_( MAX(depth, 1) + 1 ),
+    head_(0), tail_(0), eos_(false), eos_position_(GST_CLOCK_TIME_NONE),
+    reference_(reference), references_(0), pushed_(0), dropped_(0), skipped_(0)
+{
+
+}
+
+FrameRing::~FrameRing()
+{
+    clear();
+}
+
+void FrameRing::release(Frame &frame)
+{
+    if (frame.buffer)
+        gst_buffer_unref(frame.buffer);
+    if (frame.caps)
+        gst_caps_unref(frame.caps);
+    if (frame.referenced)
+        --references_;
+    frame = Frame();
+}
+
+bool FrameRing::drop(Status status)
+{
+    // NB: called by the producer with access locked (consumer not pulling)
+    const guint t = tail_.load(std::memory_order_relaxed);
+    const guint h = head_.load(std::memory_order_relaxed);
+    const guint n = slots_.size();
+
+    // the consumer freed a slot meanwhile
+    if ( (h + 1) % n != t )
+        return true;
+
+    // find the oldest frame which is not a pre-roll
+    guint d = t;
+    while ( d != h && slots_[d].status == PREROLL )
+        d = (d + 1) % n;
+    if ( d == h ) {
+        // only pre-rolls are waiting: drop the new sample
+        if (status != PREROLL)
+            return false;
+        // or replace the oldest pre-roll by the new one
+        d = t;
+    }
+
+    // drop this frame, and move the older ones to fill its slot
+    release(slots_[d]);
+    ++dropped_;
+    for ( ; d != t; d = (d + n - 1) % n )
+        slots_[d] = slots_[(d + n - 1) % n];
+    slots_[t] = Frame();
+
+    // give the slot to the producer
+    tail_.store((t + 1) % n, std::memory_order_release);
+
+    return true;
+}
+
+bool FrameRing::push(GstBuffer *buf, Status status, GstClockTime position, GstCaps *caps)
+{
+    // null buffer for EOS: only signal it to the consumer
+    if (buf == NULL || status == EOS) {
+        eos_position_.store(position);
+        eos_.store(true, std::memory_order_release);
+        return true;
+    }
+
+    // if the consumer did not free a slot, drop the oldest frame
+    const guint h = head_.load(std::memory_order_relaxed);
+    const guint next = (h + 1) % slots_.size();
+    if ( next == tail_.load(std::memory_order_acquire) ) {
+        std::lock_guard<std::mutex> lock(access_);
+        if ( !drop(status) ) {
+            ++dropped_;
+            return false;
+        }
+    }
+
+    // fill the slot, only accessed by the producer until head moves
+    // (reference the buffer of the appsink only if not holding too many)
+    Frame &f = slots_[h];
+    f.referenced = reference_ && references_.load() < FRAME_RING_MAX_REFERENCES;
+    f.buffer = f.referenced ? gst_buffer_ref(buf) : gst_buffer_copy(buf);
+    if (f.referenced)
+        ++references_;
+    f.caps = caps ? gst_caps_ref(caps) : NULL;
+    f.status = status;
+    f.position = position;
+
+    // give the slot to the consumer
+    head_.store(next, std::memory_order_release);
+    ++pushed_;
+
+    return true;
+}
+
+bool FrameRing::pull(Frame &frame)
+{
+    bool got = false;
+    std::lock_guard<std::mutex> lock(access_);
+
+    // read all frames given by the producer and keep the last
+    guint t = tail_.load(std::memory_order_relaxed);
+    const guint h = head_.load(std::memory_order_acquire);
+    while ( t != h ) {
+        // older frame is late: skip it
+        if (got) {
+            if (frame.buffer)
+                gst_buffer_unref(frame.buffer);
+            if (frame.caps)
+                gst_caps_unref(frame.caps);
+            ++skipped_;
+        }
+        // take ownership of buffer and caps in slot
+        // (a referenced buffer is released by the caller right away)
+        frame = slots_[t];
+        if (frame.referenced)
+            --references_;
+        slots_[t] = Frame();
+        t = (t + 1) % slots_.size();
+        got = true;
+        // do NOT jump over a pre-roll
+        if (frame.status == PREROLL)
+            break;
+    }
+
+    // give the slots back to the producer
+    tail_.store(t, std::memory_order_release);
+
+    // end of stream once all frames before were read
+    if ( !got && eos_.load(std::memory_order_acquire) &&
+         head_.load(std::memory_order_acquire) == t &&
+         eos_.exchange(false) ) {
+        frame = Frame();
+        frame.status = EOS;
+        frame.position = eos_position_.load();
+        got = true;
+    }
+
+    return got;
+}
+
+void FrameRing::clear()
+{
+    std::lock_guard<std::mutex> lock(access_);
+
+    // free all frames given by the producer
+    guint t = tail_.load(std::memory_order_relaxed);
+    const guint h = head_.load(std::memory_order_acquire);
+    for ( ; t != h; t = (t + 1) % slots_.size() )
+        release(slots_[t]);
+    tail_.store(t, std::memory_order_release);
+    eos_ = false;
+}
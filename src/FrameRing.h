@@ -0,0 +1,101 @@
+#ifndef FRAMERING_H
+#define FRAMERING_H
+
+#include <vector>
+#include <atomic>
+#include <mutex>
+
+#include <gst/gst.h>
+
+// maximum number of buffers of the appsink referenced in the ring
+// (buffer pools of sources like v4l2 can have very few buffers)
+#define FRAME_RING_MAX_REFERENCES 1
+
+/**
+ * @brief The FrameRing passes decoded frames from the gstreamer streaming
+ * thread (single producer) to the rendering thread (single consumer).
+ *
+ * The producer pushes frames without locks. When the ring is full, the
+ * oldest frame is dropped to make room (the only case where the producer
+ * waits for the consumer, which pulls under a short lock). A pre-roll frame
+ * is never dropped for a sample: if only pre-rolls are waiting, the new
+ * sample is dropped (and a new pre-roll replaces the oldest one).
+ *
+ * The consumer pulls the most recent frame and skips the older ones.
+ * A pre-roll frame is never skipped, and an end-of-stream is given to the
+ * consumer once all frames before it were pulled.
+ *
+ * In reference mode, the ring keeps a reference to the GstBuffer given
+ * by the appsink instead of a copy of it, for at most FRAME_RING_MAX_REFERENCES
+ * frames (others are copied) not to starve the buffer pool of the source.
+ *
+ * Each frame keeps a reference to the caps negotiated for its buffer,
+ * to read the actual colorimetry, range and strides of the frame.
+ */
+class FrameRing
+{
+public:
+
+    typedef enum  {
+        SAMPLE = 0,
+        PREROLL = 1,
+        EOS = 2,
+        INVALID = 3
+    } Status;
+
+    struct Frame {
+        GstBuffer *buffer;
+        GstCaps *caps;
+        Status status;
+        GstClockTime position;
+        bool referenced;
+
+        Frame() {
+            buffer = NULL;
+            caps = NULL;
+            status = INVALID;
+            position = GST_CLOCK_TIME_NONE;
+            referenced = false;
+        }
+    };
+
+    FrameRing(guint depth, bool reference = false);
+    ~FrameRing();
+
+    // Producer: push a frame (buffer is NULL for EOS) with the caps of the sample
+    // Returns false if this frame was dropped because the ring is full of pre-rolls
+    bool push(GstBuffer *buf, Status status, GstClockTime position, GstCaps *caps = NULL);
+
+    // Consumer: get the most recent frame, if any.
+    // The caller owns the buffer and caps of the frame and must unref them.
+    bool pull(Frame &frame);
+
+    // Consumer: discard all frames
+    void clear();
+
+    inline guint depth() const { return slots_.size() - 1; }
+    inline bool reference() const { return reference_; }
+
+    // statistics
+    inline guint64 pushed() const { return pushed_; }
+    inline guint64 dropped() const { return dropped_; }
+    inline guint64 skipped() const { return skipped_; }
+
+private:
+    std::vector<Frame> slots_;
+    std::atomic<guint> head_;
+    std::atomic<guint> tail_;
+    std::atomic<bool> eos_;
+    std::atomic<GstClockTime> eos_position_;
+    bool reference_;
+    std::atomic<guint> references_;
+    std::mutex access_;
+    bool drop(Status status);
+    void release(Frame &frame);
+
+    std::atomic<guint64> pushed_;
+    std::atomic<guint64> dropped_;
+    std::atomic<guint64> skipped_;
+};
+
+#endif // FRAMERING_H
@@ -111,7 +111,7 @@ void ImGuiVisitor::visit(Group &n)
     if (ImGui::IsItemDeactivatedAfterEdit()){
         std::ostringstream oss;
         oss << "Position " << std::setprecision(3) << n.translation_.x << ", " << n.translation_.y;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Position");
     }
     if (ImGuiToolkit::ButtonIcon(3, 15))  {
         n.scale_.x = 1.f;
@@ -129,7 +129,7 @@ void ImGuiVisitor::visit(Group &n)
     if (ImGui::IsItemDeactivatedAfterEdit()){
         std::ostringstream oss;
         oss << "Scale " << std::setprecision(3) << n.scale_.x << " x " << n.scale_.y;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Scale");
     }
 
     if (ImGuiToolkit::ButtonIcon(18, 9)){
@@ -142,7 +142,7 @@ void ImGuiVisitor::visit(Group &n)
     if (ImGui::IsItemDeactivatedAfterEdit()) {
         std::ostringstream oss;
         oss << "Angle " << std::setprecision(3) << n.rotation_.z * 180.f / M_PI;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Angle");
     }
 
 
@@ -257,7 +257,7 @@ void ImGuiVisitor::visit(ImageProcessingShader &n)
         ImFormatString(buf, IM_ARRAYSIZE(buf), "#%02X%02X%02X", ImClamp((int)ceil(255.f * n.gamma.x),0,255),
                        ImClamp((int)ceil(255.f * n.gamma.y),0,255), ImClamp((int)ceil(255.f * n.gamma.z),0,255));
         oss << "Gamma color " << buf;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Gamma color");
     }
 
     ImGui::SameLine(0, IMGUI_SAME_LINE);
@@ -269,17 +269,17 @@ void ImGuiVisitor::visit(ImageProcessingShader &n)
         val = CLAMP(val + 0.001f * io.MouseWheel, -1.f, 1.f);
         n.gamma.w = powf(10.f, val);
         oss << "Gamma " << std::setprecision(3) << val;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Gamma");
     }
     if (ImGui::IsItemDeactivatedAfterEdit()){
         oss << "Gamma " << std::setprecision(3) << val;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Gamma");
     }
     ImGui::SameLine(0, IMGUI_SAME_LINE);
     if (ImGuiToolkit::TextButton("Gamma")) {
         n.gamma = glm::vec4(1.f, 1.f, 1.f, 1.f);
         oss << "Gamma 0.0, #FFFFFF";
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Gamma");
     }
 
     ///
@@ -290,17 +290,17 @@ void ImGuiVisitor::visit(ImageProcessingShader &n)
     if (ImGui::IsItemHovered() && io.MouseWheel != 0.f ){
         n.brightness = CLAMP(n.brightness + 0.001f * io.MouseWheel, -1.f, 1.f);
         oss << "Brightness " << std::setprecision(3) << n.brightness;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Brightness");
     }
     if (ImGui::IsItemDeactivatedAfterEdit()){
         oss << "Brightness " << std::setprecision(3) << n.brightness;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Brightness");
     }
     ImGui::SameLine(0, IMGUI_SAME_LINE);
     if (ImGuiToolkit::TextButton("Brightness")) {
         n.brightness = 0.f;
         oss << "Brightness " << std::setprecision(2) << n.brightness;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Brightness");
     }
 
     ///
@@ -311,17 +311,17 @@ void ImGuiVisitor::visit(ImageProcessingShader &n)
     if (ImGui::IsItemHovered() && io.MouseWheel != 0.f ){
         n.contrast = CLAMP(n.contrast + 0.001f * io.MouseWheel, -1.f, 1.f);
         oss << "Contrast " << std::setprecision(3) << n.contrast;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Contrast");
     }
     if (ImGui::IsItemDeactivatedAfterEdit()){
         oss << "Contrast " << std::setprecision(3) << n.contrast;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Contrast");
     }
     ImGui::SameLine(0, IMGUI_SAME_LINE);
     if (ImGuiToolkit::TextButton("Contrast")) {
         n.contrast = 0.f;
         oss << "Contrast " << std::setprecision(2) << n.contrast;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Contrast");
     }
 
     ///
@@ -332,17 +332,17 @@ void ImGuiVisitor::visit(ImageProcessingShader &n)
     if (ImGui::IsItemHovered() && io.MouseWheel != 0.f ){
         n.saturation = CLAMP(n.saturation + 0.001f * io.MouseWheel, -1.f, 1.f);
         oss << "Saturation " << std::setprecision(3) << n.saturation;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Saturation");
     }
     if (ImGui::IsItemDeactivatedAfterEdit()){
         oss << "Saturation " << std::setprecision(3) << n.saturation;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Saturation");
     }
     ImGui::SameLine(0, IMGUI_SAME_LINE);
     if (ImGuiToolkit::TextButton("Saturation")) {
         n.saturation = 0.f;
         oss << "Saturation " << std::setprecision(2) << n.saturation;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Saturation");
     }
 
     ///
@@ -353,17 +353,17 @@ void ImGuiVisitor::visit(ImageProcessingShader &n)
     if (ImGui::IsItemHovered() && io.MouseWheel != 0.f ){
         n.hueshift = CLAMP(n.hueshift + 0.001f * io.MouseWheel, 0.f, 1.f);
         oss << "Hue shift " << std::setprecision(3) << n.hueshift;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Hue shift");
     }
     if (ImGui::IsItemDeactivatedAfterEdit()){
         oss << "Hue shift " << std::setprecision(3) << n.hueshift;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Hue shift");
     }
     ImGui::SameLine(0, IMGUI_SAME_LINE);
     if (ImGuiToolkit::TextButton("Hue ")) {
         n.hueshift = 0.f;
         oss << "Hue shift  " << std::setprecision(2) << n.hueshift;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Hue shift");
     }
 
     ///
@@ -377,19 +377,19 @@ void ImGuiVisitor::visit(ImageProcessingShader &n)
     if (ImGui::IsItemHovered() && io.MouseWheel != 0.f ){
         n.nbColors = CLAMP( n.nbColors + io.MouseWheel, 1.f, 257.f);
         if (n.nbColors == 0) oss << "Full range"; else oss << n.nbColors;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Posterize");
     }
     if (ImGui::IsItemDeactivatedAfterEdit()){
         std::ostringstream oss;
         oss << "Posterize ";
         if (n.nbColors == 0) oss << "Full range"; else oss << n.nbColors;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Posterize");
     }
     ImGui::SameLine(0, IMGUI_SAME_LINE);
     if (ImGuiToolkit::TextButton("Posterize ")) {
         n.nbColors = 0.f;
         oss << "Posterize Full range";
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Posterize");
     }
 
     ///
@@ -403,18 +403,18 @@ void ImGuiVisitor::visit(ImageProcessingShader &n)
     if (ImGui::IsItemHovered() && io.MouseWheel != 0.f ){
         n.threshold = CLAMP(n.threshold + 0.001f * io.MouseWheel, 0.f, 1.f);
         if (n.threshold < 0.001f) oss << "None"; else oss << std::setprecision(3) << n.threshold;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Threshold");
     }
     if (ImGui::IsItemDeactivatedAfterEdit()){
         oss << "Threshold ";
         if (n.threshold < 0.001f) oss << "None"; else oss << std::setprecision(3) << n.threshold;
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Threshold");
     }
     ImGui::SameLine(0, IMGUI_SAME_LINE);
     if (ImGuiToolkit::TextButton("Threshold ")) {
         n.threshold = 0.f;
         oss << "Threshold None";
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Threshold");
     }
 
     ///
@@ -427,7 +427,7 @@ void ImGuiVisitor::visit(ImageProcessingShader &n)
     if (ImGuiToolkit::TextButton("Invert ")) {
         n.invert = 0;
         oss << "Invert None";
-        Action::manager().store(oss.str());
+        Action::manager().store(oss.str(), n.id(), "Invert");
     }
 
     ImGui::PopID();
@@ -823,13 +823,13 @@ void ImGuiVisitor::visit (SessionFileSource& s)
                 s.session()->setFadingTarget( float(100 - f) * 0.01f );
             if (ImGui::IsItemDeactivatedAfterEdit()){
                 oss << s.name() << ": Fading " << f << " %";
-                Action::manager().store(oss.str());
+                Action::manager().store(oss.str(), s.id(), "Fading");
             }
             ImGui::SameLine(0, IMGUI_SAME_LINE);
             if (ImGuiToolkit::TextButton("Fading")) {
                 s.session()->setFadingTarget(0.f);
                 oss << s.name() << ": Fading 0 %";
-                Action::manager().store(oss.str());
+                Action::manager().store(oss.str(), s.id(), "Fading");
             }
 
             // import
@@ -993,10 +993,10 @@ void ImGuiVisitor::visit (DelayFilter& f)
 //    ImGui::SameLine(0, IMGUI_SAME_LINE);
     ImGui::SetNextItemWidth(IMGUI_RIGHT_ALIGN);
     float d = f.delay();
-    if (ImGui::SliderFloat("##Delay", &d, 0.f, 2.f, "%.2f s"))
+    if (ImGui::SliderFloat("##Delay", &d, 0.f, DELAY_FILTER_MAX, "%.2f s", ImGuiSliderFlags_Logarithmic))
         f.setDelay(d);
     if (ImGui::IsItemHovered() && io.MouseWheel != 0.f ){
-        d = CLAMP( d + 0.01f * io.MouseWheel, 0.f, 2.f);
+        d = CLAMP( d + 0.01f * io.MouseWheel, 0.f, DELAY_FILTER_MAX);
         f.setDelay(d);
         oss << "Delay " << std::setprecision(3) << d << " s";
         Action::manager().store(oss.str());
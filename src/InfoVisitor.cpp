@@ -275,7 +275,7 @@ void InfoVisitor::visit (PatternSource& s)
             }
             else {
                 oss << Pattern::get(ptn->type()).label << " pattern" << std::endl;
-                oss << "RGBA" << std::endl;
+                oss << "RGBA" << (ptn->generated() ? ", GPU generated" : "") << std::endl;
                 oss << ptn->width() << " x " << ptn->height();
             }
         }
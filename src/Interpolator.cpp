@@ -27,111 +27,72 @@
 
 #include "Interpolator.h"
 
+static const View::Mode interpolated_views[4] = { View::MIXING, View::GEOMETRY, View::LAYER, View::TEXTURE };
 
-SourceInterpolator::SourceInterpolator(Source *subject, const SourceCore &target) :
-    subject_(subject), from_(static_cast<SourceCore>(*subject)), to_(target), current_cursor_(0.f)
+void Interpolator::pack(const SourceCore &s, float *values)
 {
+    for (int m = 0; m < 4; ++m) {
+        const Group *g = s.group( interpolated_views[m] );
+        float *v = values + m * INTERPOLATOR_GROUP_SIZE;
+        v[0]  = g->translation_.x;
+        v[1]  = g->translation_.y;
+        v[2]  = g->translation_.z;
+        v[3]  = g->scale_.x;
+        v[4]  = g->scale_.y;
+        v[5]  = g->scale_.z;
+        v[6]  = g->rotation_.x;
+        v[7]  = g->rotation_.y;
+        v[8]  = g->rotation_.z;
+        v[9]  = g->crop_.x;
+        v[10] = g->crop_.y;
+        v[11] = g->crop_.z;
+        v[12] = g->crop_.w;
+    }
 
-
-}
-
-
-void SourceInterpolator::interpolateGroup(View::Mode m)
-{
-    current_state_.group(m)->translation_ =
-            (1.f - current_cursor_) * from_.group(m)->translation_
-            + current_cursor_ * to_.group(m)->translation_;
-    current_state_.group(m)->scale_ =
-            (1.f - current_cursor_) * from_.group(m)->scale_
-            + current_cursor_ * to_.group(m)->scale_;
-    current_state_.group(m)->rotation_ =
-            (1.f - current_cursor_) * from_.group(m)->rotation_
-            + current_cursor_ * to_.group(m)->rotation_;
-    current_state_.group(m)->crop_ =
-            (1.f - current_cursor_) * from_.group(m)->crop_
-            + current_cursor_ * to_.group(m)->crop_;
-
-    CopyCallback *anim = new CopyCallback( current_state_.group(m) );
-    subject_->group(m)->update_callbacks_.clear();
-    subject_->group(m)->update_callbacks_.push_back(anim);
+    const ImageProcessingShader *p = s.processingShader();
+    float *v = values + 4 * INTERPOLATOR_GROUP_SIZE;
+    v[0]  = p->brightness;
+    v[1]  = p->contrast;
+    v[2]  = p->saturation;
+    v[3]  = p->hueshift;
+    v[4]  = p->threshold;
+    v[5]  = (float) p->nbColors;
+    v[6]  = p->gamma.x;
+    v[7]  = p->gamma.y;
+    v[8]  = p->gamma.z;
+    v[9]  = p->gamma.w;
+    v[10] = p->levels.x;
+    v[11] = p->levels.y;
+    v[12] = p->levels.z;
+    v[13] = p->levels.w;
 }
 
-void SourceInterpolator::interpolateImageProcessing()
+void Interpolator::unpack(const float *values, SourceCore &s)
 {
-    current_state_.processingShader()->brightness =
-            (1.f - current_cursor_) * from_.processingShader()->brightness
-            + current_cursor_ * to_.processingShader()->brightness;
-
-    current_state_.processingShader()->contrast =
-            (1.f - current_cursor_) * from_.processingShader()->contrast
-            + current_cursor_ * to_.processingShader()->contrast;
-
-    current_state_.processingShader()->saturation =
-            (1.f - current_cursor_) * from_.processingShader()->saturation
-            + current_cursor_ * to_.processingShader()->saturation;
-
-    current_state_.processingShader()->hueshift =
-            (1.f - current_cursor_) * from_.processingShader()->hueshift
-            + current_cursor_ * to_.processingShader()->hueshift;
-
-    current_state_.processingShader()->threshold =
-            (1.f - current_cursor_) * from_.processingShader()->threshold
-            + current_cursor_ * to_.processingShader()->threshold;
-
-    current_state_.processingShader()->nbColors =
-            (1.f - current_cursor_) * from_.processingShader()->nbColors
-            + current_cursor_ * to_.processingShader()->nbColors;
-
-    current_state_.processingShader()->gamma =
-            (1.f - current_cursor_) * from_.processingShader()->gamma
-            + current_cursor_ * to_.processingShader()->gamma;
-
-    current_state_.processingShader()->levels =
-            (1.f - current_cursor_) * from_.processingShader()->levels
-            + current_cursor_ * to_.processingShader()->levels;
+    for (int m = 0; m < 4; ++m) {
+        Group *g = s.group( interpolated_views[m] );
+        const float *v = values + m * INTERPOLATOR_GROUP_SIZE;
+        g->translation_ = glm::vec3(v[0], v[1], v[2]);
+        g->scale_       = glm::vec3(v[3], v[4], v[5]);
+        g->rotation_    = glm::vec3(v[6], v[7], v[8]);
+        g->crop_        = glm::vec4(v[9], v[10], v[11], v[12]);
+    }
 
-    subject_->processingShader()->copy( *current_state_.processingShader() );
+    ImageProcessingShader *p = s.processingShader();
+    const float *v = values + 4 * INTERPOLATOR_GROUP_SIZE;
+    p->brightness = v[0];
+    p->contrast   = v[1];
+    p->saturation = v[2];
+    p->hueshift   = v[3];
+    p->threshold  = v[4];
+    p->nbColors   = (int) v[5];
+    p->gamma      = glm::vec4(v[6], v[7], v[8], v[9]);
+    p->levels     = glm::vec4(v[10], v[11], v[12], v[13]);
 
 // not interpolated : invert , filterid
 }
 
-float SourceInterpolator::current() const
-{
-    return current_cursor_;
-}
-
-void SourceInterpolator::apply(float percent)
-{
-    percent = CLAMP( percent, 0.f, 1.f);
-
-    if ( subject_ && ABS_DIFF(current_cursor_, percent) > EPSILON)
-    {
-        current_cursor_ = percent;
-
-        if (current_cursor_ < EPSILON) {
-            current_cursor_ = 0.f;
-            current_state_ = from_;
-            subject_->copy(current_state_);
-        }
-        else if (current_cursor_ > 1.f - EPSILON) {
-            current_cursor_ = 1.f;
-            current_state_ = to_;
-            subject_->copy(current_state_);
-        }
-        else {
-            interpolateGroup(View::MIXING);
-            interpolateGroup(View::GEOMETRY);
-            interpolateGroup(View::LAYER);
-            interpolateGroup(View::TEXTURE);
-            interpolateImageProcessing();
-//            Log::Info("SourceInterpolator::update %f", cursor);
-        }
-
-        subject_->touch();
-    }
-}
-
-Interpolator::Interpolator()
+Interpolator::Interpolator() : current_cursor_(0.f)
 {
 
 }
@@ -143,34 +104,87 @@ Interpolator::~Interpolator()
 
 void Interpolator::clear()
 {
-    for (auto i = interpolators_.begin(); i != interpolators_.end(); ) {
-        delete *i;
-        i = interpolators_.erase(i);
-    }
+    subjects_.clear();
+    from_.clear();
+    to_.clear();
+    current_state_.clear();
+    start_.clear();
+    delta_.clear();
+    values_.clear();
+    current_cursor_ = 0.f;
 }
 
-
 void Interpolator::add (Source *s, const SourceCore &target)
 {
-    SourceInterpolator *i = new SourceInterpolator(s, target);
-    interpolators_.push_back(i);
+    add(s, static_cast<const SourceCore&>(*s), target);
 }
 
+void Interpolator::add (Source *s, const SourceCore &from, const SourceCore &target)
+{
+    if (s == nullptr)
+        return;
+
+    subjects_.push_back(s);
+    from_.emplace_back(from);
+    to_.emplace_back(target);
+    current_state_.emplace_back(from);
+
+    // append start values and difference to target values
+    size_t offset = start_.size();
+    start_.resize(offset + INTERPOLATOR_STRIDE);
+    delta_.resize(offset + INTERPOLATOR_STRIDE);
+    values_.resize(offset + INTERPOLATOR_STRIDE);
+    pack(from, start_.data() + offset);
+    pack(target, delta_.data() + offset);
+    for (size_t k = offset; k < start_.size(); ++k)
+        delta_[k] -= start_[k];
+}
 
 float Interpolator::current() const
 {
-    float ret = 0.f;
-    if (interpolators_.size() > 0)
-        ret = interpolators_.front()->current();
-
-    return ret;
+    return current_cursor_;
 }
 
 void Interpolator::apply(float percent)
 {
-    for (auto i = interpolators_.begin(); i != interpolators_.end(); ++i)
-        (*i)->apply( percent );
+    percent = CLAMP( percent, 0.f, 1.f);
 
-}
+    if ( subjects_.empty() || ABS_DIFF(current_cursor_, percent) < EPSILON )
+        return;
+
+    current_cursor_ = percent;
 
+    // end points: copy the full state of from or target
+    if (current_cursor_ < EPSILON || current_cursor_ > 1.f - EPSILON) {
+        current_cursor_ = current_cursor_ < EPSILON ? 0.f : 1.f;
+        const std::deque<SourceCore> &state = current_cursor_ > 0.f ? to_ : from_;
+        for (size_t i = 0; i < subjects_.size(); ++i) {
+            current_state_[i] = state[i];
+            subjects_[i]->copy(current_state_[i]);
+            subjects_[i]->touch();
+        }
+        return;
+    }
 
+    // linear interpolation of all values of all sources
+    const size_t n = values_.size();
+    const float *a = start_.data();
+    const float *d = delta_.data();
+    float *v = values_.data();
+    for (size_t k = 0; k < n; ++k)
+        v[k] = a[k] + current_cursor_ * d[k];
+
+    // apply values to sources
+    for (size_t i = 0; i < subjects_.size(); ++i) {
+        unpack(v + i * INTERPOLATOR_STRIDE, current_state_[i]);
+
+        // groups are updated by the source during its update
+        for (int m = 0; m < 4; ++m) {
+            Group *g = subjects_[i]->group( interpolated_views[m] );
+            g->clearCallbacks();
+            g->update_callbacks_.push_back( new CopyCallback( current_state_[i].group( interpolated_views[m] ) ) );
+        }
+        subjects_[i]->processingShader()->copy( *current_state_[i].processingShader() );
+        subjects_[i]->touch();
+    }
+}
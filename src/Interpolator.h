@@ -1,29 +1,34 @@
 #ifndef INTERPOLATOR_H
 #define INTERPOLATOR_H
 
+#include <map>
+#include <deque>
+#include <vector>
+
 #include "Source.h"
 #include "SourceList.h"
 
-class SourceInterpolator
-{
-public:
-    SourceInterpolator(Source *subject, const SourceCore &target);
+// number of values interpolated for each source:
+// translation, scale, rotation and crop of 4 views, 5 image processing
+// parameters, number of colors, gamma and levels
+#define INTERPOLATOR_GROUP_SIZE 13
+#define INTERPOLATOR_STRIDE (4 * INTERPOLATOR_GROUP_SIZE + 14)
 
-    void apply (float percent);
-    float current() const;
-
-protected:
-    Source *subject_;
-
-    SourceCore from_;
-    SourceCore to_;
-    SourceCore current_state_;
-    float current_cursor_;
-
-    void interpolateGroup (View::Mode m);
-    void interpolateImageProcessing ();
+// state of the sources in a snapshot, indexed by source id
+struct SnapshotCore
+{
+    std::map<uint64_t, SourceCore> sources;
 };
 
+/**
+ * @brief The Interpolator interpolates the state of sources between
+ * two SourceCore.
+ *
+ * The start and target values of all sources are packed once in flat
+ * arrays of INTERPOLATOR_STRIDE floats per source, so that applying an
+ * interpolation is a single linear pass on these arrays, followed by the
+ * update of the sources.
+ */
 class Interpolator
 {
 public:
@@ -31,14 +36,29 @@ public:
     ~Interpolator();
 
     void clear ();
+    // interpolate source s from its current state to target
     void add (Source *s, const SourceCore &target );
+    // interpolate source s from state 'from' to state 'target'
+    void add (Source *s, const SourceCore &from, const SourceCore &target );
 
     void apply (float percent);
     float current() const;
+    inline size_t size() const { return subjects_.size(); }
+
+    // read and write the values interpolated for a source
+    static void pack (const SourceCore &s, float *values);
+    static void unpack (const float *values, SourceCore &s);
 
 protected:
-    std::list<SourceInterpolator *> interpolators_;
+    std::vector<Source *> subjects_;
+    std::deque<SourceCore> from_;
+    std::deque<SourceCore> to_;
+    std::deque<SourceCore> current_state_;
 
+    std::vector<float> start_;
+    std::vector<float> delta_;
+    std::vector<float> values_;
+    float current_cursor_;
 };
 
 #endif // INTERPOLATOR_H
@@ -19,7 +19,13 @@
 
 #include <string>
 #include <list>
+#include <array>
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 using namespace std;
 
 #include "defines.h"
@@ -27,43 +33,240 @@ using namespace std;
 #include "DialogToolkit.h"
 #include "Log.h"
 
+// number of records kept (power of 2)
+#define LOG_CAPACITY 4096
+// long enough for shader compilation logs (1024 characters) and their header
+#define LOG_MESSAGE_SIZE 1280
+#define LOG_NAME_SIZE 16
+// period of writing records to file, in ms
+#define LOG_FILE_PERIOD 200
+
+typedef enum {
+    LOG_INFO = 0,
+    LOG_NOTIFY,
+    LOG_WARNING,
+    LOG_ERROR
+} LogLevel;
+
+// a copy of a log record
+struct LogEntry
+{
+    uint64_t index;
+    uint64_t time;
+    int      level;
+    uint32_t thread;
+    char     name[LOG_NAME_SIZE];
+    char     text[LOG_MESSAGE_SIZE];
+
+    // line of text with index, time and thread
+    int format(char *line, size_t size, bool numbering) const
+    {
+        if (!numbering)
+            return snprintf(line, size, "%s", text);
+
+        unsigned long ms = (unsigned long) time;
+        char thread_name[LOG_NAME_SIZE + 8];
+        if (name[0] != '\0')
+            snprintf(thread_name, sizeof(thread_name), "%s", name);
+        else
+            snprintf(thread_name, sizeof(thread_name), "#%u", thread);
+
+        return snprintf(line, size, "%04lu  %02lu:%02lu:%02lu.%03lu  %-10s %s",
+                        (unsigned long) index, ms / 3600000, (ms / 60000) % 60,
+                        (ms / 1000) % 60, ms % 1000, thread_name, text);
+    }
+};
+
+// thread information given to records
+static std::atomic<uint32_t> thread_count(0);
+static thread_local uint32_t thread_id = thread_count++;
+static thread_local char thread_name[LOG_NAME_SIZE] = {0};
+
+// Fixed capacity ring of log records, written without lock by any thread
+// (each writer claims the next index) and read by the user interface and
+// the file writer. Once the ring is full, oldest records are overwritten.
+// The sequence number of a record tells if it is being written (odd) or
+// if it is ready (even) and for which index.
+class LogRing
+{
+    struct Record
+    {
+        std::atomic<uint64_t> sequence;
+        LogEntry entry;
+    };
+
+public:
+    LogRing() : head_(0), first_(0)
+    {
+        for (auto r = records_.begin(); r != records_.end(); ++r)
+            r->sequence = 0;
+        start_ = std::chrono::steady_clock::now();
+    }
+
+    void push(LogLevel level, const char *fmt, va_list args)
+    {
+        uint64_t i = head_.fetch_add(1);
+        Record &r = records_[i & (LOG_CAPACITY - 1)];
+
+        // wait for previous writer of this record to finish
+        uint64_t s = r.sequence.load(std::memory_order_acquire);
+        for (;;) {
+            if ( s & 1 ) {
+                std::this_thread::yield();
+                s = r.sequence.load(std::memory_order_acquire);
+            }
+            // record already overwritten by a more recent one
+            else if ( s > 2 * i )
+                return;
+            else if ( r.sequence.compare_exchange_weak(s, 2 * i + 1, std::memory_order_acquire) )
+                break;
+        }
+
+        r.entry.index = i;
+        r.entry.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_).count();
+        r.entry.level = level;
+        r.entry.thread = thread_id;
+        memcpy(r.entry.name, thread_name, LOG_NAME_SIZE);
+        vsnprintf(r.entry.text, LOG_MESSAGE_SIZE, fmt, args);
+
+        r.sequence.store(2 * i + 2, std::memory_order_release);
+    }
+
+    // copy the record i, false if not ready or overwritten
+    bool read(uint64_t i, LogEntry &e) const
+    {
+        const Record &r = records_[i & (LOG_CAPACITY - 1)];
+        uint64_t s = r.sequence.load(std::memory_order_acquire);
+        if ( s != 2 * i + 2 )
+            return false;
+        memcpy(&e, &r.entry, sizeof(LogEntry));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return r.sequence.load(std::memory_order_relaxed) == s;
+    }
+
+    // index of the next record
+    inline uint64_t head() const { return head_.load(std::memory_order_acquire); }
 
-static std::mutex mtx;
+    // index of the oldest record available
+    uint64_t first() const
+    {
+        uint64_t h = head();
+        uint64_t f = h > LOG_CAPACITY ? h - LOG_CAPACITY : 0;
+        return MAX(f, first_.load());
+    }
+
+    // ignore all records until now
+    inline void clear() { first_ = head(); }
+
+private:
+    std::array<Record, LOG_CAPACITY> records_;
+    std::atomic<uint64_t> head_;
+    std::atomic<uint64_t> first_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+static LogRing ring;
+
+// Writes records of the ring to a file, in a thread
+struct LogFile
+{
+    std::mutex access;
+    std::thread writer;
+    std::atomic<bool> running;
+    FILE *file;
+
+    LogFile() : running(false), file(nullptr) {}
+    ~LogFile() { close(); }
+
+    static void write(LogFile *f)
+    {
+        uint64_t cursor = ring.first();
+        char line[LOG_MESSAGE_SIZE + 64];
+        LogEntry e;
+        bool stop = false;
+
+        while (!stop) {
+            stop = !f->running;
+            uint64_t head = ring.head();
+            uint64_t first = ring.first();
+            if (cursor < first) {
+                fprintf(f->file, "... %lu records lost\n", (unsigned long) (first - cursor));
+                cursor = first;
+            }
+            // write all records ready (stop at a record being written)
+            for (; cursor < head && ring.read(cursor, e); ++cursor) {
+                e.format(line, sizeof(line), true);
+                fprintf(f->file, "%s\n", line);
+            }
+            fflush(f->file);
+
+            if (!stop)
+                std::this_thread::sleep_for(std::chrono::milliseconds(LOG_FILE_PERIOD));
+        }
+    }
+
+    bool open(const std::string &filename)
+    {
+        close();
+
+        std::lock_guard<std::mutex> lock(access);
+        file = fopen(filename.c_str(), "a");
+        if (file) {
+            running = true;
+            writer = std::thread(LogFile::write, this);
+        }
+        return file != nullptr;
+    }
+
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(access);
+        if (running) {
+            running = false;
+            writer.join();
+        }
+        if (file) {
+            fclose(file);
+            file = nullptr;
+        }
+    }
+};
+
+static LogFile logfile;
 
 struct AppLog
 {
-    ImGuiTextBuffer     Buf;
     ImGuiTextFilter     Filter;
-    ImVector<int>       LineOffsets; 
     bool                LogInTitle;
 
     AppLog()
     {
-        Clear();
+        LogInTitle = false;
     }
 
     void Clear()
     {
-        mtx.lock();
-        Buf.clear();
-        LineOffsets.clear();
-        LineOffsets.push_back(0);
+        ring.clear();
         LogInTitle = false;
-        mtx.unlock();
     }
 
-    void AddLog(const char* fmt, va_list args)
+    void AddLog(LogLevel level, const char* fmt, va_list args)
     {
-        mtx.lock();
-        int old_size = Buf.size();
-        Buf.appendf("%04d  ", LineOffsets.size()); // this adds 6 characters to show line number
-        Buf.appendfv(fmt, args);
-        Buf.append("\n");
-
-        for (int new_size = Buf.size(); old_size < new_size; old_size++)
-            if (Buf[old_size] == '\n')
-                LineOffsets.push_back(old_size + 1);
-        mtx.unlock();
+        ring.push(level, fmt, args);
+    }
+
+    void Line(const LogEntry &e, bool numbering)
+    {
+        char line[LOG_MESSAGE_SIZE + 64];
+        int len = e.format(line, sizeof(line), numbering);
+        const char *line_end = line + MIN( (size_t) MAX(len, 0), sizeof(line) - 1);
+        if (e.level > LOG_NOTIFY) {
+            ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f,0.6f,0.0f,1.0f));
+            ImGui::TextUnformatted(line, line_end);
+            ImGui::PopStyleColor(1);
+        }
+        else
+            ImGui::TextUnformatted(line, line_end);
     }
 
     void Draw(const char* title, bool* p_open = NULL)
@@ -79,11 +282,11 @@ struct AppLog
 
         if (*p_open) {
             // if open but Collapsed, create title of window with last line of logs
-            if (LogInTitle) {
+            LogEntry e;
+            uint64_t head = ring.head();
+            if (LogInTitle && head > ring.first() && ring.read(head - 1, e)) {
                 char lastlogline[128];
-                size_t lenght =  LineOffsets[LineOffsets.Size-1] - LineOffsets[LineOffsets.Size-2] - 1;
-                memset(lastlogline, '\0', 128);
-                memcpy(lastlogline, Buf.begin() + LineOffsets[LineOffsets.Size-2], MIN(127, lenght));
+                snprintf(lastlogline, 128, "%s", e.text);
                 snprintf(window_title, 1024, "%s - %s ###LOGVIMIX", title, lastlogline);
             }
         }
@@ -124,51 +327,42 @@ struct AppLog
         ImGuiToolkit::PushFont(ImGuiToolkit::FONT_MONO);
         ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0, 0));
 
-        mtx.lock();
+        // records available (those overwritten or being written are skipped)
+        const uint64_t first = ring.first();
+        const uint64_t head = ring.head();
+        LogEntry e;
 
-        const char* buf = Buf.begin();
-        const char* buf_end = Buf.end();
         if (Filter.IsActive())
         {
-            // In this example we don't use the clipper when Filter is enabled.
-            // This is because we don't have a random access on the result on our filter.
-            // A real application processing logs with ten of thousands of entries may want to store the result of search/filter.
-            // especially if the filtering function is not trivial (e.g. reg-exp).
-            for (int line_no = 0; line_no < LineOffsets.Size; line_no++)
+            // no clipper when Filter is enabled (no random access on the result)
+            char line[LOG_MESSAGE_SIZE + 64];
+            for (uint64_t i = first; i < head; ++i)
             {
-                const char* line_start = buf + LineOffsets[line_no];
-                const char* line_end = (line_no + 1 < LineOffsets.Size) ? (buf + LineOffsets[line_no + 1] - 1) : buf_end;
-                if (Filter.PassFilter(line_start, line_end))
-                    ImGui::TextUnformatted(line_start, line_end);
+                if ( ring.read(i, e) ) {
+                    e.format(line, sizeof(line), numbering);
+                    if (Filter.PassFilter(line))
+                        Line(e, numbering);
+                }
             }
         }
         else
         {
-            // The simplest and easy way to display the entire buffer:
-            //   ImGui::TextUnformatted(buf_begin, buf_end);
-            // And it'll just work. TextUnformatted() has specialization for large blob of text and will fast-forward to skip non-visible lines.
-            // Here we instead demonstrate using the clipper to only process lines that are within the visible area.
-            // If you have tens of thousands of items and their processing cost is non-negligible, coarse clipping them on your side is recommended.
-            // Using ImGuiListClipper requires A) random access into your data, and B) items all being the  same height,
-            // both of which we can handle since we an array pointing to the beginning of each line of text.
-            // When using the filter (in the block of code above) we don't have random access into the data to display anymore, which is why we don't use the clipper.
-            // Storing or skimming through the search result would make it possible (and would be recommended if you want to search through tens of thousands of entries)
+            // Using the clipper to only read records that are within the visible area.
             ImGuiListClipper clipper;
-            clipper.Begin(LineOffsets.Size);
+            clipper.Begin( (int) (head - first) );
             while (clipper.Step())
             {
                 for (int line_no = clipper.DisplayStart; line_no < clipper.DisplayEnd; line_no++)
                 {
-                    const char* line_start = buf + LineOffsets[line_no] + (numbering?0:6);
-                    const char* line_end = (line_no + 1 < LineOffsets.Size) ? (buf + LineOffsets[line_no + 1] - 1) : buf_end;
-                    ImGui::TextUnformatted(line_start, line_end);
+                    if ( ring.read(first + line_no, e) )
+                        Line(e, numbering);
+                    else
+                        ImGui::NewLine();
                 }
             }
             clipper.End();
         }
 
-        mtx.unlock();
-
         ImGui::PopStyleVar();
         ImGui::PopFont();
 
@@ -190,10 +384,33 @@ void Log::Info(const char* fmt, ...)
 {
     va_list args;
     va_start(args, fmt);
-    logs.AddLog(fmt, args);
+    logs.AddLog(LOG_INFO, fmt, args);
+    va_end(args);
+}
+
+static void AddLog(LogLevel level, const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    logs.AddLog(level, fmt, args);
     va_end(args);
 }
 
+void Log::SetThreadName(const char *name)
+{
+    snprintf(thread_name, LOG_NAME_SIZE, "%s", name ? name : "");
+}
+
+bool Log::SetFile(const std::string &filename)
+{
+    if (filename.empty()) {
+        logfile.close();
+        return true;
+    }
+
+    return logfile.open(filename);
+}
+
 void Log::ShowLogWindow(bool* p_open)
 {
     logs.Draw( IMGUI_TITLE_LOGS, p_open);
@@ -213,7 +430,7 @@ void Log::Notify(const char* fmt, ...)
     notifications_timeout = 0.f;
 
     // always log
-    Log::Info(ICON_FA_INFO_CIRCLE " %s", buf.c_str());
+    AddLog(LOG_NOTIFY, ICON_FA_INFO_CIRCLE " %s", buf.c_str());
 }
 
 void Log::Warning(const char* fmt, ...)
@@ -229,7 +446,7 @@ void Log::Warning(const char* fmt, ...)
     warnings.push_back(buf.c_str());
 
     // always log
-    Log::Info(ICON_FA_EXCLAMATION_TRIANGLE " Warning - %s", buf.c_str());
+    AddLog(LOG_WARNING, ICON_FA_EXCLAMATION_TRIANGLE " Warning - %s", buf.c_str());
 }
 
 void Log::Render(bool *showWarnings)
@@ -336,6 +553,6 @@ void Log::Error(const char* fmt, ...)
 
     DialogToolkit::ErrorDialog(buf.c_str());
 
-    Log::Info("Error - %s\n", buf.c_str());
+    AddLog(LOG_ERROR, "Error - %s", buf.c_str());
 }
 
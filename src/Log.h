@@ -1,6 +1,8 @@
 #ifndef __LOG_H_
 #define __LOG_H_
 
+#include <string>
+
 namespace Log
 {
     // log
@@ -9,6 +11,12 @@ namespace Log
     void Warning(const char* fmt, ...);
     void Error(const char* fmt, ...);
 
+    // name of the calling thread in log records
+    void SetThreadName(const char *name);
+
+    // write log records to file (stop if filename is empty)
+    bool SetFile(const std::string &filename);
+
     // Draw logs
     void ShowLogWindow(bool* p_open = nullptr);
 
@@ -84,7 +84,14 @@ std::string Loopback::init(GstCaps *caps)
         return std::string("Loopback : Invalid caps");
 
     // create a gstreamer pipeline
-    std::string description = "appsrc name=src ! videoconvert ! queue ! ";
+    std::string description = "appsrc name=src ! videoconvert ! ";
+
+    // loopback clients expect RGB frames: convert frames grabbed in YUV
+    const gchar *format = gst_structure_get_string(gst_caps_get_structure(caps, 0), "format");
+    if (format && g_strcmp0(format, "I420") == 0)
+        description += "video/x-raw, format=RGB ! ";
+
+    description += "queue ! ";
 
     // complement pipeline with sink
     description += Loopback::loopback_sink_ + " name=sink";
@@ -0,0 +1,282 @@
+/*
+ * This file is part of vimix - video live mixer
+ *
+ * **Copyright** (C) 2019-2023 Bruno Herbelin <bruno.herbelin@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include <fstream>
+#include <sys/stat.h>
+
+#include "Log.h"
+#include "Settings.h"
+#include "SystemToolkit.h"
+#include "GstToolkit.h"
+#include "SessionParser.h"
+#include "Playlist.h"
+
+#include "MediaInfoCache.h"
+
+#define MEDIAINFO_CACHE_FILE "mediainfo.cache"
+#define MEDIAINFO_CACHE_MAGIC 0x564D4943 // 'VMIC'
+#define MEDIAINFO_CACHE_VERSION 1
+#define MEDIAINFO_CACHE_MAX_ENTRIES 4096
+
+// read / write of binary values in cache file
+template <typename T>
+static void write_value(std::ofstream &out, T v)
+{
+    out.write( reinterpret_cast<const char *>(&v), sizeof(T) );
+}
+
+template <typename T>
+static T read_value(std::ifstream &in)
+{
+    T v = T();
+    in.read( reinterpret_cast<char *>(&v), sizeof(T) );
+    return v;
+}
+
+static void write_string(std::ofstream &out, const std::string &s)
+{
+    write_value<uint32_t>(out, (uint32_t) s.size());
+    out.write( s.data(), s.size() );
+}
+
+static std::string read_string(std::ifstream &in)
+{
+    uint32_t len = read_value<uint32_t>(in);
+    std::string s;
+    if (in.good() && len < 65536) {
+        s.resize(len);
+        in.read( &s[0], len );
+    }
+    else
+        in.setstate(std::ios::failbit);
+    return s;
+}
+
+// get size and modification time of a file
+static bool file_stat(const std::string &path, uint64_t &size, uint64_t &mtime)
+{
+    struct stat statsfile;
+    if ( stat( path.c_str(), &statsfile) < 0 || !S_ISREG(statsfile.st_mode) )
+        return false;
+    size  = (uint64_t) statsfile.st_size;
+    mtime = (uint64_t) statsfile.st_mtime;
+    return true;
+}
+
+MediaInfoCache::MediaInfoCache() : changed_(false), prefetch_stop_(false)
+{
+
+}
+
+void MediaInfoCache::init()
+{
+    filename_ = SystemToolkit::full_filename(SystemToolkit::settings_path(), MEDIAINFO_CACHE_FILE);
+    if ( load() )
+        Log::Info("Media information of %d files loaded from cache.", (int) entries_.size());
+
+    // list all session files used recently (directly or in playlists)
+    std::list<std::string> sessions = Settings::application.recentSessions.filenames;
+    for (auto it = Settings::application.recentPlaylists.filenames.begin();
+         it != Settings::application.recentPlaylists.filenames.end(); ++it) {
+        Playlist p;
+        p.load(*it);
+        for (size_t i = 0; i < p.size(); ++i)
+            sessions.push_back( p.at(i) );
+    }
+    sessions.sort();
+    sessions.unique();
+
+    // warm the cache in background
+    prefetch_stop_ = false;
+    prefetch_ = std::thread(MediaInfoCache::prefetch, this, sessions);
+}
+
+void MediaInfoCache::terminate()
+{
+    prefetch_stop_ = true;
+    if (prefetch_.joinable())
+        prefetch_.join();
+
+    std::lock_guard<std::mutex> lock(access_);
+    if (changed_)
+        save();
+}
+
+void MediaInfoCache::prefetch(MediaInfoCache *cache, std::list<std::string> sessions)
+{
+    int count = 0;
+    for (auto sit = sessions.begin(); sit != sessions.end() && !cache->prefetch_stop_; ++sit) {
+
+        SessionParser parser;
+        if ( !parser.open(*sit) )
+            continue;
+
+        std::map< uint64_t, std::pair<std::string, bool> > paths = parser.pathList();
+        for (auto pit = paths.begin(); pit != paths.end() && !cache->prefetch_stop_; ++pit) {
+
+            // ignore missing files and session files
+            const std::string &path = pit->second.first;
+            if ( !pit->second.second || SystemToolkit::has_extension(path, VIMIX_FILE_EXT) )
+                continue;
+
+            // discover only files not already in cache
+            MediaInfo info;
+            if ( !cache->find(path, info) ) {
+                // MediaPlayer::UriDiscoverer inserts valid info in cache
+                info = MediaPlayer::UriDiscoverer( GstToolkit::filename_to_uri(path) );
+                if (info.valid)
+                    ++count;
+            }
+        }
+    }
+
+    if (count > 0) {
+        cache->access_.lock();
+        cache->save();
+        cache->access_.unlock();
+#ifndef NDEBUG
+        Log::Info("Media information of %d files prefetched.", count);
+#endif
+    }
+}
+
+bool MediaInfoCache::find(const std::string &path, MediaInfo &info)
+{
+    uint64_t size = 0, mtime = 0;
+    if ( !file_stat(path, size, mtime) )
+        return false;
+
+    std::lock_guard<std::mutex> lock(access_);
+
+    auto e = entries_.find(path);
+    if ( e == entries_.end() )
+        return false;
+
+    // file was modified since discovery
+    if ( e->second.size != size || e->second.mtime != mtime ) {
+        entries_.erase(e);
+        changed_ = true;
+        return false;
+    }
+
+    info = e->second.info;
+    return true;
+}
+
+void MediaInfoCache::insert(const std::string &path, const MediaInfo &info)
+{
+    Entry e;
+    if ( !info.valid || !file_stat(path, e.size, e.mtime) )
+        return;
+    e.info = info;
+
+    std::lock_guard<std::mutex> lock(access_);
+
+    // limit the size of cache
+    if (entries_.size() >= MEDIAINFO_CACHE_MAX_ENTRIES && entries_.count(path) < 1)
+        entries_.erase(entries_.begin());
+
+    entries_[path] = e;
+    changed_ = true;
+}
+
+void MediaInfoCache::clear()
+{
+    std::lock_guard<std::mutex> lock(access_);
+    entries_.clear();
+    changed_ = true;
+}
+
+bool MediaInfoCache::load()
+{
+    std::ifstream in(filename_, std::ios::binary);
+    if ( !in.is_open() )
+        return false;
+
+    if ( read_value<uint32_t>(in) != MEDIAINFO_CACHE_MAGIC ||
+         read_value<uint32_t>(in) != MEDIAINFO_CACHE_VERSION )
+        return false;
+
+    uint32_t count = read_value<uint32_t>(in);
+    std::lock_guard<std::mutex> lock(access_);
+    for (uint32_t i = 0; i < count && in.good(); ++i) {
+        std::string path = read_string(in);
+        Entry e;
+        e.size  = read_value<uint64_t>(in);
+        e.mtime = read_value<uint64_t>(in);
+        e.info.width       = read_value<uint32_t>(in);
+        e.info.par_width   = read_value<uint32_t>(in);
+        e.info.height      = read_value<uint32_t>(in);
+        e.info.bitrate     = read_value<uint32_t>(in);
+        e.info.framerate_n = read_value<uint32_t>(in);
+        e.info.framerate_d = read_value<uint32_t>(in);
+        e.info.dt          = read_value<uint64_t>(in);
+        e.info.end         = read_value<uint64_t>(in);
+        uint8_t flags      = read_value<uint8_t>(in);
+        e.info.isimage     = flags & 1;
+        e.info.interlaced  = flags & 2;
+        e.info.seekable    = flags & 4;
+        e.info.hasaudio    = flags & 8;
+        e.info.valid       = true;
+        e.info.codec_name  = read_string(in);
+        e.info.log         = read_string(in);
+        if (in.good())
+            entries_[path] = e;
+    }
+    changed_ = false;
+
+    return !entries_.empty();
+}
+
+bool MediaInfoCache::save()
+{
+    if (filename_.empty())
+        return false;
+
+    std::ofstream out(filename_, std::ios::binary | std::ios::trunc);
+    if ( !out.is_open() ) {
+        Log::Warning("Could not write media information cache %s", filename_.c_str());
+        return false;
+    }
+
+    write_value<uint32_t>(out, MEDIAINFO_CACHE_MAGIC);
+    write_value<uint32_t>(out, MEDIAINFO_CACHE_VERSION);
+    write_value<uint32_t>(out, (uint32_t) entries_.size());
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        const MediaInfo &info = it->second.info;
+        write_string(out, it->first);
+        write_value<uint64_t>(out, it->second.size);
+        write_value<uint64_t>(out, it->second.mtime);
+        write_value<uint32_t>(out, info.width);
+        write_value<uint32_t>(out, info.par_width);
+        write_value<uint32_t>(out, info.height);
+        write_value<uint32_t>(out, info.bitrate);
+        write_value<uint32_t>(out, info.framerate_n);
+        write_value<uint32_t>(out, info.framerate_d);
+        write_value<uint64_t>(out, info.dt);
+        write_value<uint64_t>(out, info.end);
+        write_value<uint8_t>(out, (info.isimage ? 1 : 0) | (info.interlaced ? 2 : 0)
+                                  | (info.seekable ? 4 : 0) | (info.hasaudio ? 8 : 0) );
+        write_string(out, info.codec_name);
+        write_string(out, info.log);
+    }
+    changed_ = !out.good();
+
+    return out.good();
+}
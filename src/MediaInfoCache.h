@@ -0,0 +1,70 @@
+#ifndef MEDIAINFOCACHE_H
+#define MEDIAINFOCACHE_H
+
+#include <string>
+#include <map>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+#include "MediaPlayer.h"
+
+/**
+ * @brief The MediaInfoCache keeps the MediaInfo found by the discoverer
+ * for media files, and stores them in a binary file in the settings folder.
+ *
+ * An entry is valid as long as the size and the modification time of
+ * the file did not change. A background thread warms the cache with the
+ * media files used in recent sessions and playlists.
+ */
+class MediaInfoCache
+{
+    // Private Constructor
+    MediaInfoCache();
+    MediaInfoCache(MediaInfoCache const& copy) = delete;
+    MediaInfoCache& operator=(MediaInfoCache const& copy) = delete;
+
+public:
+
+    static MediaInfoCache& manager ()
+    {
+        // The only instance
+        static MediaInfoCache _instance;
+        return _instance;
+    }
+
+    // load cache file and start prefetching
+    void init ();
+    // stop prefetching and save cache file
+    void terminate ();
+
+    // get the media info of the file at given path, if known and unchanged
+    bool find (const std::string &path, MediaInfo &info);
+    // remember the media info of the file at given path
+    void insert (const std::string &path, const MediaInfo &info);
+
+    inline size_t size () const { return entries_.size(); }
+    void clear ();
+
+private:
+
+    struct Entry {
+        uint64_t size;
+        uint64_t mtime;
+        MediaInfo info;
+    };
+    std::map<std::string, Entry> entries_;
+    std::mutex access_;
+    bool changed_;
+
+    std::string filename_;
+    bool load ();
+    bool save ();
+
+    std::thread prefetch_;
+    std::atomic<bool> prefetch_stop_;
+    static void prefetch (MediaInfoCache *cache, std::list<std::string> sessions);
+};
+
+#endif // MEDIAINFOCACHE_H
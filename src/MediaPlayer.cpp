@@ -33,6 +33,9 @@
 #include "Settings.h"
 
 #include "MediaPlayer.h"
+#include "MediaInfoCache.h"
+#include "YuvConverter.h"
+#include "TextureUploader.h"
 
 #ifndef NDEBUG
 #define MEDIA_PLAYER_DEBUG
@@ -49,8 +52,10 @@
 #endif
 
 std::list<GstElement*> MediaPlayer::registered_;
+std::list<MediaPlayer*> MediaPlayer::players_;
+std::recursive_mutex MediaPlayer::players_access_;
 
-MediaPlayer::MediaPlayer()
+MediaPlayer::MediaPlayer() : frames_(N_VFRAME, false)
 {
     // create unique id
     id_ = BaseToolkit::uniqueId();
@@ -64,6 +69,7 @@ MediaPlayer::MediaPlayer()
 
     failed_ = false;
     pending_ = false;
+    pending_action_ = 0;
     metro_sync_ = Metronome::SYNC_NONE;
     force_update_ = false;
     seeking_ = false;
@@ -78,24 +84,31 @@ MediaPlayer::MediaPlayer()
     loop_ = LoopMode::LOOP_REWIND;
     fading_mode_ = FadingMode::FADING_COLOR;
 
-    // start index in frame_ stack
-    write_index_ = 0;
-    last_index_ = 0;
-
     // no PBO by default
-    pbo_[0] = pbo_[1] = 0;
-    pbo_size_ = 0;
-    pbo_index_ = 0;
-    pbo_next_index_ = 0;
+    uploader_ = nullptr;
 
     // OpenGL texture
     textureindex_ = 0;
+    yuv_ = nullptr;
+    v_frame_caps_ = nullptr;
+
+    // not sharing decoder
+    leader_ = nullptr;
+    resume_ = GST_CLOCK_TIME_NONE;
+    updating_ = false;
+    players_access_.lock();
+    MediaPlayer::players_.push_back(this);
+    players_access_.unlock();
 }
 
 MediaPlayer::~MediaPlayer()
 {
     close();
 
+    players_access_.lock();
+    MediaPlayer::players_.remove(this);
+    players_access_.unlock();
+
 #ifdef MEDIA_PLAYER_DEBUG
     g_printerr("MediaPlayer %s deleted\n", std::to_string(id_).c_str());
 #endif
@@ -105,8 +118,25 @@ void MediaPlayer::accept(Visitor& v) {
     v.visit(*this);
 }
 
+std::list<GstElement*> MediaPlayer::registered()
+{
+    std::lock_guard<std::recursive_mutex> lock(players_access_);
+    return registered_;
+}
+
+bool MediaPlayer::sharedDecoding() const
+{
+    std::lock_guard<std::recursive_mutex> lock(players_access_);
+    return leader_ != nullptr || !followers_.empty();
+}
+
 guint MediaPlayer::texture() const
 {
+    // texture of the shared decoder
+    std::lock_guard<std::recursive_mutex> lock(players_access_);
+    if (leader_ != nullptr)
+        return leader_->texture();
+
     if (textureindex_ == 0)
         return Resource::getTextureBlack();
 
@@ -121,6 +151,23 @@ MediaInfo MediaPlayer::UriDiscoverer(const std::string &uri)
     Log::Info("Checking uri '%s'", uri.c_str());
 #endif
 
+    // returned value
+    MediaInfo video_stream_info;
+
+    // get file path from uri
+    std::string path;
+    gchar *location = gst_uri_get_location(uri.c_str());
+    if (location) {
+        path = std::string(location);
+        g_free(location);
+    }
+
+    // no need to discover a file which is known and unchanged
+    if ( MediaInfoCache::manager().find(path, video_stream_info) ) {
+        video_stream_info.hasaudio &= Settings::application.accept_audio;
+        return video_stream_info;
+    }
+
 #ifdef LIMIT_DISCOVERER
     // Limiting the number of discoverer thread to TWO in parallel
     // Otherwise, a large number of discoverers are executed (when loading a file)
@@ -135,11 +182,8 @@ MediaInfo MediaPlayer::UriDiscoverer(const std::string &uri)
     }
 #endif
 
-    // returned value
-    MediaInfo video_stream_info;
-
     // if uri is valid
-    if ( SystemToolkit::file_exists( gst_uri_get_location(uri.c_str()) ) ) {
+    if ( SystemToolkit::file_exists( path ) ) {
 
         GError *err = NULL;
         GstDiscoverer *discoverer = gst_discoverer_new (DISCOVER_TIMOUT * GST_SECOND, &err);
@@ -246,7 +290,7 @@ MediaInfo MediaPlayer::UriDiscoverer(const std::string &uri)
 
                 // test audio
                 GList *audios = gst_discoverer_info_get_audio_streams(info);
-                video_stream_info.hasaudio = g_list_length(audios) > 0 && Settings::application.accept_audio;
+                video_stream_info.hasaudio = g_list_length(audios) > 0;
                 gst_discoverer_stream_info_list_free(audios);
             }
 
@@ -258,11 +302,15 @@ MediaInfo MediaPlayer::UriDiscoverer(const std::string &uri)
 
         g_clear_error (&err);
 
+        // remember for next time
+        MediaInfoCache::manager().insert(path, video_stream_info);
     }
     else {
         video_stream_info.log = "No such file";
     }
 
+    video_stream_info.hasaudio &= Settings::application.accept_audio;
+
 #ifdef LIMIT_DISCOVERER
     if (use_primary)
         mtx_primary.unlock();
@@ -433,15 +481,21 @@ void MediaPlayer::execute_open()
     gst_base_sink_set_sync (GST_BASE_SINK(sink), true);
 
     // instruct sink to use the required caps
-    std::string capstring = "video/x-raw,format=RGBA,width="+ std::to_string(media_.width) +
-            ",height=" + std::to_string(media_.height);
+    // (planar YUV for videos if converted on GPU)
+    bool yuv = Settings::application.render.yuv_texturing && !media_.isimage;
+    std::string capstring = std::string("video/x-raw,format=") + (yuv ? YuvConverter::format() : "RGBA") +
+            ",width=" + std::to_string(media_.width) + ",height=" + std::to_string(media_.height);
     GstCaps *caps = gst_caps_from_string(capstring.c_str());
     if (!gst_video_info_from_caps (&v_frame_video_info_, caps)) {
         Log::Warning("MediaPlayer %s Could not configure video frame info", std::to_string(id_).c_str());
         failed_ = true;
         return;
     }
+    // (actual video info read from the caps of the first frame)
+    gst_caps_replace(&v_frame_caps_, NULL);
     gst_app_sink_set_caps (GST_APP_SINK(sink), caps);
+    if (yuv && yuv_ == nullptr)
+        yuv_ = new YuvConverter;
 
     // Instruct appsink to drop old buffers when the maximum amount of queued buffers is reached.
     gst_app_sink_set_max_buffers( GST_APP_SINK(sink), 5);
@@ -519,7 +573,9 @@ void MediaPlayer::execute_open()
     gst_element_set_name(pipeline_, std::to_string(id_).c_str());
 
     // register media player
+    players_access_.lock();
     MediaPlayer::registered_.push_back(pipeline_);
+    players_access_.unlock();
 }
 
 #else
@@ -622,15 +678,21 @@ void MediaPlayer::execute_open()
     gst_base_sink_set_sync (GST_BASE_SINK(sink), true);
 
     // instruct sink to use the required caps
-    std::string capstring = "video/x-raw,format=RGBA,width="+ std::to_string(media_.width) +
-            ",height=" + std::to_string(media_.height);
+    // (planar YUV for videos if converted on GPU)
+    bool yuv = Settings::application.render.yuv_texturing && !media_.isimage;
+    std::string capstring = std::string("video/x-raw,format=") + (yuv ? YuvConverter::format() : "RGBA") +
+            ",width=" + std::to_string(media_.width) + ",height=" + std::to_string(media_.height);
     GstCaps *caps = gst_caps_from_string(capstring.c_str());
     if (!gst_video_info_from_caps (&v_frame_video_info_, caps)) {
         Log::Warning("MediaPlayer %s Could not configure video frame info", std::to_string(id_).c_str());
         failed_ = true;
         return;
     }
+    // (actual video info read from the caps of the first frame)
+    gst_caps_replace(&v_frame_caps_, NULL);
     gst_app_sink_set_caps (GST_APP_SINK(sink), caps);
+    if (yuv && yuv_ == nullptr)
+        yuv_ = new YuvConverter;
 
     // Instruct appsink to drop old buffers when the maximum amount of queued buffers is reached.
     gst_app_sink_set_max_buffers( GST_APP_SINK(sink), 5);
@@ -703,7 +765,9 @@ void MediaPlayer::execute_open()
     gst_element_set_name(pipeline_, std::to_string(id_).c_str());
 
     // register media player
+    players_access_.lock();
     MediaPlayer::registered_.push_back(pipeline_);
+    players_access_.unlock();
 }
 
 #endif
@@ -774,7 +838,9 @@ void MediaPlayer::pipeline_terminate( GstElement *p, GstBus *b )
     g_free(name);
 
     // unregister
+    players_access_.lock();
     MediaPlayer::registered_.remove(p);
+    players_access_.unlock();
 }
 
 void MediaPlayer::close()
@@ -789,6 +855,21 @@ void MediaPlayer::close()
         return;
     }
 
+    // cancel action delayed by metronome
+    if (pending_)
+        Metronome::manager().cancel(pending_action_);
+
+    // stop sharing decoder
+    players_access_.lock();
+    if (leader_ != nullptr) {
+        leader_->followers_.remove(this);
+        leader_ = nullptr;
+    }
+    else if (!followers_.empty())
+        handover();
+    players_access_.unlock();
+    resume_ = GST_CLOCK_TIME_NONE;
+
     // un-ready the media player
     opened_ = false;
     failed_ = false;
@@ -799,18 +880,14 @@ void MediaPlayer::close()
     rate_change_ = RATE_CHANGE_NONE;
     position_ = GST_CLOCK_TIME_NONE;
 
+#ifdef MEDIA_PLAYER_DEBUG
+    if (frames_.dropped() + frames_.skipped() > 0)
+        Log::Info("MediaPlayer %s Dropped %lu and skipped %lu late frames out of %lu.", std::to_string(id_).c_str(),
+                  (unsigned long) frames_.dropped(), (unsigned long) frames_.skipped(), (unsigned long) frames_.pushed());
+#endif
     // cleanup eventual remaining frame memory
-    for(guint i = 0; i < N_VFRAME; i++) {
-        frame_[i].access.lock();
-        if (frame_[i].buffer) {
-            gst_buffer_unref(frame_[i].buffer);
-            frame_[i].buffer = NULL;
-        }
-        frame_[i].status = INVALID;
-        frame_[i].access.unlock();
-    }
-    write_index_ = 0;
-    last_index_ = 0;
+    frames_.clear();
+    gst_caps_replace(&v_frame_caps_, NULL);
 
     // clean up GST
     if (pipeline_ != nullptr) {
@@ -827,10 +904,16 @@ void MediaPlayer::close()
         textureindex_ = 0;
     }
 
-    // cleanup picture buffer
-    if (pbo_[0]) {
-        glDeleteBuffers(2, pbo_);
-        pbo_[0] = 0;
+    // cleanup picture buffers
+    if (uploader_) {
+        delete uploader_;
+        uploader_ = nullptr;
+    }
+
+    // cleanup YUV conversion
+    if (yuv_) {
+        delete yuv_;
+        yuv_ = nullptr;
     }
 }
 
@@ -863,11 +946,16 @@ GstClockTime MediaPlayer::position()
 
 void MediaPlayer::enable(bool on)
 {
-    if ( !opened_ || pipeline_ == nullptr)
+    if ( !opened_ )
         return;
 
     if ( enabled_ != on ) {
 
+        // stop sharing decoder
+        diverge();
+        if ( pipeline_ == nullptr )
+            return;
+
         // option to automatically rewind each time the player is disabled
         if (!on && rewind_on_disable_) {
             rewind(true);
@@ -913,6 +1001,11 @@ bool MediaPlayer::singleFrame() const
 
 std::string MediaPlayer::decoderName()
 {
+    // name of the shared decoder
+    std::lock_guard<std::recursive_mutex> lock(players_access_);
+    if (leader_ != nullptr)
+        return leader_->decoderName();
+
     if (decoder_name_.empty()) {
         // try to know if it is a hardware decoder
         if (pipeline_)
@@ -988,6 +1081,10 @@ void MediaPlayer::play(bool on)
     if (!enabled_ || pending_ || singleFrame())
         return;
 
+    // stop sharing decoder if play status changes
+    if ( desired_state_ != (on ? GST_STATE_PLAYING : GST_STATE_PAUSED) )
+        diverge();
+
     // Metronome
     if (metro_sync_ > Metronome::SYNC_NONE) {
         // busy with this delayed action
@@ -997,9 +1094,9 @@ void MediaPlayer::play(bool on)
                  p->execute_play_command(o); p->pending_=false; }, this, on);
         // Execute: sync to Metronome
         if (metro_sync_ > Metronome::SYNC_BEAT)
-            Metronome::manager().executeAtPhase( playlater );
+            pending_action_ = Metronome::manager().executeAtPhase( playlater );
         else
-            Metronome::manager().executeAtBeat( playlater );
+            pending_action_ = Metronome::manager().executeAtBeat( playlater );
     }
     else
         // execute immediately
@@ -1030,6 +1127,8 @@ MediaPlayer::LoopMode MediaPlayer::loop() const
 
 void MediaPlayer::setLoop(MediaPlayer::LoopMode mode)
 {
+    if (loop_ != mode)
+        diverge();
     loop_ = mode;
 }
 
@@ -1038,6 +1137,9 @@ void MediaPlayer::rewind(bool force)
     if (!enabled_ || !media_.seekable || pending_)
         return;
 
+    // stop sharing decoder
+    diverge();
+
     // playing forward, loop to begin;
     //          begin is the end of a gab which includes the first PTS (if exists)
     //          normal case, begin is zero
@@ -1055,9 +1157,9 @@ void MediaPlayer::rewind(bool force)
                  p->execute_seek_command( t, f ); p->pending_=false; }, this, target, force);
         // Execute: sync to Metronome
         if (metro_sync_ > Metronome::SYNC_BEAT)
-            Metronome::manager().executeAtPhase( rewindlater );
+            pending_action_ = Metronome::manager().executeAtPhase( rewindlater );
         else
-            Metronome::manager().executeAtBeat( rewindlater );
+            pending_action_ = Metronome::manager().executeAtBeat( rewindlater );
     }
     else
         // execute immediately
@@ -1071,6 +1173,9 @@ void MediaPlayer::step(uint milisecond)
     if (!enabled_ || isPlaying() || pending_)
         return;
 
+    // stop sharing decoder
+    diverge();
+
     if ( ( rate_ < 0.0 && position_ <= timeline_.next(0)  )
          || ( rate_ > 0.0 && position_ >= timeline_.previous(timeline_.last()) ) )
         rewind();
@@ -1089,9 +1194,9 @@ void MediaPlayer::step(uint milisecond)
                      gst_element_send_event(p->pipeline_, e); p->pending_=false; }, this, stepevent) ;
             // Execute: sync to Metronome
             if (metro_sync_ > Metronome::SYNC_BEAT)
-                Metronome::manager().executeAtPhase( steplater );
+                pending_action_ = Metronome::manager().executeAtPhase( steplater );
             else
-                Metronome::manager().executeAtBeat( steplater );
+                pending_action_ = Metronome::manager().executeAtBeat( steplater );
         }
         else
             // execute immediately
@@ -1129,6 +1234,9 @@ void MediaPlayer::seek(GstClockTime pos)
     if (!enabled_ || !media_.seekable || seeking_)
         return;
 
+    // stop sharing decoder
+    diverge();
+
     // apply seek
     GstClockTime target = CLAMP(pos, timeline_.begin(), timeline_.end());
     execute_seek_command(target);
@@ -1140,6 +1248,9 @@ void MediaPlayer::jump(uint milisecond)
     if (!enabled_ || !isPlaying())
         return;
 
+    // stop sharing decoder
+    diverge();
+
     gst_element_send_event (pipeline_, gst_event_new_step (GST_FORMAT_TIME,
                                                            CLAMP(milisecond, 1, 1000) * GST_MSECOND,
                                                            ABS(rate_),
@@ -1147,98 +1258,77 @@ void MediaPlayer::jump(uint milisecond)
 
 }
 
-void MediaPlayer::init_texture(guint index)
+void MediaPlayer::init_texture(GstBuffer *buf)
 {
     glActiveTexture(GL_TEXTURE0);
     glGenTextures(1, &textureindex_);
     glBindTexture(GL_TEXTURE_2D, textureindex_);
     glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, media_.width, media_.height);
 
-    // fill texture frame with frame at given index
-    if (frame_[index].buffer) {
-        GstMapInfo map;
-        gst_buffer_map(frame_[index].buffer, &map, GST_MAP_READ);
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, media_.width, media_.height,
-                        GL_RGBA, GL_UNSIGNED_BYTE, map.data);
-        gst_buffer_unmap (frame_[index].buffer, &map);
-    }
-
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
+    // fill texture frame with given buffer
+    if (buf) {
+        GstMapInfo map;
+        gst_buffer_map(buf, &map, GST_MAP_READ);
+        if (yuv_)
+            yuv_->convert(v_frame_video_info_, map.data, textureindex_);
+        else
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, media_.width, media_.height,
+                            GL_RGBA, GL_UNSIGNED_BYTE, map.data);
+        gst_buffer_unmap (buf, &map);
+    }
+
     // use Pixel Buffer Objects only for performance needs of videos
     if ( !singleFrame() ) {
-        // set pbo image size
-        pbo_size_ = media_.height * media_.width * 4;
-
-        // create pixel buffer objects,
-        if (pbo_[0])
-            glDeleteBuffers(2, pbo_);
-        glGenBuffers(2, pbo_);
-
-        // should be good to go
-        pbo_index_ = 0;
-        pbo_next_index_ = 1;
+        // create ring of pixel buffer objects for frames of that size
+        if (uploader_ == nullptr)
+            uploader_ = new TextureUploader;
+        uploader_->configure( yuv_ ? GST_VIDEO_INFO_SIZE(&v_frame_video_info_) : media_.height * media_.width * 4 );
 
         // initialize decoderName once (forced update)
         decoder_name_ = "";
-        Log::Info("MediaPlayer %s Uses %s decoding and OpenGL PBO texturing.", std::to_string(id_).c_str(), decoderName().c_str());
+        Log::Info("MediaPlayer %s Uses %s decoding and OpenGL %sPBO texturing.", std::to_string(id_).c_str(), decoderName().c_str(),
+                  uploader_->persistent() ? "persistent " : "");
     }
 
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 
-void MediaPlayer::fill_texture(guint index)
+void MediaPlayer::fill_texture(GstBuffer *buf)
 {
     // is this the first frame ?
     if (textureindex_ < 1)
     {
         // initialize texture on first run
-        // (this also fills the texture with frame at index)
-        init_texture(index);
+        // (this also fills the texture with the buffer)
+        init_texture(buf);
     }
     else {
         // Use GST mapping to access pointer to RGBA data
         GstMapInfo map;
-        gst_buffer_map(frame_[index].buffer, &map, GST_MAP_READ);
+        gst_buffer_map(buf, &map, GST_MAP_READ);
 
         // bind texture for writing
         glBindTexture(GL_TEXTURE_2D, textureindex_);
 
-        // use dual Pixel Buffer Object (faster)
-        if (pbo_size_ > 0 && map.size == pbo_size_) {
-
-            // In dual PBO mode, increment current index first then get the next index
-            pbo_index_ = (pbo_index_ + 1) % 2;
-            pbo_next_index_ = (pbo_index_ + 1) % 2;
-
-            // bind PBO to read pixels
-            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_[pbo_index_]);
-            // copy pixels from PBO to texture object
-            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, media_.width, media_.height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
-            // bind the next PBO to write pixels
-            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_[pbo_next_index_]);
-
-#ifdef USE_GL_BUFFER_SUBDATA
-            glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, pbo_size_, map.data);
-#else
-            // update data directly on the mapped buffer
-            // NB : equivalent but faster than glBufferSubData (memmove instead of memcpy ?)
-            // See http://www.songho.ca/opengl/gl_pbo.html#map for more details
-            glBufferData(GL_PIXEL_UNPACK_BUFFER, pbo_size_, 0, GL_STREAM_DRAW);
-            // map the buffer object into client's memory
-            GLubyte* ptr = (GLubyte*) glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
-            if (ptr)
-                memmove(ptr, map.data, pbo_size_);
-
-            // release pointer to mapping buffer
-            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
-#endif
+        // use ring of Pixel Buffer Objects (faster)
+        if (uploader_ && uploader_->bind(map.data, map.size)) {
+            // copy pixels from bound PBO to texture object
+            if (yuv_)
+                yuv_->convert(v_frame_video_info_, nullptr, textureindex_);
+            else
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, media_.width, media_.height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
             // done with PBO
-            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            uploader_->unbind();
+        }
+        else if (yuv_) {
+            // without PBO, upload and convert planes
+            yuv_->convert(v_frame_video_info_, map.data, textureindex_);
         }
         else {
             // without PBO, use standard opengl (slower)
@@ -1250,7 +1340,7 @@ void MediaPlayer::fill_texture(guint index)
         glBindTexture(GL_TEXTURE_2D, 0);
 
         // unmap buffer to let it free
-        gst_buffer_unmap (frame_[index].buffer, &map);
+        gst_buffer_unmap (buf, &map);
 
     }
 }
@@ -1274,7 +1364,9 @@ void MediaPlayer::update()
                         Log::Info("'%s' : %s", uri().c_str(), media_.log.c_str());
                     if (!media_.isimage)
                         timeline_.setTiming( TimeInterval(0, media_.end), media_.dt);
-                    execute_open();
+                    // use the decoder of an identical media player, or open
+                    if ( !share() )
+                        execute_open();
                 }
                 else {
                     Log::Warning("'%s' : %s", uri().c_str(), media_.log.c_str());
@@ -1287,58 +1379,68 @@ void MediaPlayer::update()
         return;
     }
 
+    // follow the shared decoder
+    players_access_.lock();
+    if (leader_ != nullptr) {
+        // leader changed (or failed): decode separately, unless another can be shared
+        if ( leader_->failed_ || !same_decoding(leader_) )
+            diverge(true);
+        else {
+            position_ = leader_->position_;
+            force_update_ = false;
+            players_access_.unlock();
+            return;
+        }
+    }
+    players_access_.unlock();
+
     // prevent unnecessary updates: disabled or already filled image
     if ( (!enabled_ && !force_update_) || (singleFrame() && textureindex_>0 ) )
         return;
 
+    // changes below are shared with followers
+    updating_ = true;
+
     // local variables before trying to update
-    guint read_index = 0;
+    FrameRing::Frame frame;
     bool need_loop = false;
 
-    // locked access to current index
-    index_lock_.lock();
-    // get the last frame filled from fill_frame()
-    read_index = last_index_;
-    // unlock access to index change
-    index_lock_.unlock();
-
-    // lock frame while reading it
-    frame_[read_index].access.lock();
-
-    // do not fill a frame twice
-    if (frame_[read_index].status != INVALID ) {
+    // get the most recent frame filled from fill_frame()
+    if ( frames_.pull(frame) ) {
 
         // is this an End-of-Stream frame ?
-        if (frame_[read_index].status == EOS )
+        if (frame.status == FrameRing::EOS )
         {
-            // will execute seek command below (after unlock)
+            // will execute seek command below
             need_loop = true;
         }
         // otherwise just fill non-empty SAMPLE or PREROLL
-        else if (frame_[read_index].is_new)
+        else if (frame.buffer)
         {
-            // fill the texture with the frame at reading index
-            fill_texture(read_index);
+            // video info of the caps negotiated for this frame (colorimetry, range, strides)
+            update_video_info(frame.caps);
 
-            // double update for pre-roll frame and dual PBO (ensure frame is displayed now)
-            if ( (frame_[read_index].status == PREROLL || seeking_ ) && pbo_size_ > 0)
-                fill_texture(read_index);
+            // fill the texture with the frame
+            // (uploaded immediately: no need to double update for pre-roll)
+            fill_texture(frame.buffer);
 
-            // // free frame
-            // frame_[read_index].unmap();
-            frame_[read_index].is_new = false;
+            // free frame
+            gst_buffer_unref(frame.buffer);
         }
+        if (frame.caps)
+            gst_caps_unref(frame.caps);
 
         // we just displayed a vframe : set position time to frame PTS
-        position_ = frame_[read_index].position;
+        position_ = frame.position;
 
-        // avoid reading it again
-        frame_[read_index].status = INVALID;
+        // continue from the position where the shared decoder was left
+        if (resume_ != GST_CLOCK_TIME_NONE && frame.status != FrameRing::EOS) {
+            GstClockTime target = resume_;
+            resume_ = GST_CLOCK_TIME_NONE;
+            execute_seek_command(target);
+        }
     }
 
-    // unkock frame after reading it
-    frame_[read_index].access.unlock();
-
     // if already seeking (asynch)
     if (seeking_) {
         // request status update to pipeline (re-sync gst thread)
@@ -1388,6 +1490,85 @@ void MediaPlayer::update()
 #endif
 
     force_update_ = false;
+    updating_ = false;
+}
+
+bool MediaPlayer::same_decoding(const MediaPlayer *p) const
+{
+    // same media, decoded the same way, in the same play status
+    return p->uri_.compare(uri_) == 0 && p->video_filter_.compare(video_filter_) == 0
+            && p->force_software_decoding_ == force_software_decoding_
+            && !p->audio_enabled_ && !audio_enabled_
+            && p->enabled_ == enabled_ && p->desired_state_ == desired_state_
+            && p->rate_ == rate_ && p->loop_ == loop_
+            && p->timeline_.interval() == timeline_.interval()
+            && p->timeline_.gaps() == timeline_.gaps();
+}
+
+bool MediaPlayer::share()
+{
+    std::lock_guard<std::recursive_mutex> lock(players_access_);
+
+    // images are cheap to decode (and modified in execute_open)
+    if ( !Settings::application.render.shared_decoding || media_.isimage || leader_ != nullptr )
+        return false;
+
+    // position to show (start of media if not playing yet)
+    const GstClockTime pos = position_ == GST_CLOCK_TIME_NONE ? 0 : position_;
+
+    for (auto it = players_.begin(); it != players_.end(); ++it) {
+        MediaPlayer *p = *it;
+        // look for a media player decoding on its own, showing the same frame
+        if ( p == this || p->leader_ != nullptr || p->pipeline_ == nullptr || !p->opened_ || p->failed_ )
+            continue;
+        GstClockTime p_pos = p->resume_ != GST_CLOCK_TIME_NONE ? p->resume_ : p->position_;
+        if (p_pos == GST_CLOCK_TIME_NONE)
+            p_pos = 0;
+        if ( same_decoding(p) && ABS_DIFF(pos, p_pos) <= 2 * timeline_.step() ) {
+            // follow this leader
+            leader_ = p;
+            p->followers_.push_back(this);
+            position_ = p->position_;
+            opened_ = true;
+            Log::Info("MediaPlayer %s Shares decoder of MediaPlayer %s", std::to_string(id_).c_str(), std::to_string(p->id_).c_str());
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void MediaPlayer::diverge(bool rejoin)
+{
+    std::lock_guard<std::recursive_mutex> lock(players_access_);
+
+    // a follower opens its own decoder, continuing from the current position
+    if (leader_ != nullptr) {
+        leader_->followers_.remove(this);
+        leader_ = nullptr;
+        if ( !rejoin || !share() ) {
+            resume_ = position_;
+            execute_open();
+        }
+    }
+    // a leader leaves its decoder to its followers
+    // (except for its own timeline management, shared with followers)
+    else if (!followers_.empty() && !updating_)
+        handover();
+}
+
+void MediaPlayer::handover()
+{
+    // NB: called with players_access_ locked
+    // the first follower opens a decoder for the others
+    MediaPlayer *f = followers_.front();
+    followers_.pop_front();
+    for (auto it = followers_.begin(); it != followers_.end(); ++it)
+        (*it)->leader_ = f;
+    f->followers_.splice(f->followers_.end(), followers_);
+    f->leader_ = nullptr;
+    f->resume_ = f->position_;
+    f->execute_open();
 }
 
 void MediaPlayer::execute_loop_command()
@@ -1477,6 +1658,10 @@ void MediaPlayer::setPlaySpeed(double s)
     bool change_direction =  s * rate_ < 0.0;
 #endif
 
+    // stop sharing decoder if speed changes
+    if (s != rate_)
+        diverge();
+
     // Set rate to requested value (may be executed later)
     setRate(s);
 
@@ -1543,6 +1728,9 @@ float MediaPlayer::currentTimelineFading()
 
 void MediaPlayer::setTimeline(const Timeline &tl)
 {
+    // stop sharing decoder if the play sections change
+    if ( tl.interval() != timeline_.interval() || tl.gaps() != timeline_.gaps() )
+        diverge();
     timeline_ = tl;
 }
 
@@ -1568,42 +1756,41 @@ double MediaPlayer::frameRate() const
 
 double MediaPlayer::updateFrameRate() const
 {
+    std::lock_guard<std::recursive_mutex> lock(players_access_);
+    if (leader_ != nullptr)
+        return leader_->updateFrameRate();
     return timecount_.frameRate();
 }
 
+double MediaPlayer::uploadTime() const
+{
+    std::lock_guard<std::recursive_mutex> lock(players_access_);
+    if (leader_ != nullptr)
+        return leader_->uploadTime();
+    return uploader_ ? uploader_->uploadTime() : 0.0;
+}
 
-// CALLBACKS
-
-bool MediaPlayer::fill_frame(GstBuffer *buf, FrameStatus status)
+void MediaPlayer::update_video_info(GstCaps *caps)
 {
-    // Do NOT overwrite an unread EOS
-    if ( frame_[write_index_].status == EOS )
-        write_index_ = (write_index_ + 1) % N_VFRAME;
+    // the caps given to the appsink are only those requested; read the
+    // actual video info from the caps of the samples when they change
+    if (caps == NULL || caps == v_frame_caps_)
+        return;
 
-    // lock access to frame
-    frame_[write_index_].access.lock();
+    GstVideoInfo info;
+    if ( gst_video_info_from_caps(&info, caps) )
+        v_frame_video_info_ = info;
+    gst_caps_replace(&v_frame_caps_, caps);
+}
 
-    // always empty frame before filling it again
-    if (frame_[write_index_].buffer) {
-        gst_buffer_unref(frame_[write_index_].buffer);
-        frame_[write_index_].buffer = NULL;
-    }
 
-    // accept status of frame received
-    frame_[write_index_].status = status;
+// CALLBACKS
 
+bool MediaPlayer::fill_frame(GstBuffer *buf, FrameRing::Status status, GstCaps *caps)
+{
     // a buffer is given (not EOS)
     if (buf != NULL) {
 
-        // copy the buffer in the frame
-        frame_[write_index_].buffer = gst_buffer_copy(buf);
-
-        // indicate to update loop that buffer is new
-        frame_[write_index_].is_new = true;
-
-        // set presentation time stamp
-        frame_[write_index_].position = buf->pts;
-
         // set the start position (i.e. pts of first frame we got)
         if (timeline_.first() == GST_CLOCK_TIME_NONE) {
             timeline_.setFirst(buf->pts);
@@ -1612,25 +1799,13 @@ bool MediaPlayer::fill_frame(GstBuffer *buf, FrameStatus status)
                 timeline_.addGap(0, buf->pts);
         }
 
+        // give the buffer to update loop, with presentation time stamp
+        // (a late frame is dropped if update loop did not read previous ones)
+        frames_.push(buf, status, buf->pts, caps);
     }
     // else; null buffer for EOS: give a position
-    else {
-        frame_[write_index_].status = EOS;
-        frame_[write_index_].position = rate_ > 0.0 ? timeline_.end() : timeline_.begin();
-    }
-
-    // unlock access to frame
-    frame_[write_index_].access.unlock();
-
-    // lock access to change current index (very quick)
-    index_lock_.lock();
-    // indicate update() that this is the last frame filled (and unlocked)
-    last_index_ = write_index_;
-    // unlock access to index change
-    index_lock_.unlock();
-
-    // for writing, we will access the next in stack
-    write_index_ = (write_index_ + 1) % N_VFRAME;
+    else
+        frames_.push(NULL, FrameRing::EOS, rate_ > 0.0 ? timeline_.end() : timeline_.begin());
 
     // calculate actual FPS of update
     timecount_.tic();
@@ -1642,7 +1817,7 @@ void MediaPlayer::callback_end_of_stream (GstAppSink *, gpointer p)
 {
     MediaPlayer *m = static_cast<MediaPlayer *>(p);
     if (m && m->opened_) {
-        m->fill_frame(NULL, MediaPlayer::EOS);
+        m->fill_frame(NULL, FrameRing::EOS);
     }
 }
 
@@ -1663,11 +1838,11 @@ GstFlowReturn MediaPlayer::callback_new_preroll (GstAppSink *sink, gpointer p)
         MediaPlayer *m = static_cast<MediaPlayer *>(p);
         if (m && m->opened_) {
             // fill frame from buffer
-            if ( !m->fill_frame(buf, MediaPlayer::PREROLL) )
+            if ( !m->fill_frame(buf, FrameRing::PREROLL, gst_sample_get_caps(sample)) )
                 ret = GST_FLOW_ERROR;
             // loop negative rate: emulate an EOS
             else if (m->playSpeed() < 0.f && !(buf->pts > 0) ) {
-                m->fill_frame(NULL, MediaPlayer::EOS);
+                m->fill_frame(NULL, FrameRing::EOS);
             }
         }
     }
@@ -1698,11 +1873,11 @@ GstFlowReturn MediaPlayer::callback_new_sample (GstAppSink *sink, gpointer p)
             GstBuffer *buf = gst_sample_get_buffer (sample) ;
 
             // fill frame with buffer
-            if ( !m->fill_frame(buf, MediaPlayer::SAMPLE) )
+            if ( !m->fill_frame(buf, FrameRing::SAMPLE, gst_sample_get_caps(sample)) )
                 ret = GST_FLOW_ERROR;
             // loop negative rate: emulate an EOS
             else if (m->playSpeed() < 0.f && !(buf->pts > 0) ) {
-                m->fill_frame(NULL, MediaPlayer::EOS);
+                m->fill_frame(NULL, FrameRing::EOS);
             }
         }
     }
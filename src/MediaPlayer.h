@@ -2,6 +2,7 @@
 #define __GST_MEDIA_PLAYER_H_
 
 #include <string>
+#include <list>
 #include <mutex>
 #include <future>
 
@@ -12,9 +13,12 @@
 
 #include "Timeline.h"
 #include "Metronome.h"
+#include "FrameRing.h"
 
 // Forward declare classes referenced
 class Visitor;
+class YuvConverter;
+class TextureUploader;
 
 #define MAX_PLAY_SPEED 20.0
 #define MIN_PLAY_SPEED 0.1
@@ -227,6 +231,16 @@ public:
      * measured during play
      * */
     double updateFrameRate() const;
+    /**
+     * Get average time spent uploading frames
+     * to texture, in milliseconds
+     * */
+    double uploadTime() const;
+    /**
+     * Get the stack of decoded frames
+     * (for statistics on late frames)
+     * */
+    inline const FrameRing &frames() const { return frames_; }
     /**
      * Get frame width
      * */
@@ -269,6 +283,11 @@ public:
      * */
     inline void setSyncToMetronome(Metronome::Synchronicity s) { metro_sync_ = s; }
     inline Metronome::Synchronicity syncToMetronome() const { return metro_sync_; }
+    /**
+     * True if the decoder is shared with other media players
+     * (same media, timeline, speed and play status)
+     * */
+    bool sharedDecoding() const;
     /**
      * Adds a video effect into the gstreamer pipeline
      * NB: setVideoEffect reopens the video
@@ -293,7 +312,7 @@ public:
      * @brief registered
      * @return list of media players currently registered
      */
-    static std::list<GstElement*> registered() { return registered_; }
+    static std::list<GstElement*> registered();
 
     /**
      * Discoverer to check uri and get media info
@@ -324,10 +343,12 @@ private:
     GstElement *pipeline_;
     GstBus *bus_;
     GstVideoInfo v_frame_video_info_;
+    GstCaps *v_frame_caps_;
     std::atomic<bool> opened_;
     std::atomic<bool> failed_;
     bool force_update_;
     bool pending_;
+    uint64_t pending_action_;
     bool seeking_;
     bool enabled_;
     bool rewind_on_disable_;
@@ -360,36 +381,24 @@ private:
     TimeCounter timecount_;
 
     // frame stack
-    typedef enum  {
-        SAMPLE = 0,
-        PREROLL = 1,
-        EOS = 2,
-        INVALID = 3
-    } FrameStatus;
-
-    struct Frame {
-        GstBuffer *buffer;
-        FrameStatus status;
-        bool is_new;
-        GstClockTime position;
-        std::mutex access;
-
-        Frame() {
-            buffer = NULL;
-            is_new = false;
-            status = INVALID;
-            position = GST_CLOCK_TIME_NONE;
-        }
-    };
-    Frame frame_[N_VFRAME];
-    guint write_index_;
-    guint last_index_;
-    std::mutex index_lock_;
+    FrameRing frames_;
 
     // for PBO
-    guint pbo_[2];
-    guint pbo_index_, pbo_next_index_;
-    guint pbo_size_;
+    TextureUploader *uploader_;
+
+    // for GPU colorspace conversion
+    YuvConverter *yuv_;
+
+    // shared decoding: a follower shows the frames decoded by its leader
+    // until it diverges (seek, change of speed, play status, etc.)
+    MediaPlayer *leader_;
+    std::list<MediaPlayer *> followers_;
+    GstClockTime resume_;
+    bool updating_;
+    bool same_decoding(const MediaPlayer *p) const;
+    bool share();
+    void diverge(bool rejoin = false);
+    void handover();
 
     // gst pipeline control
     void execute_open();
@@ -398,9 +407,10 @@ private:
     void execute_seek_command(GstClockTime target = GST_CLOCK_TIME_NONE, bool force = false);
 
     // gst frame filling
-    void init_texture(guint index);
-    void fill_texture(guint index);
-    bool fill_frame(GstBuffer *buf, FrameStatus status);
+    void init_texture(GstBuffer *buf);
+    void fill_texture(GstBuffer *buf);
+    bool fill_frame(GstBuffer *buf, FrameRing::Status status, GstCaps *caps = NULL);
+    void update_video_info(GstCaps *caps);
 
     // gst callbacks
     static void callback_end_of_stream (GstAppSink *, gpointer);
@@ -412,6 +422,12 @@ private:
     // global list of registered media player
     static void pipeline_terminate(GstElement *p, GstBus *b);
     static std::list<GstElement*> registered_;
+
+    // global list of media players (to share decoders)
+    // NB: the mutex protects the lists of players and of pipelines, and the
+    // links between leaders and followers (may be locked again by the same thread)
+    static std::list<MediaPlayer*> players_;
+    static std::recursive_mutex players_access_;
 };
 
 
@@ -218,6 +218,8 @@ void MediaSource::render()
         // render the media player into frame buffer
         // NB: this also applies the color correction shader
         renderbuffer_->begin();
+        // texture of media player can change (e.g. shared decoder)
+        texturesurface_->setTextureIndex( mediaplayer_->texture() );
         // apply fading
         float __f = mediaplayer_->currentTimelineFading();
         setAudioVolumeFactor(Source::VOLUME_OPACITY, __f);
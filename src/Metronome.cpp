@@ -18,6 +18,8 @@
 **/
 
 #include <thread>
+#include <cmath>
+#include <algorithm>
 
 /// Ableton Link is a technology that synchronizes musical beat, tempo,
 /// and phase across multiple applications running on one or more devices.
@@ -147,9 +149,12 @@ namespace ableton
 ableton::Link *link_ = new ableton::Link(120.);
 ableton::Engine engine_(*link_);
 
-Metronome::Metronome()
-{
+// actions due in less than this are waited for actively
+#define METRONOME_SPIN_TIME std::chrono::microseconds(1000)
 
+Metronome::Metronome() : running_(false)
+{
+    variance_[0] = variance_[1] = 0.0;
 }
 
 bool Metronome::init()
@@ -171,6 +176,17 @@ void Metronome::terminate()
 
     // disconnect
     link_->enable(false);
+
+    // stop scheduler (pending actions are discarded)
+    access_.lock();
+    running_ = false;
+    actions_.clear();
+    index_.clear();
+    ready_.clear();
+    access_.unlock();
+    wakeup_.notify_all();
+    if (thread_.joinable())
+        thread_.join();
 }
 
 void Metronome::setEnabled (bool on)
@@ -249,20 +265,143 @@ std::chrono::microseconds Metronome::timeToPhase()
     return engine_.timeNextPhase( now ) - now;
 }
 
-void delay(std::function<void()> f, std::chrono::microseconds us)
+uint64_t Metronome::schedule( std::function<void()> f, std::chrono::microseconds due, bool in_frame )
+{
+    std::lock_guard<std::mutex> lock(access_);
+
+    // start scheduler on first use
+    if (!running_) {
+        if (thread_.joinable())
+            thread_.join();
+        running_ = true;
+        thread_ = std::thread(Metronome::scheduler, this);
+    }
+
+    // insert action in time ordered queue
+    static uint64_t _id = 0;
+    Action a = { ++_id, due, f, in_frame };
+    index_[a.id] = actions_.emplace(due, a);
+
+    // scheduler might need to wake up earlier
+    wakeup_.notify_one();
+
+    return a.id;
+}
+
+uint64_t Metronome::executeAtBeat( std::function<void()> f, bool in_frame )
+{
+    std::chrono::microseconds now = engine_.now();
+    return schedule( f, engine_.timeNextBeat( now ), in_frame );
+}
+
+uint64_t Metronome::executeAtPhase( std::function<void()> f, bool in_frame )
 {
-    std::this_thread::sleep_for(us);
-    f();
+    std::chrono::microseconds now = engine_.now();
+    return schedule( f, engine_.timeNextPhase( now ), in_frame );
+}
+
+bool Metronome::cancel( uint64_t id )
+{
+    std::lock_guard<std::mutex> lock(access_);
+
+    // waiting for its time
+    auto it = index_.find(id);
+    if ( it != index_.end() ) {
+        actions_.erase(it->second);
+        index_.erase(it);
+        return true;
+    }
+
+    // waiting for next frame
+    for (auto a = ready_.begin(); a != ready_.end(); ++a) {
+        if ( a->id == id ) {
+            ready_.erase(a);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Metronome::scheduler(Metronome *m)
+{
+    Log::SetThreadName("metronome");
+
+    std::unique_lock<std::mutex> lock(m->access_);
+
+    while (m->running_) {
+
+        // nothing to do
+        if (m->actions_.empty()) {
+            m->wakeup_.wait(lock);
+            continue;
+        }
+
+        // sleep until the first action is almost due, then wait actively
+        ActionQueue::iterator next = m->actions_.begin();
+        std::chrono::microseconds now = engine_.now();
+        if (next->first > now) {
+            if (next->first - now > METRONOME_SPIN_TIME)
+                m->wakeup_.wait_for(lock, next->first - now - METRONOME_SPIN_TIME);
+            else {
+                lock.unlock();
+                std::this_thread::yield();
+                lock.lock();
+            }
+            continue;
+        }
+
+        // remove action from queue
+        Action a = std::move(next->second);
+        m->index_.erase(a.id);
+        m->actions_.erase(next);
+
+        // action to be executed in next frame
+        if (a.in_frame)
+            m->ready_.push_back(std::move(a));
+        // execute action now
+        else {
+            m->measure(false, a.due, now);
+            lock.unlock();
+            a.f();
+            lock.lock();
+        }
+    }
+}
+
+void Metronome::update()
+{
+    std::list<Action> ready;
+    access_.lock();
+    ready.swap(ready_);
+    std::chrono::microseconds now = engine_.now();
+    for (auto a = ready.begin(); a != ready.end(); ++a)
+        measure(true, a->due, now);
+    access_.unlock();
+
+    for (auto a = ready.begin(); a != ready.end(); ++a)
+        a->f();
 }
 
-void Metronome::executeAtBeat( std::function<void()> f )
+void Metronome::measure( bool in_frame, std::chrono::microseconds due, std::chrono::microseconds now )
 {
-    std::thread( delay, f, timeToBeat() ).detach();
+    Statistics &s = statistics_[in_frame ? 1 : 0];
+    double &v = variance_[in_frame ? 1 : 0];
+
+    // online mean and variance of delay
+    double d = (double) (now - due).count();
+    s.count++;
+    double delta = d - s.mean;
+    s.mean += delta / (double) s.count;
+    v += delta * (d - s.mean);
+    s.jitter = s.count > 1 ? sqrt( v / (double) (s.count - 1) ) : 0.0;
+    s.max = std::max(s.max, d);
 }
 
-void Metronome::executeAtPhase( std::function<void()> f )
+Metronome::Statistics Metronome::statistics( bool in_frame ) const
 {
-    std::thread( delay, f, timeToPhase() ).detach();
+    std::lock_guard<std::mutex> lock(access_);
+    return statistics_[in_frame ? 1 : 0];
 }
 
 float Metronome::timeToSync(Synchronicity sync)
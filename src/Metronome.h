@@ -3,6 +3,11 @@
 
 #include <chrono>
 #include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <map>
+#include <list>
 
 class Metronome
 {
@@ -47,12 +52,30 @@ public:
     double phase () const;
 
     // mechanisms to delay execution to next beat
+    // (in the scheduler thread, or at the start of next frame if in_frame)
+    // Returns an id of the action to cancel it
     std::chrono::microseconds timeToBeat();
-    void executeAtBeat( std::function<void()> f );
+    uint64_t executeAtBeat( std::function<void()> f, bool in_frame = false );
 
     // mechanisms to delay execution to next phase
     std::chrono::microseconds timeToPhase();
-    void executeAtPhase( std::function<void()> f );
+    uint64_t executeAtPhase( std::function<void()> f, bool in_frame = false );
+
+    // cancel a delayed action ; false if it was already executed
+    bool cancel( uint64_t id );
+
+    // execute the delayed actions due in frame (called by Mixer at each frame)
+    void update();
+
+    // delay of execution of actions after their due time, in microseconds
+    struct Statistics {
+        uint64_t count;
+        double mean;
+        double jitter;
+        double max;
+        Statistics() : count(0), mean(0.0), jitter(0.0), max(0.0) {}
+    };
+    Statistics statistics( bool in_frame = false ) const;
 
     // get time to sync, in milisecond
     float timeToSync(Synchronicity sync);
@@ -60,6 +83,32 @@ public:
     // get number of connected peers
     size_t peers () const;
 
+private:
+
+    // actions waiting for their time (Ableton Link clock)
+    struct Action {
+        uint64_t id;
+        std::chrono::microseconds due;
+        std::function<void()> f;
+        bool in_frame;
+    };
+    typedef std::multimap<std::chrono::microseconds, Action> ActionQueue;
+    ActionQueue actions_;
+    std::map<uint64_t, ActionQueue::iterator> index_;
+    std::list<Action> ready_;
+    uint64_t schedule( std::function<void()> f, std::chrono::microseconds due, bool in_frame );
+
+    // single scheduler thread
+    static void scheduler(Metronome *m);
+    std::thread thread_;
+    mutable std::mutex access_;
+    std::condition_variable wakeup_;
+    bool running_;
+
+    // statistics of delay (Welford variance)
+    void measure( bool in_frame, std::chrono::microseconds due, std::chrono::microseconds now );
+    Statistics statistics_[2];
+    double variance_[2];
 };
 
 /// Example calls to executeAtBeat
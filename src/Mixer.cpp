@@ -56,6 +56,9 @@
 #include "ActionManager.h"
 #include "MixingGroup.h"
 #include "FrameGrabber.h"
+#include "Metronome.h"
+#include "Profiler.h"
+#include "ControlManager.h"
 
 #include "Mixer.h"
 
@@ -68,7 +71,7 @@ const std::chrono::milliseconds timeout_ = std::chrono::milliseconds(4);
 
 
 Mixer::Mixer() : session_(nullptr), back_session_(nullptr), sessionSwapRequested_(false),
-    current_view_(nullptr), busy_(false), dt_(16.f), dt__(16.f)
+    current_view_(nullptr), busy_(false), dt_(16.f), dt__(16.f), fixed_dt_(0.f)
 {
     // unsused initial empty session
     current_source_ = session_->end();
@@ -81,6 +84,14 @@ Mixer::Mixer() : session_(nullptr), back_session_(nullptr), sessionSwapRequested
 
 void Mixer::update()
 {
+    PROFILE_SCOPE("mixer", "update");
+
+    // apply OSC control messages received since last frame
+    Control::manager().receive();
+
+    // execute actions scheduled by metronome for this frame
+    Metronome::manager().update();
+
     // sort-of garbage collector : just wait for 1 iteration
     // before deleting the previous session: this way, the sources
     // had time to end properly
@@ -187,7 +198,7 @@ void Mixer::update()
             // delete previous
             deleteSource(candidate_sources_.front().second);
             // rename new source with previous name
-            candidate_sources_.front().first->setName(previous_name);
+            session_->renameSource(candidate_sources_.front().first, previous_name);
         }
 
         candidate_sources_.pop_front();
@@ -197,6 +208,8 @@ void Mixer::update()
     static GTimer *timer = g_timer_new ();
     dt_ = g_timer_elapsed (timer, NULL) * 1000.0;
     g_timer_start(timer);
+    if (fixed_dt_ > 0.f)
+        dt_ = fixed_dt_;
 
     // compute stabilized dt__
     dt__ = 0.05f * dt_ + 0.95f * dt__;
@@ -987,7 +1000,7 @@ void Mixer::renameSource(Source *s, const std::string &newname)
         tentativename = BaseToolkit::uniqueName(tentativename, session_->getNameList(s->id()));
 
         // ok to rename
-        s->setName(tentativename);
+        session_->renameSource(s, tentativename);
     }
 }
 
@@ -1664,7 +1677,7 @@ void Mixer::paste(const std::string& clipboard)
 }
 
 
-void Mixer::restore(tinyxml2::XMLElement *sessionNode)
+void Mixer::restore(tinyxml2::XMLElement *sessionNode, const SourceIdList &unchanged)
 {
     //
     // source lists
@@ -1676,9 +1689,10 @@ void Mixer::restore(tinyxml2::XMLElement *sessionNode)
 
     // load history status:
     // - if a source exists, its attributes are updated, and that's all
+    // - if a source exists and is listed as unchanged, it is left as is
     // - if a source does not exists (in current session), it is created inside the session
     SessionLoader loader( session_ );
-    loader.load( sessionNode );
+    loader.load( sessionNode, unchanged );
 
     // loaded_sources contains map of xml ids of all sources treated by loader
     std::map< uint64_t, Source* > loaded_sources = loader.getSources();
@@ -43,6 +43,8 @@ public:
     void update ();
     inline float dt () const { return dt_; } // in miliseconds
     inline int fps  () const { return int(roundf(1000.f/dt__)); }
+    // fixed time step in miliseconds (0 to follow the clock)
+    inline void setFixedStep (float dt) { fixed_dt_ = dt; }
 
     // draw session and current view
     void draw ();
@@ -129,7 +131,7 @@ public:
     void paste  (const std::string& clipboard);
 
     // version and undo management
-    void restore(tinyxml2::XMLElement *sessionNode);
+    void restore(tinyxml2::XMLElement *sessionNode, const SourceIdList &unchanged = SourceIdList());
 
 protected:
 
@@ -164,6 +166,7 @@ protected:
     bool busy_;
     float dt_;
     float dt__;
+    float fixed_dt_;
 };
 
 #endif // MIXER_H
@@ -316,6 +316,12 @@ void OutputPreviewWindow::Render()
                     ImGui::MenuItem(info.c_str(), nullptr, false, false);
                     info = std::to_string(video_recorder_->buffering()) + "% Buffer used";
                     ImGui::MenuItem(info.c_str(), nullptr, false, false);
+                    guint64 hits = FrameGrabbing::manager().poolHits();
+                    guint64 misses = FrameGrabbing::manager().poolMisses();
+                    if (hits + misses > 0) {
+                        info = std::to_string((100 * hits) / (hits + misses)) + "% Buffers recycled";
+                        ImGui::MenuItem(info.c_str(), nullptr, false, false);
+                    }
                 }
                 else {
                     ImGui::MenuItem("Settings", nullptr, false, false);
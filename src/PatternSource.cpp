@@ -17,6 +17,7 @@
  * along with this program. If not, see <https://www.gnu.org/licenses/>.
 **/
 
+#include <glad/glad.h>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "Decorations.h"
@@ -24,61 +25,79 @@
 #include "Visitor.h"
 #include "Log.h"
 #include "GstToolkit.h"
+#include "Settings.h"
+#include "Shader.h"
+#include "FrameBuffer.h"
+#include "RenderingManager.h"
 
 #include "PatternSource.h"
 
 //
 //   Fill the list of patterns videotestsrc
 //
-//    Label (for display), feature (for test), pipeline (for gstreamer), animated (true/false), available (false by default)
+//    Label (for display), feature (for test), pipeline (for gstreamer), animated (true/false), available (false by default),
+//    generated (true if implemented in shaders/pattern.fs, at the index of the pattern)
 std::vector<pattern_descriptor> Pattern::patterns_ = {
-    { "Black", "videotestsrc", "videotestsrc pattern=black", false, false },
-    { "White", "videotestsrc", "videotestsrc pattern=white", false, false },
-    { "Gradient", "videotestsrc", "videotestsrc pattern=gradient", false, false },
-    { "Checkers 1x1 px", "videotestsrc", "videotestsrc pattern=checkers-1 ! videobalance saturation=0 contrast=1.5", false, false },
-    { "Checkers 8x8 px", "videotestsrc", "videotestsrc pattern=checkers-8 ! videobalance saturation=0 contrast=1.5", false, false },
-    { "Circles", "videotestsrc", "videotestsrc pattern=circular", false, false },
-    { "Lissajous", "frei0r-src-lissajous0r", "frei0r-src-lissajous0r ratiox=0.001 ratioy=0.999 ! videoconvert", false, false },
-    { "Pinwheel", "videotestsrc", "videotestsrc pattern=pinwheel", false, false },
-    { "Spokes", "videotestsrc", "videotestsrc pattern=spokes", false, false },
-    { "Red", "videotestsrc", "videotestsrc pattern=red", false, false },
-    { "Green", "videotestsrc", "videotestsrc pattern=green", false, false },
-    { "Blue", "videotestsrc", "videotestsrc pattern=blue", false, false },
-    { "Color bars", "videotestsrc", "videotestsrc pattern=smpte100", false, false },
-    { "RGB grid", "videotestsrc", "videotestsrc pattern=colors", false, false },
-    { "SMPTE test", "videotestsrc", "videotestsrc pattern=smpte", true, false },
-    { "Television snow", "videotestsrc", "videotestsrc pattern=snow", true, false },
-    { "Blink", "videotestsrc", "videotestsrc pattern=blink", true, false },
-    { "Fresnel zone plate", "videotestsrc", "videotestsrc pattern=zone-plate kx2=XXX ky2=YYY kt=4", true, false },
-    { "Chroma zone plate", "videotestsrc", "videotestsrc pattern=chroma-zone-plate kx2=XXX ky2=YYY kt=4", true, false },
-    { "Bar moving", "videotestsrc", "videotestsrc pattern=bar horizontal-speed=5", true, false },
-    { "Ball bouncing", "videotestsrc", "videotestsrc pattern=ball", true, false },
-    { "Blob", "frei0r-src-ising0r", "frei0r-src-ising0r", true, false },
-    { "Timer", "timeoverlay",  "videotestsrc pattern=solid-color foreground-color=0 ! timeoverlay halignment=center valignment=center font-desc=\"Sans, 72\" ", true, false },
-    { "Clock", "clockoverlay", "videotestsrc pattern=solid-color foreground-color=0 ! clockoverlay halignment=center valignment=center font-desc=\"Sans, 72\" ", true, false },
-    { "Resolution", "textoverlay", "videotestsrc pattern=solid-color foreground-color=0 ! textoverlay text=\"XXXX x YYYY px\" halignment=center valignment=center font-desc=\"Sans, 52\" ", false, false },
-    { "Frame", "videobox", "videotestsrc pattern=solid-color foreground-color=0 ! videobox fill=white top=-10 bottom=-10 left=-10 right=-10", false, false },
-    { "Cross", "textoverlay", "videotestsrc pattern=solid-color foreground-color=0 ! textoverlay text=\"+\" halignment=center valignment=center font-desc=\"Sans, 22\" ", false, false },
-    { "Grid", "frei0r-src-test-pat-g", "frei0r-src-test-pat-g type=0.35", false, false },
-    { "Point Grid", "frei0r-src-test-pat-g", "frei0r-src-test-pat-g type=0.4", false, false },
-    { "Ruler", "frei0r-src-test-pat-g", "frei0r-src-test-pat-g type=0.9", false, false },
-    { "RGB noise", "frei0r-filter-rgbnoise", "videotestsrc pattern=black ! frei0r-filter-rgbnoise noise=0.6", true, false },
-    { "Philips test", "frei0r-src-test-pat-b", "frei0r-src-test-pat-b type=0.7 ", false, false }
+    { "Black", "videotestsrc", "videotestsrc pattern=black", false, false, true },
+    { "White", "videotestsrc", "videotestsrc pattern=white", false, false, true },
+    { "Gradient", "videotestsrc", "videotestsrc pattern=gradient", false, false, true },
+    { "Checkers 1x1 px", "videotestsrc", "videotestsrc pattern=checkers-1 ! videobalance saturation=0 contrast=1.5", false, false, true },
+    { "Checkers 8x8 px", "videotestsrc", "videotestsrc pattern=checkers-8 ! videobalance saturation=0 contrast=1.5", false, false, true },
+    { "Circles", "videotestsrc", "videotestsrc pattern=circular", false, false, true },
+    { "Lissajous", "frei0r-src-lissajous0r", "frei0r-src-lissajous0r ratiox=0.001 ratioy=0.999 ! videoconvert", false, false, false },
+    { "Pinwheel", "videotestsrc", "videotestsrc pattern=pinwheel", false, false, true },
+    { "Spokes", "videotestsrc", "videotestsrc pattern=spokes", false, false, true },
+    { "Red", "videotestsrc", "videotestsrc pattern=red", false, false, true },
+    { "Green", "videotestsrc", "videotestsrc pattern=green", false, false, true },
+    { "Blue", "videotestsrc", "videotestsrc pattern=blue", false, false, true },
+    { "Color bars", "videotestsrc", "videotestsrc pattern=smpte100", false, false, true },
+    { "RGB grid", "videotestsrc", "videotestsrc pattern=colors", false, false, true },
+    { "SMPTE test", "videotestsrc", "videotestsrc pattern=smpte", true, false, true },
+    { "Television snow", "videotestsrc", "videotestsrc pattern=snow", true, false, true },
+    { "Blink", "videotestsrc", "videotestsrc pattern=blink", true, false, true },
+    { "Fresnel zone plate", "videotestsrc", "videotestsrc pattern=zone-plate kx2=XXX ky2=YYY kt=4", true, false, true },
+    { "Chroma zone plate", "videotestsrc", "videotestsrc pattern=chroma-zone-plate kx2=XXX ky2=YYY kt=4", true, false, true },
+    { "Bar moving", "videotestsrc", "videotestsrc pattern=bar horizontal-speed=5", true, false, true },
+    { "Ball bouncing", "videotestsrc", "videotestsrc pattern=ball", true, false, true },
+    { "Blob", "frei0r-src-ising0r", "frei0r-src-ising0r", true, false, false },
+    { "Timer", "timeoverlay",  "videotestsrc pattern=solid-color foreground-color=0 ! timeoverlay halignment=center valignment=center font-desc=\"Sans, 72\" ", true, false, false },
+    { "Clock", "clockoverlay", "videotestsrc pattern=solid-color foreground-color=0 ! clockoverlay halignment=center valignment=center font-desc=\"Sans, 72\" ", true, false, false },
+    { "Resolution", "textoverlay", "videotestsrc pattern=solid-color foreground-color=0 ! textoverlay text=\"XXXX x YYYY px\" halignment=center valignment=center font-desc=\"Sans, 52\" ", false, false, false },
+    { "Frame", "videobox", "videotestsrc pattern=solid-color foreground-color=0 ! videobox fill=white top=-10 bottom=-10 left=-10 right=-10", false, false, true },
+    { "Cross", "textoverlay", "videotestsrc pattern=solid-color foreground-color=0 ! textoverlay text=\"+\" halignment=center valignment=center font-desc=\"Sans, 22\" ", false, false, false },
+    { "Grid", "frei0r-src-test-pat-g", "frei0r-src-test-pat-g type=0.35", false, false, false },
+    { "Point Grid", "frei0r-src-test-pat-g", "frei0r-src-test-pat-g type=0.4", false, false, false },
+    { "Ruler", "frei0r-src-test-pat-g", "frei0r-src-test-pat-g type=0.9", false, false, false },
+    { "RGB noise", "frei0r-filter-rgbnoise", "videotestsrc pattern=black ! frei0r-filter-rgbnoise noise=0.6", true, false, true },
+    { "Philips test", "frei0r-src-test-pat-b", "frei0r-src-test-pat-b type=0.7 ", false, false, false }
 };
 
 
-Pattern::Pattern() : Stream(), type_(UINT_MAX) // invalid pattern
+Pattern::Pattern() : Stream(), type_(UINT_MAX), // invalid pattern
+    generated_(false), timestamp_(GST_CLOCK_TIME_NONE), rendered_(GST_CLOCK_TIME_NONE),
+    program_(nullptr), framebuffer_(0), vao_(0)
 {
 
 }
 
+Pattern::~Pattern()
+{
+    if (framebuffer_)
+        glDeleteFramebuffers(1, &framebuffer_);
+    if (vao_)
+        glDeleteVertexArrays(1, &vao_);
+    if (program_)
+        delete program_;
+}
+
 pattern_descriptor Pattern::get(uint type)
 {
     type = CLAMP(type, 0, patterns_.size()-1);
 
-    // check availability of feature to use this pattern
+    // check availability of feature to use this pattern (not needed if generated)
     if (!patterns_[type].available)
-        patterns_[type].available = GstToolkit::has_feature(patterns_[type].feature);
+        patterns_[type].available = ( patterns_[type].generated && Settings::application.render.gpu_patterns ) ||
+                                    GstToolkit::has_feature(patterns_[type].feature);
 
     // return struct
     return patterns_[type];
@@ -126,8 +145,138 @@ void Pattern::open( uint pattern, glm::ivec2 res )
     // remember if the pattern is to be updated once or animated
     single_frame_ = !Pattern::patterns_[type_].animated;
 
+    // generate the pattern with the graphics card if possible
+    generated_ = Pattern::patterns_[type_].generated && Settings::application.render.gpu_patterns;
+    if (generated_) {
+        // same as Stream::open, without pipeline to discover
+        description_ = gstreamer_pattern;
+        close();
+        failed_ = false;
+        width_ = res.x;
+        height_ = res.y;
+        execute_open();
+    }
     // (private) open stream
-    Stream::open(gstreamer_pattern, res.x, res.y);
+    else
+        Stream::open(gstreamer_pattern, res.x, res.y);
+}
+
+void Pattern::execute_open()
+{
+    if (!generated_) {
+        Stream::execute_open();
+        return;
+    }
+
+    // no pipeline: texture is rendered in update
+    textureinitialized_ = false;
+    position_ = 0;
+    timestamp_ = GST_CLOCK_TIME_NONE;
+    rendered_ = GST_CLOCK_TIME_NONE;
+
+    Log::Info("Stream %s Generates '%s' (%d x %d)", std::to_string(id_).c_str(),
+              Pattern::patterns_[type_].label.c_str(), width_, height_);
+    opened_ = true;
+}
+
+void Pattern::rewind()
+{
+    if (generated_)
+        position_ = 0;
+    else
+        Stream::rewind();
+}
+
+void Pattern::update()
+{
+    if (!generated_) {
+        Stream::update();
+        return;
+    }
+
+    // discard
+    if (failed_ || !opened_)
+        return;
+
+    // play time advances only when enabled and playing
+    const GstClockTime now = gst_util_get_timestamp();
+    if ( enabled_ && desired_state_ == GST_STATE_PLAYING && timestamp_ != GST_CLOCK_TIME_NONE )
+        position_ += now - timestamp_;
+    timestamp_ = now;
+
+    // render static pattern once, and animated pattern on change of play time
+    if ( !textureinitialized_ || (!single_frame_ && position_ != rendered_) )
+        generate();
+}
+
+void Pattern::generate()
+{
+    // first time initialization
+    if (program_ == nullptr) {
+        program_ = new ShadingProgram("shaders/yuv420.vs", "shaders/pattern.fs");
+        // empty vertex array: the vertex shader generates the vertices
+        glGenVertexArrays(1, &vao_);
+        glGenFramebuffers(1, &framebuffer_);
+    }
+
+    // wait for the program to be compiled
+    program_->use();
+    if ( !program_->linked() ) {
+        if ( !program_->compiling() )
+            fail("Cannot generate pattern");
+        ShadingProgram::enduse();
+        return;
+    }
+
+    // create the RGBA texture and attach it to the framebuffer
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    if (!textureindex_) {
+        glGenTextures(1, &textureindex_);
+        glBindTexture(GL_TEXTURE_2D, textureindex_);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width_, height_);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureindex_, 0);
+        if ( glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE ) {
+            FrameBuffer::release();
+            ShadingProgram::enduse();
+            fail("Cannot render pattern into texture");
+            return;
+        }
+    }
+
+    // draw in the texture
+    RenderingAttrib attrib;
+    attrib.viewport = glm::ivec2(width_, height_);
+    attrib.clear_color = glm::vec4(0.f);
+    Rendering::manager().pushAttrib(attrib);
+    glDisable(GL_BLEND);
+
+    // render full screen with pattern shader, at the play time (animated at 30 fps)
+    program_->setUniform("iResolution", glm::vec3(width_, height_, 0.f));
+    program_->setUniform("iTime", (float) ( (double) position_ / (double) GST_SECOND ));
+    program_->setUniform("iFrame", (int) gst_util_uint64_scale(position_, 30, GST_SECOND));
+    program_->setUniform("iPattern", (int) type_);
+    glBindVertexArray(vao_);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    ShadingProgram::enduse();
+
+    Rendering::manager().popAttrib();
+    FrameBuffer::release();
+
+    rendered_ = position_;
+    if (!single_frame_)
+        timecount_.tic();
+
+    // done
+    if (!textureinitialized_) {
+        textureinitialized_ = true;
+        initialized_.notify_all();
+    }
 }
 
 PatternSource::PatternSource(uint64_t id) : StreamSource(id)
@@ -11,9 +11,20 @@ typedef struct pattern_ {
     std::string pipeline;
     bool animated;
     bool available;
+    bool generated;
 } pattern_descriptor;
 
-
+class ShadingProgram;
+
+/**
+ * @brief The Pattern stream renders test patterns
+ *
+ * Patterns are rendered by a gstreamer pipeline, or generated by
+ * the graphics card (shaders/pattern.fs) when the pattern is
+ * implemented in the shader and Settings render.gpu_patterns is on.
+ * A generated pattern has no pipeline; a static pattern is rendered
+ * once, and an animated pattern is rendered each time its play time changes.
+ */
 class Pattern : public Stream
 {
     static std::vector<pattern_descriptor> patterns_;
@@ -23,13 +34,31 @@ public:
     static uint count();
 
     Pattern();
+    ~Pattern();
     void open( uint pattern, glm::ivec2 res);
 
     glm::ivec2 resolution();
     inline uint type() const { return type_; }
+    inline bool generated() const { return generated_; }
+
+    // Stream interface
+    void update() override;
+    void rewind() override;
+
+protected:
+    void execute_open() override;
 
 private:
     uint type_;
+
+    // generation by the graphics card
+    bool generated_;
+    GstClockTime timestamp_;
+    GstClockTime rendered_;
+    ShadingProgram *program_;
+    guint framebuffer_;
+    guint vao_;
+    void generate();
 };
 
 class PatternSource : public StreamSource
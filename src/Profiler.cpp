@@ -0,0 +1,321 @@
+/*
+ * This file is part of vimix - video live mixer
+ *
+ * **Copyright** (C) 2019-2023 Bruno Herbelin <bruno.herbelin@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+**/
+
+
+#include <thread>
+#include <fstream>
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#include "Log.h"
+#include "SystemToolkit.h"
+
+#include "Profiler.h"
+
+// number of frames to wait for GPU timer queries
+#define PROFILER_GPU_LATENCY 8
+
+static std::atomic<uint32_t> thread_count(0);
+static thread_local uint32_t thread_id = ++thread_count;
+
+Profiler::Scope::Scope() : gpu(false), current(0.f), last_frame(0)
+{
+    values.fill(0.f);
+}
+
+Profiler::Profiler() : frame_(0), enabled_(false), gpu_timer_(false),
+    tracing_(false), trace_request_(0.f), trace_gpu_offset_(0)
+{
+}
+
+void Profiler::setEnabled(bool on)
+{
+    enabled_ = on;
+}
+
+Profiler::Scope &Profiler::scope(const char *category, const std::string &name, bool gpu)
+{
+    std::string key = std::string(category) + "/" + name + (gpu ? " (GPU)" : "");
+    Scope &s = scopes_[key];
+    if (s.name.empty()) {
+        s.category = category;
+        s.name = name;
+        s.gpu = gpu;
+    }
+    s.last_frame = frame_;
+    return s;
+}
+
+void Profiler::add(const char *category, const std::string &name, TimePoint begin, TimePoint end)
+{
+    std::lock_guard<std::mutex> lock(access_);
+
+    // sum time spent in the scope during this frame
+    if (enabled_)
+        scope(category, name, false).current += std::chrono::duration<float, std::milli>(end - begin).count();
+
+    // record event
+    if (tracing_) {
+        TraceEvent e;
+        e.category = category;
+        e.name = name;
+        e.thread = thread_id;
+        e.begin = std::chrono::duration_cast<std::chrono::microseconds>(begin - trace_start_).count();
+        e.duration = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+        trace_events_.push_back(e);
+    }
+}
+
+unsigned int Profiler::gpuQuery()
+{
+    if (gpu_queries_.empty()) {
+        gpu_queries_.resize(64);
+        glGenQueries(64, gpu_queries_.data());
+    }
+    unsigned int q = gpu_queries_.back();
+    gpu_queries_.pop_back();
+    glQueryCounter(q, GL_TIMESTAMP);
+    return q;
+}
+
+void Profiler::gpuRead()
+{
+    // read results of queries in order (stop at the first not available)
+    while (!gpu_pending_.empty()) {
+        GpuQuery &q = gpu_pending_.front();
+        GLint available = 0;
+        glGetQueryObjectiv(q.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available && frame_ - q.frame < PROFILER_GPU_LATENCY)
+            break;
+
+        if (available) {
+            GLuint64 t[2] = {0, 0};
+            glGetQueryObjectui64v(q.queries[0], GL_QUERY_RESULT, &t[0]);
+            glGetQueryObjectui64v(q.queries[1], GL_QUERY_RESULT, &t[1]);
+            float ms = (float) (t[1] - t[0]) / 1000000.f;
+
+            // add to the values of the frame of the query
+            if (enabled_ && frame_ - q.frame < PROFILER_FRAMES)
+                scope(q.category, q.name, true).values[q.frame % PROFILER_FRAMES] += ms;
+
+            // record event, in CPU time
+            if (tracing_) {
+                TraceEvent e;
+                e.category = q.category;
+                e.name = q.name;
+                e.thread = 0;
+                e.begin = (int64_t) (t[0] / 1000) + trace_gpu_offset_;
+                e.duration = (int64_t) (t[1] - t[0]) / 1000;
+                if (e.begin >= 0)
+                    trace_events_.push_back(e);
+            }
+        }
+
+        gpu_queries_.push_back(q.queries[0]);
+        gpu_queries_.push_back(q.queries[1]);
+        gpu_pending_.pop_front();
+    }
+}
+
+void Profiler::frame()
+{
+    std::lock_guard<std::mutex> lock(access_);
+
+    // first frame: check timer queries are supported (OpenGL 3.3)
+    if (frame_ == 0)
+        gpu_timer_ = ( glQueryCounter != nullptr && glGetQueryObjectui64v != nullptr );
+
+    // keep values of the frame for each scope, and forget
+    // scopes not used during the last frames (e.g. deleted source)
+    for (auto it = scopes_.begin(); it != scopes_.end(); ) {
+        Scope &s = it->second;
+        if (frame_ - s.last_frame > PROFILER_FRAMES)
+            it = scopes_.erase(it);
+        else {
+            if (!s.gpu)
+                s.values[frame_ % PROFILER_FRAMES] = s.current;
+            s.values[(frame_ + 1) % PROFILER_FRAMES] = 0.f;
+            s.current = 0.f;
+            ++it;
+        }
+    }
+    ++frame_;
+
+    // get results of GPU timer queries
+    if (gpu_timer_)
+        gpuRead();
+
+    // start of trace requested
+    if (trace_request_ > 0.f)
+        startTrace();
+
+    // end of trace: save events to file in a thread
+    if (tracing_ && std::chrono::steady_clock::now() > trace_end_) {
+        tracing_ = false;
+        std::vector<TraceEvent> events;
+        events.swap(trace_events_);
+        std::thread(Profiler::save, std::move(events), trace_filename_).detach();
+    }
+}
+
+void Profiler::trace(float seconds, const std::string &filename)
+{
+    std::lock_guard<std::mutex> lock(access_);
+    if (tracing_ || seconds <= 0.f)
+        return;
+
+    // trace starts at next frame
+    trace_request_ = seconds;
+    trace_filename_ = filename;
+    if (trace_filename_.empty())
+        trace_filename_ = SystemToolkit::home_path() + "vimix_trace_" + SystemToolkit::date_time_string() + ".json";
+}
+
+void Profiler::startTrace()
+{
+    const float seconds = trace_request_;
+    trace_request_ = 0.f;
+
+    trace_events_.clear();
+    trace_start_ = std::chrono::steady_clock::now();
+    trace_end_ = trace_start_ + std::chrono::milliseconds( (int64_t) (seconds * 1000.f) );
+
+    // offset of GPU time (ns) to trace time (us)
+    if (gpu_timer_) {
+        GLint64 gpu_now = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+        trace_gpu_offset_ = - gpu_now / 1000;
+    }
+
+    tracing_ = true;
+    Log::Info("Profiler tracing for %.1f s.", seconds);
+}
+
+static std::string json_string(const std::string &s)
+{
+    std::string out;
+    for (auto c = s.begin(); c != s.end(); ++c) {
+        if (*c == '"' || *c == '\\')
+            out += std::string("\\") + *c;
+        else if ( (unsigned char) *c < 0x20 )
+            out += ' ';
+        else
+            out += *c;
+    }
+    return out;
+}
+
+void Profiler::save(std::vector<TraceEvent> events, std::string filename)
+{
+    std::ofstream file(filename, std::ofstream::out | std::ofstream::trunc);
+    if (!file.is_open()) {
+        Log::Warning("Profiler cannot write trace to %s.", filename.c_str());
+        return;
+    }
+
+    file << "{\"traceEvents\":[\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}";
+    for (auto e = events.begin(); e != events.end(); ++e) {
+        file << ",\n{\"name\":\"" << json_string(e->name) << "\",\"cat\":\"" << json_string(e->category)
+             << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e->thread
+             << ",\"ts\":" << e->begin << ",\"dur\":" << e->duration << "}";
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    file.close();
+
+    Log::Notify("Profiler trace saved to %s", filename.c_str());
+}
+
+std::vector<Profiler::Statistics> Profiler::statistics() const
+{
+    std::vector<Statistics> ret;
+    std::lock_guard<std::mutex> lock(access_);
+
+    const size_t n = (size_t) std::min(frame_, (uint64_t) PROFILER_FRAMES);
+    if (n < 1)
+        return ret;
+
+    std::vector<float> v;
+    for (auto it = scopes_.begin(); it != scopes_.end(); ++it) {
+        const Scope &s = it->second;
+
+        // values of the last frames, ignoring the frame in progress
+        // and the frames waiting for GPU timer queries
+        v.clear();
+        const uint64_t skip = s.gpu ? PROFILER_GPU_LATENCY : 0;
+        for (uint64_t f = frame_ - n; f + skip < frame_; ++f)
+            v.push_back( s.values[f % PROFILER_FRAMES] );
+        if (v.empty())
+            continue;
+
+        Statistics stat;
+        stat.category = s.category;
+        stat.name = s.name;
+        stat.gpu = s.gpu;
+        float sum = 0.f;
+        for (auto x = v.begin(); x != v.end(); ++x)
+            sum += *x;
+        stat.mean = sum / (float) v.size();
+        std::sort(v.begin(), v.end());
+        stat.p50 = v[ (v.size() - 1) * 50 / 100 ];
+        stat.p95 = v[ (v.size() - 1) * 95 / 100 ];
+        stat.p99 = v[ (v.size() - 1) * 99 / 100 ];
+        stat.max = v.back();
+        ret.push_back(stat);
+    }
+
+    return ret;
+}
+
+ProfilerScope::ProfilerScope() : active_(false), category_(nullptr), gpu_query_(0)
+{
+}
+
+void ProfilerScope::start(const char *category, const std::string &name, bool gpu)
+{
+    active_ = Profiler::manager().active();
+    if (active_) {
+        category_ = category;
+        name_ = name;
+        begin_ = std::chrono::steady_clock::now();
+        if (gpu && Profiler::manager().gpu_timer_) {
+            std::lock_guard<std::mutex> lock(Profiler::manager().access_);
+            gpu_query_ = Profiler::manager().gpuQuery();
+        }
+    }
+}
+
+ProfilerScope::~ProfilerScope()
+{
+    if (active_) {
+        Profiler &p = Profiler::manager();
+        p.add(category_, name_, begin_, std::chrono::steady_clock::now());
+        if (gpu_query_ > 0) {
+            std::lock_guard<std::mutex> lock(p.access_);
+            Profiler::GpuQuery q;
+            q.category = category_;
+            q.name = name_;
+            q.queries[0] = gpu_query_;
+            q.queries[1] = p.gpuQuery();
+            q.frame = p.frame_;
+            p.gpu_pending_.push_back(q);
+        }
+    }
+}
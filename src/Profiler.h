@@ -0,0 +1,148 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <map>
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <list>
+#include <chrono>
+
+// number of frames kept for statistics
+#define PROFILER_FRAMES 240
+
+/**
+ * @brief The Profiler measures the time spent in scopes of code, each frame.
+ *
+ * Scopes are declared with PROFILE_SCOPE(category, name), or with
+ * PROFILE_GPU_SCOPE to also measure the time spent by the graphics card
+ * (GL timer queries, read back a few frames later).
+ * The time spent in a scope is summed over a frame, and the sums of the
+ * last PROFILER_FRAMES frames give statistics for each scope.
+ *
+ * Measures are done only when the profiler is enabled or tracing;
+ * tracing records every scope during a given time and saves them
+ * in a Chrome trace_event JSON file (chrome://tracing or Perfetto).
+ */
+class Profiler
+{
+    friend class ProfilerScope;
+
+    // Private Constructor
+    Profiler();
+    Profiler(Profiler const& copy) = delete;
+    Profiler& operator=(Profiler const& copy) = delete;
+
+public:
+
+    static Profiler& manager ()
+    {
+        // The only instance
+        static Profiler _instance;
+        return _instance;
+    }
+
+    // enable measures (each frame)
+    void setEnabled (bool on);
+    inline bool enabled () const { return enabled_; }
+    inline bool active () const { return enabled_ || tracing_; }
+
+    // new frame (Rendering thread, with OpenGL context)
+    void frame ();
+
+    // statistics of scopes over last frames, in milliseconds
+    struct Statistics {
+        std::string category;
+        std::string name;
+        bool gpu;
+        float mean;
+        float p50;
+        float p95;
+        float p99;
+        float max;
+    };
+    std::vector<Statistics> statistics () const;
+
+    // record all scopes during given duration and save them to file
+    // (default filename in home directory if empty), from next frame
+    void trace (float seconds, const std::string &filename = "");
+    inline bool tracing () const { return tracing_ || trace_request_ > 0.f; }
+
+private:
+
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    struct Scope {
+        std::string category;
+        std::string name;
+        bool gpu;
+        float current;
+        uint64_t last_frame;
+        std::array<float, PROFILER_FRAMES> values;
+        Scope();
+    };
+    std::map<std::string, Scope> scopes_;
+    uint64_t frame_;
+    mutable std::mutex access_;
+    std::atomic<bool> enabled_;
+    Scope &scope (const char *category, const std::string &name, bool gpu);
+    void add (const char *category, const std::string &name, TimePoint begin, TimePoint end);
+
+    // GPU timer queries
+    struct GpuQuery {
+        const char *category;
+        std::string name;
+        unsigned int queries[2];
+        uint64_t frame;
+    };
+    bool gpu_timer_;
+    std::list<GpuQuery> gpu_pending_;
+    std::vector<unsigned int> gpu_queries_;
+    unsigned int gpuQuery ();
+    void gpuRead ();
+
+    // Chrome trace
+    struct TraceEvent {
+        std::string category;
+        std::string name;
+        uint32_t thread;
+        int64_t begin;
+        int64_t duration;
+    };
+    std::atomic<bool> tracing_;
+    std::atomic<float> trace_request_;
+    void startTrace ();
+    std::vector<TraceEvent> trace_events_;
+    std::string trace_filename_;
+    TimePoint trace_start_;
+    TimePoint trace_end_;
+    int64_t trace_gpu_offset_;
+    static void save (std::vector<TraceEvent> events, std::string filename);
+};
+
+class ProfilerScope
+{
+public:
+    ProfilerScope ();
+    ~ProfilerScope ();
+
+    // start measuring (only if the profiler is active)
+    void start (const char *category, const std::string &name, bool gpu = false);
+
+private:
+    bool active_;
+    const char *category_;
+    std::string name_;
+    Profiler::TimePoint begin_;
+    unsigned int gpu_query_;
+};
+
+// NB: the name is evaluated only when the profiler is active
+#define PROFILE_SCOPE(category, name) ProfilerScope _profiler_scope_; \
+    if (Profiler::manager().active()) _profiler_scope_.start(category, name)
+#define PROFILE_GPU_SCOPE(category, name) ProfilerScope _profiler_scope_; \
+    if (Profiler::manager().active()) _profiler_scope_.start(category, name, true)
+
+#endif // PROFILER_H
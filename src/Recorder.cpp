@@ -36,6 +36,7 @@
 #include "MediaPlayer.h"
 #include "Log.h"
 #include "Audio.h"
+#include "SharedEncoder.h"
 
 #include "Recorder.h"
 
@@ -336,20 +337,31 @@ std::string VideoRecorder::init(GstCaps *caps)
     keyframe_count_ = framerate_preset_value[Settings::application.record.framerate_mode];
 
     // create a gstreamer pipeline
-    std::string description = "appsrc name=src ! videoconvert ! queue ! ";
+    std::string description = "appsrc name=src ! ";
     if (Settings::application.record.profile < 0 || Settings::application.record.profile >= DEFAULT)
         Settings::application.record.profile = H264_STANDARD;
 
+    // H264 realtime without audio can use a shared encoder
+    bool shared = Settings::application.record.profile == H264_STANDARD &&
+            ( !Settings::application.accept_audio || Settings::application.record.audio_device.empty() ) &&
+            SharedEncoder::enabled();
+    if (shared) {
+        description += "h264parse ! ";
+        timestamp_on_clock_ = false;
+    }
     // test for a hardware accelerated encoder
-    if (Settings::application.render.gpu_decoding && (int) hardware_encoder.size() > 0 &&
+    else if (Settings::application.render.gpu_decoding && (int) hardware_encoder.size() > 0 &&
             GstToolkit::has_feature(hardware_encoder[Settings::application.record.profile]) ) {
 
+        description += "videoconvert ! queue ! ";
         description += hardware_profile_description[Settings::application.record.profile];
         Log::Info("Video Recording using hardware accelerated encoder (%s)", hardware_encoder[Settings::application.record.profile].c_str());
     }
     // revert to software encoder
-    else
+    else {
+        description += "videoconvert ! queue ! ";
         description += profile_description[Settings::application.record.profile];
+    }
 
     // setup muxer and prepare filename
     if( Settings::application.record.profile == JPEG_MULTI) {
@@ -448,9 +460,15 @@ std::string VideoRecorder::init(GstCaps *caps)
         gst_caps_set_value(tmp, "framerate", &v);
         g_value_unset (&v);
 
-        // instruct src to use the caps
+        // instruct src to use the caps (encoded caps if shared)
         caps_ = gst_caps_copy( tmp );
-        gst_app_src_set_caps (src_, caps_);
+        if (shared) {
+            GstCaps *encoded = gst_caps_from_string( SharedEncoder::format() );
+            gst_app_src_set_caps (src_, encoded);
+            gst_caps_unref (encoded);
+        }
+        else
+            gst_app_src_set_caps (src_, caps_);
         gst_caps_unref (tmp);
 
         // setup callbacks
@@ -477,10 +495,15 @@ std::string VideoRecorder::init(GstCaps *caps)
         return std::string("Video Recording : Failed to start frame grabber.");
     }
 
+    // receive frames from the shared encoder
+    if (shared)
+        SharedEncoder::subscribe(this, framerate_preset_value[Settings::application.record.framerate_mode]);
+
     // all good
     initialized_ = true;
 
-    return std::string("Video Recording started ") + profile_name[Settings::application.record.profile];
+    return std::string("Video Recording started ") + profile_name[Settings::application.record.profile]
+            + (shared ? " (shared encoder)" : "");
 
 }
 
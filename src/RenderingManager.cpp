@@ -36,6 +36,14 @@
 #endif
 //#include <GLFW/glfw3native.h>
 
+// EGL for offscreen rendering (no X11 types)
+#ifdef VIMIX_HEADLESS_EGL
+#define EGL_NO_X11
+#define MESA_EGL_NO_X11_HEADERS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
 #include <glm/gtc/matrix_transform.hpp> // glm::translate, glm::rotate, glm::scale
 #include <glm/ext/matrix_clip_space.hpp> // glm::perspective
 
@@ -68,6 +76,7 @@
 #include "ControlManager.h"
 #include "ImageFilter.h"
 #include "Primitives.h"
+#include "Profiler.h"
 
 #include "RenderingManager.h"
 
@@ -324,22 +333,13 @@ Rendering::Rendering()
 {
 //    main_window_ = nullptr;
     request_screenshot_ = false;
+    headless_display_ = nullptr;
+    headless_surface_ = nullptr;
+    headless_context_ = nullptr;
 }
 
-bool Rendering::init()
+void Rendering::initGstreamer()
 {
-    //
-    // Setup GLFW
-    //
-    glfwSetErrorCallback(glfw_error_callback);
-    if (!glfwInit()){
-        g_printerr("Failed to Initialize GLFW.\n");
-        return false;
-    }
-
-    //
-    // Gstreamer setup
-    //
     std::string plugins_scanner = SystemToolkit::cwd_path() + "gst-plugin-scanner" ;
     if ( SystemToolkit::file_exists(plugins_scanner)) {
         Log::Info("Found Gstreamer scanner %s", plugins_scanner.c_str());
@@ -395,6 +395,141 @@ bool Rendering::init()
     else {
         Log::Info("No hardware decoding plugin found.");
     }
+}
+
+bool Rendering::initHeadless(glm::ivec2 size)
+{
+#ifdef VIMIX_HEADLESS_EGL
+    //
+    // EGL display: prefer the Mesa surfaceless platform (no window system at all),
+    // and fallback to the default display
+    //
+    EGLDisplay display = EGL_NO_DISPLAY;
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay)
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+#endif
+    EGLint major = 0, minor = 0;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+            g_printerr("Failed to Initialize EGL.\n");
+            return false;
+        }
+    }
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        g_printerr("EGL %d.%d does not support OpenGL.\n", major, minor);
+        eglTerminate(display);
+        return false;
+    }
+
+    //
+    // EGL configuration: RGBA, with pbuffer if possible
+    // (vimix renders in its own framebuffers; the pbuffer is never drawn)
+    //
+    EGLint config_attribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint num_config = 0;
+    bool pbuffer = eglChooseConfig(display, config_attribs, &config, 1, &num_config) && num_config > 0;
+    if (!pbuffer) {
+        // any surface type (surfaceless context)
+        config_attribs[1] = 0;
+        if (!eglChooseConfig(display, config_attribs, &config, 1, &num_config) || num_config < 1) {
+            g_printerr("No EGL configuration for OpenGL.\n");
+            eglTerminate(display);
+            return false;
+        }
+    }
+
+    //
+    // OpenGL 3.3 core context, same as windows
+    //
+    const EGLint context_attribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION_KHR, 3,
+        EGL_CONTEXT_MINOR_VERSION_KHR, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attribs);
+    if (context == EGL_NO_CONTEXT) {
+        g_printerr("Failed to create EGL OpenGL 3.3 context.\n");
+        eglTerminate(display);
+        return false;
+    }
+
+    EGLSurface surface = EGL_NO_SURFACE;
+    if (pbuffer) {
+        const EGLint pbuffer_attribs[] = { EGL_WIDTH, size.x, EGL_HEIGHT, size.y, EGL_NONE };
+        surface = eglCreatePbufferSurface(display, config, pbuffer_attribs);
+    }
+    if (!eglMakeCurrent(display, surface, surface, context)) {
+        g_printerr("Failed to make EGL context current.\n");
+        if (surface != EGL_NO_SURFACE)
+            eglDestroySurface(display, surface);
+        eglDestroyContext(display, context);
+        eglTerminate(display);
+        return false;
+    }
+
+    if ( gladLoadGL((GLADloadfunc) eglGetProcAddress) == 0 ) {
+        g_printerr("Failed to initialize GLAD OpenGL loader.\n");
+        return false;
+    }
+    ShadingProgram::initialize();
+
+    headless_display_ = display;
+    headless_surface_ = surface;
+    headless_context_ = context;
+
+    //
+    // Gstreamer setup
+    //
+    initGstreamer();
+
+    //
+    // Main window without window: only keeps the rendering attributes
+    //
+    main_.window_attributes_.viewport = size;
+    main_.window_attributes_.clear_color = glm::vec4(COLOR_BGROUND, 1.f);
+    main_.dpi_scale_ = 1.f;
+    glPixelStorei(GL_UNPACK_ALIGNMENT,1);
+    glHint(GL_FRAGMENT_SHADER_DERIVATIVE_HINT, GL_NICEST);
+    (void) Resource::getTextureWhite();
+    main_.textureid_ = Resource::getTextureBlack();
+
+    Log::Info("Headless rendering with %s (EGL %d.%d%s).", (const char *) glGetString(GL_RENDERER),
+              major, minor, pbuffer ? ", pbuffer" : "");
+
+    return true;
+#else
+    (void) size;
+    g_printerr("Headless rendering is not available (built without EGL).\n");
+    return false;
+#endif
+}
+
+bool Rendering::init()
+{
+    //
+    // Setup GLFW
+    //
+    glfwSetErrorCallback(glfw_error_callback);
+    if (!glfwInit()){
+        g_printerr("Failed to Initialize GLFW.\n");
+        return false;
+    }
+
+    //
+    // Gstreamer setup
+    //
+    initGstreamer();
 
     //
     // Monitors
@@ -486,6 +621,8 @@ void Rendering::pushBackDrawCallback(RenderingCallback function)
 
 void Rendering::draw()
 {
+    // new frame for profiler
+    Profiler::manager().frame();
     // Poll and handle events (inputs, window resize, etc.)
     // You can read the io.WantCaptureMouse, io.WantCaptureKeyboard flags to tell if dear imgui wants to use your inputs.
     // - When io.WantCaptureMouse is true, do not dispatch mouse input data to your main application.
@@ -508,10 +645,13 @@ void Rendering::draw()
     main_.makeCurrent();
 
     // draw
-    std::list<Rendering::RenderingCallback>::iterator iter;
-    for (iter=draw_callbacks_.begin(); iter != draw_callbacks_.end(); ++iter)
     {
-        (*iter)();
+        PROFILE_GPU_SCOPE("rendering", "main");
+        std::list<Rendering::RenderingCallback>::iterator iter;
+        for (iter=draw_callbacks_.begin(); iter != draw_callbacks_.end(); ++iter)
+        {
+            (*iter)();
+        }
     }
 
     // perform screenshot if requested
@@ -525,9 +665,12 @@ void Rendering::draw()
 
     // draw output windows and count number of success
     int count = 0;
-    for (auto it = outputs_.begin(); it != outputs_.end(); ++it) {
-        if ( it->draw( Mixer::manager().session()->frame() ) )
-            ++count;
+    {
+        PROFILE_SCOPE("rendering", "outputs");
+        for (auto it = outputs_.begin(); it != outputs_.end(); ++it) {
+            if ( it->draw( Mixer::manager().session()->frame() ) )
+                ++count;
+        }
     }
     // terminate or initialize output windows to match number of output windows
     if (count > Settings::application.num_output_windows)
@@ -549,11 +692,29 @@ void Rendering::draw()
 
 void Rendering::terminate()
 {
+    // OpenGL programs are deleted with the context
+    ShadingProgram::terminate();
+
     // terminate all windows
     for (auto it = outputs_.begin(); it != outputs_.end(); ++it)
         it->terminate();
 
     main_.terminate();
+
+#ifdef VIMIX_HEADLESS_EGL
+    // release offscreen context
+    if (headless_context_) {
+        EGLDisplay display = (EGLDisplay) headless_display_;
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (headless_surface_ != EGL_NO_SURFACE)
+            eglDestroySurface(display, (EGLSurface) headless_surface_);
+        eglDestroyContext(display, (EGLContext) headless_context_);
+        eglTerminate(display);
+        headless_display_ = nullptr;
+        headless_surface_ = nullptr;
+        headless_context_ = nullptr;
+    }
+#endif
 }
 
 void Rendering::pushAttrib(RenderingAttrib ra)
@@ -1031,6 +1192,7 @@ bool RenderingWindow::init(int index, GLFWwindow *share)
             return false;
         }
         glad_initialized = true;
+        ShadingProgram::initialize();
     }
 
     // get rendering area
@@ -115,6 +115,9 @@ public:
 
     // Initialization OpenGL and GLFW window creation
     bool init();
+    // Initialization OpenGL offscreen, without window (no display needed)
+    bool initHeadless(glm::ivec2 size);
+    inline bool headless() const { return headless_context_ != nullptr; }
     // show windows and reset views
     void show(bool show_main_window = true);
     // true if active rendering window
@@ -200,6 +203,14 @@ private:
 
     Screenshot screenshot_;
     bool request_screenshot_;
+
+    // gstreamer setup (plugins and GPU decoding)
+    void initGstreamer();
+
+    // offscreen context (EGL)
+    void *headless_display_;
+    void *headless_surface_;
+    void *headless_context_;
 };
 
 
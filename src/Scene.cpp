@@ -40,6 +40,8 @@ static int num_nodes_ = 0;
 #endif
 
 // Node
+std::atomic<uint> Node::transform_updates_(0);
+
 Node::Node() : initialized_(false), visible_(true), refcount_(0)
 {
     // create unique id
@@ -51,6 +53,11 @@ Node::Node() : initialized_(false), visible_(true), refcount_(0)
     translation_ = glm::vec3(0.f);
     crop_ = glm::vec4(-1.f, 1.f, 1.f, -1.f);
     data_ = glm::zero<glm::mat4>();
+
+    // identity transform_ corresponds to default components
+    transform_scale_ = scale_;
+    transform_rotation_ = rotation_;
+    transform_translation_ = translation_;
 #if DEBUG_SCENE
     num_nodes_++;
 #endif
@@ -85,6 +92,9 @@ void Node::copyTransform(const Node *other)
     translation_ = other->translation_;
     crop_ = other->crop_;
     data_ = other->data_;
+    transform_scale_ = other->transform_scale_;
+    transform_rotation_ = other->transform_rotation_;
+    transform_translation_ = other->transform_translation_;
 }
 
 void Node::update( float dt)
@@ -103,8 +113,16 @@ void Node::update( float dt)
             ++iter;
     }
 
-    // update transform matrix from attributes
-    transform_ = GlmToolkit::transform(translation_, rotation_, scale_);
+    // update transform matrix from attributes, if they changed
+    if ( translation_ != transform_translation_ ||
+         rotation_ != transform_rotation_ ||
+         scale_ != transform_scale_ ) {
+        transform_ = GlmToolkit::transform(translation_, rotation_, scale_);
+        transform_translation_ = translation_;
+        transform_rotation_ = rotation_;
+        transform_scale_ = scale_;
+        ++transform_updates_;
+    }
 }
 
 void Node::accept(Visitor& v)
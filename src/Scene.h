@@ -4,6 +4,7 @@
 #define INVALID_ID -1
 
 #include <sys/types.h>
+#include <atomic>
 #include <set>
 #include <list>
 #include <vector>
@@ -24,7 +25,8 @@ class Group;
  *
  * Every Node has geometric operations for translation,
  * scale and rotation. The update() function computes the
- * transform_ matrix from these components.
+ * transform_ matrix from these components, only if they
+ * changed since the previous update.
  *
  * draw() shall be defined by the subclass.
  * The visible flag can be used to show/hide a Node.
@@ -78,6 +80,13 @@ public:
     // list of callbacks to call at each update
     std::list<UpdateCallback *> update_callbacks_;
     void clearCallbacks();
+
+    // count of transform matrices computed in update
+    static std::atomic<uint> transform_updates_;
+
+private:
+    // components of the current transform_ matrix
+    glm::vec3 transform_scale_, transform_rotation_, transform_translation_;
 };
 
 
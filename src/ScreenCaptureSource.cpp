@@ -445,7 +445,8 @@ void ScreenCaptureSource::setWindow(const std::string &windowname)
                 // new stream
                 stream_ = h->stream = new Stream;
 
-                // open gstreamer
+                // open gstreamer (opaque frames can be converted on GPU)
+                h->stream->setYuvTexturing(true);
                 h->stream->open( pipeline.str(), best.width, best.height);
                 h->stream->play(true);
             }
@@ -34,7 +34,10 @@
 #include "ControlManager.h"
 #include "SourceCallback.h"
 #include "CountVisitor.h"
+#include "ThreadPool.h"
+#include "GstToolkit.h"
 #include "Log.h"
+#include "Profiler.h"
 
 #include "Session.h"
 
@@ -44,11 +47,13 @@ SessionNote::SessionNote(const std::string &t, bool l, int s): label(std::to_str
 }
 
 Session::Session(uint64_t id) : id_(id), active_(true), activation_threshold_(MIXING_MIN_THRESHOLD),
-    filename_(""), thumbnail_(nullptr), ready_(false)
+    filename_(""), thumbnail_(nullptr), thumbnail_xml_(nullptr), ready_(false),
+    loading_rate_(1), loading_time_(0), loading_status_(LOADING_NONE)
 {
     // create unique id
     if (id_ == 0)
         id_ = BaseToolkit::uniqueId();
+    modified_ = BaseToolkit::uniqueId();
 
     config_[View::RENDERING] = new Group;
     config_[View::RENDERING]->scale_ = glm::vec3(0.f);
@@ -121,6 +126,9 @@ Session::~Session()
 
     snapshots_.keys_.clear();
     delete snapshots_.xmlDoc_;
+
+    if (thumbnail_xml_ != nullptr)
+        delete thumbnail_xml_;
 }
 
 uint64_t Session::runtime() const
@@ -128,6 +136,24 @@ uint64_t Session::runtime() const
     return gst_util_get_timestamp () - start_time_;
 }
 
+void Session::startProgressively()
+{
+    // all sources wait to be started
+    loading_.assign(sources_.begin(), sources_.end());
+
+    // the closest to the center of mixing view are the most visible:
+    // visible and active sources first, inactive sources last
+    loading_.sort([](Source *a, Source *b) {
+        return glm::length( glm::vec2(a->group(View::MIXING)->translation_) )
+                < glm::length( glm::vec2(b->group(View::MIXING)->translation_) );
+    });
+
+    // start with one source per frame
+    loading_rate_ = 1;
+    loading_time_ = 0;
+    loading_status_ = loading_.empty() ? LOADING_NONE : LOADING_FIRST_FRAME;
+}
+
 void Session::setActive (bool on)
 {
     if (active_ != on) {
@@ -176,6 +202,8 @@ void Session::update(float dt)
     if ( render_.frame() == nullptr )
         return;
 
+    PROFILE_SCOPE("session", "update");
+
     // listen to inputs
     for (auto k = input_callbacks_.begin(); k != input_callbacks_.end(); ++k)
     {
@@ -219,7 +247,7 @@ void Session::update(float dt)
                         {
                             // loop over all sources in Batch
                             for (auto sid = batch_[*v].begin(); sid != batch_[*v].end(); ++sid){
-                                SourceList::const_iterator sit = std::find_if(sources_.begin(), sources_.end(), Source::hasId(*sid));;
+                                SourceList::iterator sit = find(*sid);
                                 if ( sit != sources_.end()) {
                                     // generate a new callback from the model
                                     SourceCallback *forward = k->second.model_->clone();
@@ -243,7 +271,7 @@ void Session::update(float dt)
                     // go through all instances stored for that action
                     for (auto clb = k->second.instances_.begin(); clb != k->second.instances_.end(); ++clb) {
                         // find the source referenced by each instance
-                        SourceList::const_iterator sit = std::find_if(sources_.begin(), sources_.end(), Source::hasId(clb->first));;
+                        SourceList::iterator sit = find(clb->first);
                         // if the source is valid
                         if ( sit != sources_.end()) {
                             // either call the reverse if exists (stored as second element in pair)
@@ -264,10 +292,38 @@ void Session::update(float dt)
         }
     }
 
+    // prepare all started sources in parallel (callbacks and attributes, without OpenGL)
+    prepare_list_.clear();
+    for (SourceList::iterator it = sources_.begin(); it != sources_.end(); ++it) {
+        if ( started(*it) )
+            prepare_list_.push_back(*it);
+    }
+    ThreadPool::manager().parallel_for(prepare_list_.size(), [this, dt](size_t i) {
+        if ( !prepare_list_[i]->failed() )
+            prepare_list_[i]->prepare(dt);
+    });
+
+    // start more sources if previous frame was rendered fast enough
+    if ( !loading_.empty() ) {
+        if ( loading_time_ < SESSION_LOADING_BUDGET )
+            loading_rate_ = MIN( loading_rate_ * 2, SESSION_LOADING_MAX_RATE );
+        else
+            loading_rate_ = 1;
+        for (uint i = 0; i < loading_rate_ && !loading_.empty(); ++i)
+            loading_.pop_front();
+    }
+    uint64_t t = gst_util_get_timestamp ();
+
     // pre-render all sources
     ready_ = true;
     for( SourceList::iterator it = sources_.begin(); it != sources_.end(); ++it){
 
+        // source still waiting to be started
+        if ( !started(*it) ) {
+            ready_ = false;
+            continue;
+        }
+
         // ensure the RenderSource is rendering *this* session
         RenderSource *rs = dynamic_cast<RenderSource *>( *it );
         if ( rs!= nullptr && rs->session() != this )
@@ -288,6 +344,7 @@ void Session::update(float dt)
             // session is not ready if one source is not ready
             if ( !(*it)->ready() )
                 ready_ = false;
+            PROFILE_GPU_SCOPE("source", (*it)->name());
             // update the source
             (*it)->setActive(activation_threshold_);
             (*it)->update(dt);
@@ -297,6 +354,21 @@ void Session::update(float dt)
 
         // apply session fading to audio
         (*it)->setAudioVolumeFactor(Source::VOLUME_SESSION, 1.f - render_.fading());
+
+        // first source to render a frame
+        if ( loading_status_ == LOADING_FIRST_FRAME && (*it)->ready() ) {
+            Log::Info("Session %s First frame after %s", std::to_string(id_).c_str(),
+                      GstToolkit::time_to_string(runtime(), GstToolkit::TIME_STRING_READABLE).c_str());
+            loading_status_ = LOADING_ALL_FRAMES;
+        }
+    }
+    loading_time_ = gst_util_get_timestamp () - t;
+
+    // all sources started and ready
+    if ( loading_status_ == LOADING_ALL_FRAMES && loading_.empty() && ready_ ) {
+        Log::Info("Session %s Fully loaded after %s", std::to_string(id_).c_str(),
+                  GstToolkit::time_to_string(runtime(), GstToolkit::TIME_STRING_READABLE).c_str());
+        loading_status_ = LOADING_NONE;
     }
 
     // update session's mixing groups
@@ -363,6 +435,8 @@ SourceList::iterator Session::addSource(Source *s)
         sources_.push_back(s);
         // return the iterator to the source created at the end
         its = --sources_.end();
+        // index the source
+        indexSource(its);
     }
 
     // unlock access
@@ -384,9 +458,11 @@ SourceList::iterator Session::deleteSource(Source *s)
         detachSource(s);
         // erase all input callbacks for that source
         deleteInputCallbacks(s);
-        // erase the source from the failed list
+        // erase the source from the failed and loading lists
         failed_.erase(s);
+        loading_.remove(s);
         // erase the source from the update list & get next element
+        unindexSource(its);
         its = sources_.erase(its);
         // delete the source : safe now
         delete s;
@@ -412,9 +488,11 @@ SourceList::iterator Session::removeSource(Source *s)
     if (its != sources_.end()) {
         // detach
         detachSource(s);
-        // erase the source from the failed list
+        // erase the source from the failed and loading lists
         failed_.erase(s);
+        loading_.remove(s);
         // erase the source from the update list & get next element
+        unindexSource(its);
         ret = sources_.erase(its);
     }
 
@@ -424,6 +502,25 @@ SourceList::iterator Session::removeSource(Source *s)
     return ret;
 }
 
+void Session::renameSource(Source *s, const std::string &name)
+{
+    if (s == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> lock(index_access_);
+
+    // forget previous name
+    auto n = index_name_.find( s->name() );
+    if ( n != index_name_.end() && n->second == s->id() )
+        index_name_.erase(n);
+
+    s->setName(name);
+
+    // index new name if the source is in the session
+    if ( find(s) != sources_.end() )
+        index_name_[ s->name() ] = s->id();
+}
+
 Source *Session::popSource()
 {
     Source *s = nullptr;
@@ -435,7 +532,10 @@ Source *Session::popSource()
         s = *its;
         // detach
         detachSource(s);
+        // not waiting to start
+        loading_.remove(s);
         // erase the source from the update list & get next element
+        unindexSource(its);
         sources_.erase(its);
     }
 
@@ -462,11 +562,36 @@ void Session::setThumbnail(FrameBufferImage *t)
         std::thread( replaceThumbnail, this ).detach();
 }
 
+void Session::setThumbnail(tinyxml2::XMLDocument *xml)
+{
+    resetThumbnail();
+    thumbnail_xml_ = xml;
+}
+
+FrameBufferImage *Session::thumbnail()
+{
+    // decode thumbnail image when first needed
+    if (thumbnail_xml_ != nullptr) {
+        std::lock_guard<std::mutex> lock(thumbnail_access_);
+        if (thumbnail_xml_ != nullptr) {
+            thumbnail_ = SessionLoader::XMLToImage( thumbnail_xml_->FirstChildElement("Thumbnail") );
+            delete thumbnail_xml_;
+            thumbnail_xml_ = nullptr;
+        }
+    }
+
+    return thumbnail_;
+}
+
 void Session::resetThumbnail()
 {
     if (thumbnail_ != nullptr)
         delete thumbnail_;
     thumbnail_ = nullptr;
+
+    if (thumbnail_xml_ != nullptr)
+        delete thumbnail_xml_;
+    thumbnail_xml_ = nullptr;
 }
 
 void Session::setResolution(glm::vec3 resolution, bool useAlpha)
@@ -500,24 +625,110 @@ SourceList::iterator Session::end()
     return sources_.end();
 }
 
+void Session::indexSource(SourceList::iterator it)
+{
+    // NB: ids are unique; keep the first source in case of duplicate
+    index_id_.emplace( (*it)->id(), it );
+    modified_ = BaseToolkit::uniqueId();
+    std::lock_guard<std::mutex> lock(index_access_);
+    index_name_.emplace( (*it)->name(), (*it)->id() );
+}
+
+void Session::unindexSource(SourceList::iterator it)
+{
+    const uint64_t id = (*it)->id();
+    modified_ = BaseToolkit::uniqueId();
+    auto i = index_id_.find(id);
+    if ( i != index_id_.end() && i->second == it ) {
+        // less ids than sources only if some have the same id
+        const bool duplicate = index_id_.size() < sources_.size();
+        index_id_.erase(i);
+        // index another source with the same id, if any
+        for (auto other = sources_.begin(); duplicate && other != sources_.end(); ++other) {
+            if ( other != it && (*other)->id() == id ) {
+                index_id_.emplace(id, other);
+                break;
+            }
+        }
+    }
+    // names and nodes indexed with this id are verified on lookup
+}
+
+SourceList::const_iterator Session::indexed(uint64_t id) const
+{
+    auto i = index_id_.find(id);
+    if ( i != index_id_.end() )
+        return i->second;
+    return sources_.cend();
+}
+
 SourceList::iterator Session::find(Source *s)
 {
+    if ( s == nullptr )
+        return sources_.end();
+
+    // every id of sources in the list is indexed
+    auto i = index_id_.find( s->id() );
+    if ( i == index_id_.end() )
+        return sources_.end();
+    if ( *(i->second) == s )
+        return i->second;
+
+    // another source has the same id
     return std::find(sources_.begin(), sources_.end(), s);
 }
 
 SourceList::iterator Session::find(uint64_t id)
 {
-    return std::find_if(sources_.begin(), sources_.end(), Source::hasId(id));
+    auto i = index_id_.find(id);
+    if ( i != index_id_.end() )
+        return i->second;
+    return sources_.end();
 }
 
 SourceList::iterator Session::find(std::string namesource)
 {
-    return std::find_if(sources_.begin(), sources_.end(), Source::hasName(namesource));
+    std::lock_guard<std::mutex> lock(index_access_);
+
+    // try the index by name (can be outdated if the source was renamed)
+    auto n = index_name_.find(namesource);
+    if ( n != index_name_.end() ) {
+        SourceList::iterator it = find(n->second);
+        if ( it != sources_.end() && (*it)->name() == namesource )
+            return it;
+        index_name_.erase(n);
+    }
+
+    // search and index the source found
+    SourceList::iterator it = std::find_if(sources_.begin(), sources_.end(), Source::hasName(namesource));
+    if ( it != sources_.end() )
+        index_name_[namesource] = (*it)->id();
+
+    return it;
 }
 
 SourceList::iterator Session::find(Node *node)
 {
-    return std::find_if(sources_.begin(), sources_.end(), Source::hasNode(node));
+    std::lock_guard<std::mutex> lock(index_access_);
+
+    // try the index by node (can be outdated if the node was deleted or moved)
+    auto n = index_node_.find(node);
+    if ( n != index_node_.end() ) {
+        SourceList::iterator it = find(n->second);
+        if ( it != sources_.end() && Source::hasNode(node)(*it) )
+            return it;
+        index_node_.erase(n);
+    }
+
+    // search and index the source found
+    SourceList::iterator it = std::find_if(sources_.begin(), sources_.end(), Source::hasNode(node));
+    if ( it != sources_.end() ) {
+        if ( index_node_.size() > SESSION_NODE_INDEX_MAX )
+            index_node_.clear();
+        index_node_[node] = (*it)->id();
+    }
+
+    return it;
 }
 
 SourceList::iterator Session::find(float depth_from, float depth_to)
@@ -606,9 +817,8 @@ void Session::move(int current_index, int target_index)
     if ( target_index > current_index )
         ++to;
 
-    Source *s = (*from);
-    sources_.erase(from);
-    sources_.insert(to, s);
+    // move element in list (iterators remain valid)
+    sources_.splice(to, sources_, from);
 }
 
 bool Session::hasLink (SourceList sources)
@@ -757,8 +967,8 @@ SourceList Session::getBatch(size_t i) const
     {
         for (auto sid = batch_[i].begin(); sid != batch_[i].end(); ++sid){
 
-            SourceList::const_iterator it = std::find_if(sources_.begin(), sources_.end(), Source::hasId( *sid));;
-            if ( it != sources_.end())
+            SourceList::const_iterator it = indexed( *sid );
+            if ( it != sources_.cend())
                 list.push_back( *it);
 
         }
@@ -772,7 +982,7 @@ void Session::validate (SourceList &sources)
     // verify that all sources given are valid in the sesion
     // and remove the invalid sources
     for (auto _it = sources.begin(); _it != sources.end(); ) {
-        SourceList::iterator found = std::find(sources_.begin(), sources_.end(), *_it);
+        SourceList::iterator found = find(*_it);
         if ( found == sources_.end() )
             _it = sources.erase(_it);
         else
@@ -786,6 +996,10 @@ Session *Session::load(const std::string& filename, uint level)
     SessionCreator creator(level);
     creator.load(filename);
 
+    // sources will start progressively
+    if (creator.session() != nullptr)
+        creator.session()->startProgressively();
+
     // return created session
     return creator.session();
 }
@@ -3,6 +3,8 @@
 
 #include <mutex>
 #include <variant>
+#include <algorithm>
+#include <unordered_map>
 
 #include "SourceList.h"
 #include "RenderView.h"
@@ -28,6 +30,12 @@ struct SessionNote
     SessionNote(const std::string &t = "", bool l = false, int s = 0);
 };
 
+// time to render sources in a frame before starting more sources (ns)
+#define SESSION_LOADING_BUDGET 8000000
+#define SESSION_LOADING_MAX_RATE 16
+// maximum number of nodes remembered to find sources
+#define SESSION_NODE_INDEX_MAX 1024
+
 #define SNAPSHOT_NODE(i) std::to_string(i).insert(0,1,'S')
 
 struct SessionSnapshots {
@@ -60,6 +68,9 @@ public:
     // Does not delete the source
     SourceList::iterator removeSource (Source *s);
 
+    // set the name of the source of the session (keeps index by name)
+    void renameSource (Source *s, const std::string &name);
+
     // attach or detach from rendering
     void attachSource  (Source *s);
     void detachSource  (Source *s);
@@ -82,6 +93,8 @@ public:
     SourceList::iterator find (Node *node);
     SourceList::iterator find (float depth_from, float depth_to);
     SourceList::iterator find (uint64_t id);
+    // unique stamp of the list of sources, changed when a source is added or removed
+    inline uint64_t modified () const { return modified_; }
 
     // manage sources by #id (ordered index)
     SourceList::iterator at (int index);
@@ -96,6 +109,12 @@ public:
     void update (float dt);
     uint64_t runtime() const;
 
+    // start sources progressively, most visible first (e.g. after loading)
+    // NB: all sources are already instantiated (by the session loader); only
+    // their first update and render, which open their media, are delayed
+    void startProgressively ();
+    inline bool loading () const { return !loading_.empty(); }
+
     void execute(void (*func)(Source *));
 
     // update mode (active or not)
@@ -113,9 +132,11 @@ public:
     inline FrameBufferImage *renderThumbnail () { return render_.thumbnail(); }
 
     // get / set thumbnail image
-    inline FrameBufferImage *thumbnail () const { return thumbnail_; }
+    FrameBufferImage *thumbnail ();
     void setThumbnail(FrameBufferImage *t = nullptr);
     void resetThumbnail();
+    // set thumbnail image encoded in XML (decoded when needed)
+    void setThumbnail(tinyxml2::XMLDocument *xml);
 
     // configure rendering resolution
     void setResolution (glm::vec3 resolution, bool useAlpha = false);
@@ -194,6 +215,18 @@ protected:
     std::string filename_;
     SourceListUnique failed_;
     SourceList sources_;
+    uint64_t modified_;
+    std::vector<Source *> prepare_list_;
+
+    // hash indexes to find sources: by id kept in sync with sources_,
+    // by name and by node cached on lookup (ids verified in index by id)
+    std::unordered_map<uint64_t, SourceList::iterator> index_id_;
+    std::unordered_map<std::string, uint64_t> index_name_;
+    std::unordered_map<Node *, uint64_t> index_node_;
+    std::mutex index_access_;
+    void indexSource (SourceList::iterator it);
+    void unindexSource (SourceList::iterator it);
+    SourceList::const_iterator indexed (uint64_t id) const;
     void validate(SourceList &sources);
     std::list<SessionNote> notes_;
     std::list<MixingGroup *> mixing_groups_;
@@ -202,9 +235,20 @@ protected:
     std::vector<SourceIdList> batch_;
     std::mutex access_;
     FrameBufferImage *thumbnail_;
+    tinyxml2::XMLDocument *thumbnail_xml_;
+    std::mutex thumbnail_access_;
     uint64_t start_time_;
     bool ready_;
 
+    // sources waiting to start, by priority (neither prepared, updated nor rendered)
+    SourceList loading_;
+    inline bool started (Source *s) const {
+        return loading_.empty() || std::find(loading_.begin(), loading_.end(), s) == loading_.end();
+    }
+    uint loading_rate_;
+    uint64_t loading_time_;
+    enum { LOADING_NONE = 0, LOADING_FIRST_FRAME, LOADING_ALL_FRAMES } loading_status_;
+
     struct Fading
     {
         bool  active;
@@ -62,7 +62,7 @@ SessionInformation SessionCreator::info(const std::string& filename)
         setlocale(LC_ALL, "C");
         // try to load the file
         XMLDocument doc;
-        XMLError eResult = doc.LoadFile(filename.c_str());
+        int eResult = XMLLoadDoc(&doc, filename);
         // silently ignore on error
         if ( !XMLResultError(eResult, false)) {
 
@@ -116,7 +116,7 @@ void SessionCreator::load(const std::string& filename)
     }
 
     // Load XML document
-    XMLError eResult = xmlDoc_.LoadFile(filename.c_str());
+    int eResult = XMLLoadDoc(&xmlDoc_, filename);
     if ( XMLResultError(eResult)){
         Log::Warning("%s could not be opened.\n%s", filename.c_str(), xmlDoc_.ErrorStr());
         return;
@@ -180,10 +180,11 @@ void SessionCreator::load(const std::string& filename)
     // thumbnail
     const XMLElement *thumbnailelement = sessionNode->FirstChildElement("Thumbnail");
     // if there is a user-defined thumbnail, get it
+    // (keep the encoded image, decoded when needed)
     if (thumbnailelement) {
-        FrameBufferImage *thumbnail = XMLToImage(thumbnailelement);
-        if (thumbnail != nullptr)
-            session_->setThumbnail( thumbnail );
+        XMLDocument *thumbnail = new XMLDocument;
+        thumbnail->InsertEndChild( thumbnailelement->DeepClone(thumbnail) );
+        session_->setThumbnail( thumbnail );
     }
 
     // all good
@@ -375,7 +376,7 @@ std::list< SourceList > SessionLoader::getMixingGroups() const
     return groups_new_sources_id;
 }
 
-void SessionLoader::load(XMLElement *sessionNode)
+void SessionLoader::load(XMLElement *sessionNode, const SourceIdList &unchanged)
 {
     sources_id_.clear();
 
@@ -467,6 +468,12 @@ void SessionLoader::load(XMLElement *sessionNode)
                 // add source to session
                 session_->addSource(load_source);
             }
+            // existing source is unchanged: only read its mixing group
+            else if ( std::find(unchanged.begin(), unchanged.end(), id_xml_) != unchanged.end() ) {
+                loadMixingGroup(xmlCurrent_);
+                sources_id_[id_xml_] = *sit;
+                continue;
+            }
             // get reference to the existing source
             else
                 load_source = *sit;
@@ -560,6 +567,21 @@ void SessionLoader::load(XMLElement *sessionNode)
 }
 
 
+void SessionLoader::loadMixingGroup(XMLElement *sourceNode)
+{
+    XMLElement* groupNode = sourceNode->FirstChildElement("MixingGroup");
+    if (groupNode) {
+        SourceIdList idlist;
+        XMLElement* mixingSourceNode = groupNode->FirstChildElement("source");
+        for ( ; mixingSourceNode ; mixingSourceNode = mixingSourceNode->NextSiblingElement()) {
+            uint64_t id__ = 0;
+            mixingSourceNode->QueryUnsigned64Attribute("id", &id__);
+            idlist.push_back(id__);
+        }
+        groups_sources_id_.push_back(idlist);
+    }
+}
+
 Source *SessionLoader::recreateSource(Source *s)
 {
     if ( s == nullptr || session_ == nullptr )
@@ -1091,17 +1113,7 @@ void SessionLoader::visit (Source& s)
         s.processingshader_link_.connect(id__, session_);
     }
 
-    xmlCurrent_ = sourceNode->FirstChildElement("MixingGroup");
-    if (xmlCurrent_) {
-        SourceIdList idlist;
-        XMLElement* mixingSourceNode = xmlCurrent_->FirstChildElement("source");
-        for ( ; mixingSourceNode ; mixingSourceNode = mixingSourceNode->NextSiblingElement()) {
-            uint64_t id__ = 0;
-            mixingSourceNode->QueryUnsigned64Attribute("id", &id__);
-            idlist.push_back(id__);
-        }
-        groups_sources_id_.push_back(idlist);
-    }
+    loadMixingGroup(sourceNode);
 
     xmlCurrent_ = sourceNode->FirstChildElement("Audio");
     if (xmlCurrent_) {
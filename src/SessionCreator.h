@@ -19,7 +19,7 @@ public:
     SessionLoader(Session *session = nullptr, uint level = 0);
     inline Session *session() const { return session_; }
 
-    void load(tinyxml2::XMLElement *sessionNode);
+    void load(tinyxml2::XMLElement *sessionNode, const SourceIdList &unchanged = SourceIdList());
     std::map< uint64_t, Source* > getSources() const;
     std::list< SourceList > getMixingGroups() const;
 
@@ -109,6 +109,7 @@ protected:
     std::map< uint64_t, Source* > sources_id_;
     // list of groups (lists of xml source id)
     std::list< SourceIdList > groups_sources_id_;
+    void loadMixingGroup(tinyxml2::XMLElement *sourceNode);
 
 };
 
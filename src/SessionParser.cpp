@@ -24,7 +24,7 @@ using namespace tinyxml2;
 
 #include "SessionParser.h"
 
-SessionParser::SessionParser()
+SessionParser::SessionParser() : binary_(false)
 {
 
 }
@@ -37,7 +37,7 @@ bool SessionParser::open(const std::string &filename)
 
     // try to load the file
     xmlDoc_.Clear();
-    XMLError eResult = xmlDoc_.LoadFile(filename.c_str());
+    int eResult = XMLLoadDoc(&xmlDoc_, filename, &binary_);
 
     // error
     if ( XMLResultError(eResult, false) )
@@ -53,7 +53,7 @@ bool SessionParser::save()
         return false;
 
     // save file to disk
-    return ( XMLSaveDoc(&xmlDoc_, filename_) );
+    return ( XMLSaveDoc(&xmlDoc_, filename_, binary_) );
 }
 
 std::map< uint64_t, std::pair<std::string, bool> > SessionParser::pathList() const
@@ -35,6 +35,7 @@ public:
 private:
     tinyxml2::XMLDocument xmlDoc_;
     std::string filename_;
+    bool binary_;
 };
 
 #endif // SESSIONPARSER_H
@@ -48,6 +48,7 @@ using namespace tinyxml2;
 #include "MediaPlayer.h"
 #include "MixingGroup.h"
 #include "SystemToolkit.h"
+#include "Settings.h"
 
 #include "SessionVisitor.h"
 
@@ -119,7 +120,7 @@ bool SessionVisitor::saveSession(const std::string& filename, Session *session)
     saveInputCallbacks( &xmlDoc, session );
 
     // save file to disk
-    return ( XMLSaveDoc(&xmlDoc, filename) );
+    return ( XMLSaveDoc(&xmlDoc, filename, Settings::application.save_binary) );
 }
 
 void SessionVisitor::saveConfig(tinyxml2::XMLDocument *doc, Session *session)
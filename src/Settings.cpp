@@ -128,7 +128,10 @@ void Settings::Save(uint64_t runtime, const std::string &filename)
     applicationNode->SetAttribute("accent_color", application.accent_color);
     applicationNode->SetAttribute("smooth_transition", application.smooth_transition);
     applicationNode->SetAttribute("save_snapshot", application.save_version_snapshot);
+    applicationNode->SetAttribute("save_binary", application.save_binary);
     applicationNode->SetAttribute("action_history_follow_view", application.action_history_follow_view);
+    applicationNode->SetAttribute("action_history_memory", application.action_history_memory);
+    applicationNode->SetAttribute("action_history_coalesce", application.action_history_coalesce);
     applicationNode->SetAttribute("show_tooptips", application.show_tooptips);
     applicationNode->SetAttribute("accept_connections", application.accept_connections);
     applicationNode->SetAttribute("pannel_main_mode", application.pannel_main_mode);
@@ -172,6 +175,11 @@ void Settings::Save(uint64_t runtime, const std::string &filename)
     RenderNode->SetAttribute("vsync", application.render.vsync);
     RenderNode->SetAttribute("multisampling", application.render.multisampling);
     RenderNode->SetAttribute("gpu_decoding", application.render.gpu_decoding);
+    RenderNode->SetAttribute("yuv_texturing", application.render.yuv_texturing);
+    RenderNode->SetAttribute("delay_memory", application.render.delay_memory);
+    RenderNode->SetAttribute("delay_compression", application.render.delay_compression);
+    RenderNode->SetAttribute("shared_decoding", application.render.shared_decoding);
+    RenderNode->SetAttribute("gpu_patterns", application.render.gpu_patterns);
     RenderNode->SetAttribute("ratio", application.render.ratio);
     RenderNode->SetAttribute("res", application.render.res);
     RenderNode->SetAttribute("custom_width", application.render.custom_width);
@@ -189,6 +197,8 @@ void Settings::Save(uint64_t runtime, const std::string &filename)
     RecordNode->SetAttribute("priority_mode", application.record.priority_mode);
     RecordNode->SetAttribute("naming_mode", application.record.naming_mode);
     RecordNode->SetAttribute("audio_device", application.record.audio_device.c_str());
+    RecordNode->SetAttribute("gpu_conversion", application.record.gpu_conversion);
+    RecordNode->SetAttribute("shared_encoding", application.record.shared_encoding);
     pRoot->InsertEndChild(RecordNode);
 
     // Image sequence
@@ -449,7 +459,10 @@ void Settings::Load(const std::string &filename)
             applicationNode->QueryIntAttribute("accent_color", &application.accent_color);
             applicationNode->QueryBoolAttribute("smooth_transition", &application.smooth_transition);
             applicationNode->QueryBoolAttribute("save_snapshot", &application.save_version_snapshot);
+            applicationNode->QueryBoolAttribute("save_binary", &application.save_binary);
             applicationNode->QueryBoolAttribute("action_history_follow_view", &application.action_history_follow_view);
+            applicationNode->QueryIntAttribute("action_history_memory", &application.action_history_memory);
+            applicationNode->QueryIntAttribute("action_history_coalesce", &application.action_history_coalesce);
             applicationNode->QueryBoolAttribute("show_tooptips", &application.show_tooptips);
             applicationNode->QueryBoolAttribute("accept_connections", &application.accept_connections);
             applicationNode->QueryBoolAttribute("pannel_always_visible", &application.pannel_always_visible);
@@ -499,6 +512,11 @@ void Settings::Load(const std::string &filename)
             rendernode->QueryIntAttribute("vsync", &application.render.vsync);
             rendernode->QueryIntAttribute("multisampling", &application.render.multisampling);
             rendernode->QueryBoolAttribute("gpu_decoding", &application.render.gpu_decoding);
+            rendernode->QueryBoolAttribute("yuv_texturing", &application.render.yuv_texturing);
+            rendernode->QueryIntAttribute("delay_memory", &application.render.delay_memory);
+            rendernode->QueryBoolAttribute("delay_compression", &application.render.delay_compression);
+            rendernode->QueryBoolAttribute("shared_decoding", &application.render.shared_decoding);
+            rendernode->QueryBoolAttribute("gpu_patterns", &application.render.gpu_patterns);
             rendernode->QueryIntAttribute("ratio", &application.render.ratio);
             rendernode->QueryIntAttribute("res", &application.render.res);
             rendernode->QueryIntAttribute("custom_width", &application.render.custom_width);
@@ -515,6 +533,8 @@ void Settings::Load(const std::string &filename)
             recordnode->QueryIntAttribute("buffering_mode", &application.record.buffering_mode);
             recordnode->QueryIntAttribute("priority_mode", &application.record.priority_mode);
             recordnode->QueryIntAttribute("naming_mode", &application.record.naming_mode);
+            recordnode->QueryBoolAttribute("gpu_conversion", &application.record.gpu_conversion);
+            recordnode->QueryBoolAttribute("shared_encoding", &application.record.shared_encoding);
 
             const char *path_ = recordnode->Attribute("path");
             if (path_)
@@ -109,6 +109,8 @@ struct RecordConfig
     int priority_mode;
     int naming_mode;
     std::string audio_device;
+    bool gpu_conversion;
+    bool shared_encoding;
 
     RecordConfig() : path("") {
         profile = 0;
@@ -119,6 +121,8 @@ struct RecordConfig
         priority_mode = 1;
         naming_mode = 1;
         audio_device = "";
+        gpu_conversion = false;
+        shared_encoding = true;
     }
 
 };
@@ -183,6 +187,11 @@ struct RenderConfig
     float fading;
     bool gpu_decoding;
     bool gpu_decoding_available;
+    bool yuv_texturing;
+    int delay_memory;
+    bool delay_compression;
+    bool shared_decoding;
+    bool gpu_patterns;
 
     RenderConfig() {
         disabled = false;
@@ -195,6 +204,11 @@ struct RenderConfig
         fading = 0.0;
         gpu_decoding = true;
         gpu_decoding_available = false;
+        yuv_texturing = false;
+        delay_memory = 2048;
+        delay_compression = true;
+        shared_decoding = true;
+        gpu_patterns = true;
     }
 };
 
@@ -275,12 +289,15 @@ struct Application
     float scale;
     int  accent_color;
     bool save_version_snapshot;
+    bool save_binary;
     bool smooth_transition;
     bool proportional_grid;
     int  mouse_pointer;
     bool mouse_pointer_lock;
     std::vector<float> mouse_pointer_strength;
     bool action_history_follow_view;
+    int  action_history_memory;
+    int  action_history_coalesce;
     bool show_tooptips;
 
     int  pannel_main_mode;
@@ -353,11 +370,14 @@ struct Application
         accent_color = 0;
         smooth_transition = true;
         save_version_snapshot = false;
+        save_binary = false;
         proportional_grid = true;
         mouse_pointer = 1;
         mouse_pointer_lock = false;
         mouse_pointer_strength = {0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f};
         action_history_follow_view = false;
+        action_history_memory = 64;
+        action_history_coalesce = 800;
         show_tooptips = true;
         accept_connections = false;
         stream_protocol = 0;
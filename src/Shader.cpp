@@ -19,6 +19,8 @@
 
 #include <regex>
 #include <ctime>
+#include <cstring>
+#include <fstream>
 
 #include <glad/glad.h> 
 #include <GLFW/glfw3.h>
@@ -29,6 +31,7 @@
 #include "Log.h"
 #include "Visitor.h"
 #include "BaseToolkit.h"
+#include "SystemToolkit.h"
 #include "RenderingManager.h"
 
 #include "Shader.h"
@@ -39,6 +42,7 @@
 
 // Globals
 ShadingProgram *ShadingProgram::currentProgram_ = nullptr;
+std::atomic<uint> ShadingProgram::uniform_calls_(0);
 ShadingProgram simpleShadingProgram("shaders/simple.vs", "shaders/simple.fs");
 ShadingProgram textureShadingProgram("shaders/texture.vs", "shaders/texture.fs");
 
@@ -71,11 +75,182 @@ GLenum blending_destination_function[9] = {GL_ONE_MINUS_SRC_ALPHA,// normal
                                            GL_ONE,   // lighten only
                                            GL_ZERO};
 
+// cache of GLSL program binaries in settings directory
+#define SHADER_CACHE_DIR "shaders"
+#define SHADER_CACHE_MAGIC 0x564D5342 // 'VMSB'
+#define SHADER_CACHE_MAX_FILES 256
+
+// (never deleted: static ShadingProgram release their programs at exit)
+std::unordered_map<uint64_t, ShadingProgram::Program *> &ShadingProgram::programs_ = *new std::unordered_map<uint64_t, ShadingProgram::Program *>;
+
+// true if programs binaries can be retreived and loaded (OpenGL 4.1)
+static bool program_binary_available()
+{
+    static int _available = -1;
+    if (_available < 0) {
+        GLint formats = 0;
+        if (GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_get_program_binary)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        _available = formats > 0 ? 1 : 0;
+    }
+    return _available > 0;
+}
+
+// true while the OpenGL context exists (see ShadingProgram::initialize and terminate)
+static bool _context = false;
+
+// true if the driver compiles programs in its own threads
+static bool _parallel_compile = false;
+static bool parallel_compile_available()
+{
+    return _parallel_compile;
+}
+
+void ShadingProgram::initialize()
+{
+    _context = true;
+    _parallel_compile = false;
+    if (GLAD_GL_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        _parallel_compile = true;
+    }
+    else if (GLAD_GL_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+        _parallel_compile = true;
+    }
+}
+
+void ShadingProgram::terminate()
+{
+    // programs are deleted with the context
+    _context = false;
+}
+
+// FNV-1a hash of program code, specific to the OpenGL driver
+static uint64_t program_key(const std::string& vertex_code, const std::string& fragment_code)
+{
+    static std::string driver;
+    if (driver.empty()) {
+        const GLubyte *s = nullptr;
+        if ( (s = glGetString(GL_VENDOR)) )   driver += (const char *) s;
+        if ( (s = glGetString(GL_RENDERER)) ) driver += (const char *) s;
+        if ( (s = glGetString(GL_VERSION)) )  driver += (const char *) s;
+    }
+
+    uint64_t h = 0xcbf29ce484222325ULL;
+    const std::string *codes[3] = { &driver, &vertex_code, &fragment_code };
+    for (const std::string *s : codes) {
+        for (auto c = s->cbegin(); c != s->cend(); ++c) {
+            h ^= (unsigned char) *c;
+            h *= 0x100000001b3ULL;
+        }
+        h ^= 0xff;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static std::string program_binary_filename(uint64_t key)
+{
+    static std::string path;
+    if (path.empty()) {
+        path = SystemToolkit::full_filename(SystemToolkit::settings_path(), SHADER_CACHE_DIR);
+        if ( !SystemToolkit::create_directory(path) )
+            Log::Info("Could not create shader cache %s", path.c_str());
+    }
+
+    char name[32];
+    snprintf(name, 32, "%016llx.bin", (unsigned long long) key);
+    return SystemToolkit::full_filename(path, name);
+}
+
+static GLuint load_program_binary(uint64_t key)
+{
+    if (!program_binary_available())
+        return 0;
+
+    std::string filename = program_binary_filename(key);
+    std::ifstream in(filename, std::ios::binary);
+    if ( !in.is_open() )
+        return 0;
+
+    uint32_t header[3] = {0, 0, 0};
+    in.read( reinterpret_cast<char *>(header), sizeof(header) );
+    if ( !in.good() || header[0] != SHADER_CACHE_MAGIC || header[2] < 1 || header[2] > 0x4000000)
+        return 0;
+
+    std::vector<char> binary(header[2]);
+    in.read( binary.data(), header[2] );
+    if ( !in.good() )
+        return 0;
+
+    // load binary, which fails if the driver changed
+    GLuint id = glCreateProgram();
+    glProgramBinary(id, (GLenum) header[1], binary.data(), (GLsizei) header[2]);
+    GLint success = GL_FALSE;
+    glGetProgramiv(id, GL_LINK_STATUS, &success);
+    if (!success) {
+        glDeleteProgram(id);
+        SystemToolkit::remove_file(filename);
+        return 0;
+    }
+
+    return id;
+}
+
+static void save_program_binary(uint64_t key, GLuint id)
+{
+    if (!program_binary_available())
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length < 1)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(id, length, NULL, &format, binary.data());
+
+    std::string filename = program_binary_filename(key);
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if ( !out.is_open() )
+        return;
+    uint32_t header[3] = { SHADER_CACHE_MAGIC, (uint32_t) format, (uint32_t) length };
+    out.write( reinterpret_cast<const char *>(header), sizeof(header) );
+    out.write( binary.data(), length );
+    out.close();
+
+    // limit the size of cache: remove oldest files
+    std::list<std::string> files = SystemToolkit::list_directory( SystemToolkit::path_filename(filename),
+                                                                   { "*.bin" }, SystemToolkit::DATE );
+    while (files.size() > SHADER_CACHE_MAX_FILES) {
+        SystemToolkit::remove_file( files.front() );
+        files.pop_front();
+    }
+}
+
 ShadingProgram::ShadingProgram(const std::string& vertex, const std::string& fragment) :
-    id_(0), need_compile_(true), lineshift_(0), vertex_(vertex), fragment_(fragment), promise_(nullptr)
+    id_(0), need_compile_(true), lineshift_(0), vertex_(vertex), fragment_(fragment), promise_(nullptr),
+    program_(nullptr), pending_(nullptr)
 {
 }
 
+ShadingProgram::ShadingProgram(const ShadingProgram &other) :
+    id_(0), need_compile_(true), lineshift_(other.lineshift_), vertex_(other.vertex_), fragment_(other.fragment_),
+    promise_(nullptr), program_(nullptr), pending_(nullptr)
+{
+}
+
+ShadingProgram::~ShadingProgram()
+{
+    // NB: deleting a program in use is deferred by OpenGL
+    if (currentProgram_ == this)
+        currentProgram_ = nullptr;
+    release(pending_);
+    release(program_);
+}
+
 void ShadingProgram::setShaders(const std::string& vertex, const std::string& fragment, int lineshift,  std::promise<std::string> *prom)
 {
     vertex_ = vertex;
@@ -85,12 +260,149 @@ void ShadingProgram::setShaders(const std::string& vertex, const std::string& fr
     need_compile_ = true;
 }
 
-void ShadingProgram::compile()
+ShadingProgram::Program *ShadingProgram::acquire(const std::string& vertex_code, const std::string& fragment_code)
+{
+    uint64_t key = program_key(vertex_code, fragment_code);
+
+    // share program already compiled from the same code
+    auto it = programs_.find(key);
+    if ( it != programs_.end() ) {
+        it->second->references++;
+        return it->second;
+    }
+
+    Program *p = new Program;
+    p->key = key;
+    programs_[key] = p;
+
+    // try to load program from binary cache
+    p->id = load_program_binary(key);
+    if (p->id != 0) {
+#ifdef SHADER_DEBUG
+        g_printerr("Loaded GLSL Program %d from cache\n", p->id);
+#endif
+        return p;
+    }
+
+    // VERTEX SHADER
+    const char* vcode = vertex_code.c_str();
+    p->shaders[0] = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(p->shaders[0], 1, &vcode, NULL);
+    glCompileShader(p->shaders[0]);
+
+    // FRAGMENT SHADER
+    const char* fcode = fragment_code.c_str();
+    p->shaders[1] = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(p->shaders[1], 1, &fcode, NULL);
+    glCompileShader(p->shaders[1]);
+
+    // LINK PROGRAM
+    // NB: status is not queried to let the driver compile in parallel
+    p->id = glCreateProgram();
+    glAttachShader(p->id, p->shaders[0]);
+    glAttachShader(p->id, p->shaders[1]);
+    if (program_binary_available())
+        glProgramParameteri(p->id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(p->id);
+
+    return p;
+}
+
+void ShadingProgram::release(Program *p)
+{
+    if (p == nullptr || --(p->references) > 0)
+        return;
+
+#ifdef SHADER_DEBUG
+    g_printerr("Delete GLSL Program %d \n", p->id);
+#endif
+    if (_context) {
+        if (p->shaders[0] != 0) {
+            glDeleteShader(p->shaders[0]);
+            glDeleteShader(p->shaders[1]);
+        }
+        if (p->id != 0)
+            glDeleteProgram(p->id);
+    }
+
+    programs_.erase(p->key);
+    delete p;
+}
+
+bool ShadingProgram::link(Program *p, bool wait)
 {
+    if (p->linked)
+        return true;
+
+    // wait for the end of parallel compilation (querying the status would block)
+    if (!wait && parallel_compile_available() && p->shaders[0] != 0) {
+        GLint done = GL_FALSE;
+        glGetProgramiv(p->id, GL_COMPLETION_STATUS_KHR, &done);
+        if (!done)
+            return false;
+    }
+
     char infoLog[1024];
     infoLog[0] = '\0';
     int success = GL_FALSE;
 
+    // program compiled from source
+    if (p->shaders[0] != 0) {
+
+        glGetShaderiv(p->shaders[0], GL_COMPILE_STATUS, &success);
+        if (!success)
+            glGetShaderInfoLog(p->shaders[0], 1024, NULL, infoLog);
+        else {
+            glGetShaderiv(p->shaders[1], GL_COMPILE_STATUS, &success);
+            if (!success)
+                glGetShaderInfoLog(p->shaders[1], 1024, NULL, infoLog);
+            else {
+                glGetProgramiv(p->id, GL_LINK_STATUS, &success);
+                if (!success)
+                    glGetProgramInfoLog(p->id, 1024, NULL, infoLog);
+            }
+        }
+
+        // done (no more need for shaders)
+        glDeleteShader(p->shaders[0]);
+        glDeleteShader(p->shaders[1]);
+        p->shaders[0] = p->shaders[1] = 0;
+
+        // store binary for next time
+        if (success)
+            save_program_binary(p->key, p->id);
+    }
+    // program loaded from binary cache
+    else
+        success = p->id != 0;
+
+    if (success) {
+        // all good, set default uniforms
+        glUseProgram(p->id);
+        glUniform1i(glGetUniformLocation(p->id, "iChannel0"), 0);
+        glUniform1i(glGetUniformLocation(p->id, "iChannel1"), 1);
+        // get location of all uniforms
+        resolveUniforms(p);
+        glUseProgram(0);
+        currentProgram_ = nullptr;
+#ifdef SHADER_DEBUG
+        g_printerr("New GLSL Program %d \n", p->id);
+#endif
+    }
+    else {
+        glDeleteProgram(p->id);
+        p->id = 0;
+    }
+
+    p->success = success;
+    p->log = std::string(infoLog);
+    p->linked = true;
+
+    return true;
+}
+
+void ShadingProgram::compile()
+{
     std::string vertex_code = vertex_;
     if (Resource::hasPath(vertex_))
         vertex_code = Resource::getText(vertex_);
@@ -98,69 +410,31 @@ void ShadingProgram::compile()
     if (Resource::hasPath(fragment_))
         fragment_code = Resource::getText(fragment_);
 
-    // VERTEX SHADER
-    const char* vcode = vertex_code.c_str();
-    unsigned int vertex_id_ = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex_id_, 1, &vcode, NULL);
-    glCompileShader(vertex_id_);
+    // replace program being compiled, if any
+    release(pending_);
+    pending_ = acquire(vertex_code, fragment_code);
 
-    glGetShaderiv(vertex_id_, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(vertex_id_, 1024, NULL, infoLog);
-    }
-    else {
-        // FRAGMENT SHADER
-        const char* fcode = fragment_code.c_str();
-        unsigned int fragment_id_ = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment_id_, 1, &fcode, NULL);
-        glCompileShader(fragment_id_);
-
-        glGetShaderiv(fragment_id_, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            glGetShaderInfoLog(fragment_id_, 1024, NULL, infoLog);
-            glDeleteShader(vertex_id_);
-        }
-        else {
-            // LINK PROGRAM
-
-            // create new GL Program
-            if (id_ != 0)
-                glDeleteProgram(id_);
-            id_ = glCreateProgram();
-
-            // attach shaders and link
-            glAttachShader(id_, vertex_id_);
-            glAttachShader(id_, fragment_id_);
-            glLinkProgram(id_);
-
-            glGetProgramiv(id_, GL_LINK_STATUS, &success);
-            if (!success) {
-                glGetProgramInfoLog(id_, 1024, NULL, infoLog);
-                glDeleteProgram(id_);
-                id_ = 0;
-            }
-            else {
-                // all good, set default uniforms
-                glUseProgram(id_);
-                glUniform1i(glGetUniformLocation(id_, "iChannel0"), 0);
-                glUniform1i(glGetUniformLocation(id_, "iChannel1"), 1);
-#ifdef SHADER_DEBUG
-                g_printerr("New GLSL Program %d \n", id_);
-#endif
-            }
+    // do not compile indefinitely
+    need_compile_ = false;
 
-            // done (no more need for shaders)
-            glUseProgram(0);
-            glDeleteShader(vertex_id_);
-            glDeleteShader(fragment_id_);
-        }
-    }
+    // without parallel compilation, this waits for the end of compilation
+    finish();
+}
+
+bool ShadingProgram::finish(bool wait)
+{
+    if (pending_ == nullptr)
+        return true;
+
+    // compilation not finished
+    if ( !link(pending_, wait) )
+        return false;
 
     std::string message;
 
     // if a lineshift was given, fix the line numbers in info log string
     if (lineshift_ > 0) {
-        std::string s(infoLog);
+        std::string s(pending_->log);
         std::smatch m;
 #ifdef APPLE
         std::regex e("0\\:[[:digit:]]+");
@@ -181,26 +455,46 @@ void ShadingProgram::compile()
     }
     // default is to use info log message
     else
-        message = std::string(infoLog);
+        message = pending_->log;
 
     // always fulfill a promise
-    if (promise_)
-        promise_->set_value( success ? "Ok" : "Error\n" + message );
+    if (promise_) {
+        promise_->set_value( pending_->success ? "Ok" : "Error\n" + message );
+        promise_ = nullptr;
+    }
     // if not asked to return a promise, inform user through logs
-    else if (!success)
+    else if (!pending_->success)
         Log::Warning("Error compiling Vertex ShadingProgram:\n%s", message.c_str());
 
-    // do not compile indefinitely
-    need_compile_ = false;
+    // use the new program, or keep the previous one on failure
+    if (pending_->success) {
+        release(program_);
+        program_ = pending_;
+    }
+    else
+        release(pending_);
+    pending_ = nullptr;
+
+    id_ = program_ ? program_->id : 0;
+    if (currentProgram_ == this)
+        currentProgram_ = nullptr;
+
+    return true;
 }
 
 void ShadingProgram::use()
 {
+    // first time use ; compile
+    if (need_compile_)
+        compile();
+
+    // end of compilation replaces program
+    // (block on the first compilation: there is no program to use meanwhile)
+    if (pending_ != nullptr)
+        finish(program_ == nullptr);
+
     if (currentProgram_ == nullptr || currentProgram_ != this)
     {
-        // first time use ; compile
-        if (need_compile_)
-            compile();
         // use program
         glUseProgram(id_);  // NB: if not linked, use 0 as default
         // remember (avoid switching program)
@@ -216,99 +510,147 @@ void ShadingProgram::enduse()
 
 void ShadingProgram::reset()
 {
-    if (id_ != 0) {
-#ifdef SHADER_DEBUG
-        g_printerr("Delete GLSL Program %d \n", id_);
-#endif
-        glDeleteProgram(id_);
-        id_ = 0;
-    }
+    release(pending_);
+    pending_ = nullptr;
+    release(program_);
+    program_ = nullptr;
+    id_ = 0;
     ShadingProgram::enduse();
 }
 
+void ShadingProgram::resolveUniforms(Program *p)
+{
+    p->uniforms.clear();
+
+    GLint count = 0;
+    glGetProgramiv(p->id, GL_ACTIVE_UNIFORMS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        char name[256];
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(p->id, (GLuint) i, 256, NULL, &size, &type, name);
+
+        std::string n(name);
+        GLint location = glGetUniformLocation(p->id, name);
+        if (location < 0)
+            continue;
+
+        // arrays are named 'name[0]' : give location of each element
+        size_t bracket = n.find('[');
+        if (bracket != std::string::npos) {
+            n = n.substr(0, bracket);
+            for (GLint e = 1; e < size; ++e) {
+                std::string element = n + "[" + std::to_string(e) + "]";
+                p->uniforms[element] = Uniform( glGetUniformLocation(p->id, element.c_str()) );
+            }
+            p->uniforms[n + "[0]"] = Uniform(location);
+        }
+        p->uniforms[n] = Uniform(location);
+    }
+}
+
+ShadingProgram::Uniform *ShadingProgram::uniform(const std::string& name)
+{
+    if (program_ == nullptr)
+        return nullptr;
+
+    auto u = program_->uniforms.find(name);
+    if (u == program_->uniforms.end() || u->second.location < 0)
+        return nullptr;
+    return &(u->second);
+}
+
+bool ShadingProgram::Uniform::changed(const void *v, size_t s)
+{
+    if (s == size && memcmp(value, v, s) == 0)
+        return false;
+
+    // remember value uploaded
+    size = s;
+    memcpy(value, v, s);
+    ++uniform_calls_;
+    return true;
+}
+
 template<>
 bool ShadingProgram::setUniform<int>(const std::string &name, int val)
 {
-    GLint uid = glGetUniformLocation(id_, name.c_str());
-    if (uid < 0)
-        return false;
-    glUniform1i(uid, val);
+    Uniform *u = uniform(name);
+    if (u == nullptr)
+        return pending_ != nullptr;
+    if (u->changed(&val, sizeof(val)))
+        glUniform1i(u->location, val);
     return true;
 }
 
 template<>
 bool ShadingProgram::setUniform<bool>(const std::string& name, bool val) {
-    GLint uid = glGetUniformLocation(id_, name.c_str());
-    if (uid < 0)
-        return false;
-    glUniform1i(uid, val);
+    Uniform *u = uniform(name);
+    if (u == nullptr)
+        return pending_ != nullptr;
+    int v = val;
+    if (u->changed(&v, sizeof(v)))
+        glUniform1i(u->location, v);
     return true;
 }
 
 template<>
 bool ShadingProgram::setUniform<float>(const std::string& name, float val) {
-    GLint uid = glGetUniformLocation(id_, name.c_str());
-    if (uid < 0)
-        return false;
-    glUniform1f(uid, val);
+    Uniform *u = uniform(name);
+    if (u == nullptr)
+        return pending_ != nullptr;
+    if (u->changed(&val, sizeof(val)))
+        glUniform1f(u->location, val);
     return true;
 }
 
 template<>
-bool ShadingProgram::setUniform<float>(const std::string& name, float val1, float val2) {
-    GLint uid = glGetUniformLocation(id_, name.c_str());
-    if (uid < 0)
-        return false;
-    glUniform2f(uid, val1, val2);
+bool ShadingProgram::setUniform<glm::vec2>(const std::string& name, glm::vec2 val) {
+    Uniform *u = uniform(name);
+    if (u == nullptr)
+        return pending_ != nullptr;
+    if (u->changed(glm::value_ptr(val), sizeof(val)))
+        glUniform2fv(u->location, 1, glm::value_ptr(val));
     return true;
 }
 
 template<>
-bool ShadingProgram::setUniform<float>(const std::string& name, float val1, float val2, float val3) {
-    GLint uid = glGetUniformLocation(id_, name.c_str());
-    if (uid < 0)
-        return false;
-    glUniform3f(uid, val1, val2, val3);
+bool ShadingProgram::setUniform<glm::vec3>(const std::string& name, glm::vec3 val) {
+    Uniform *u = uniform(name);
+    if (u == nullptr)
+        return pending_ != nullptr;
+    if (u->changed(glm::value_ptr(val), sizeof(val)))
+        glUniform3fv(u->location, 1, glm::value_ptr(val));
     return true;
 }
 
 template<>
-bool ShadingProgram::setUniform<glm::vec2>(const std::string& name, glm::vec2 val) {
-    glm::vec2 v(val);
-    GLint uid = glGetUniformLocation(id_, name.c_str());
-    if (uid < 0)
-        return false;
-    glUniform2fv(uid, 1, glm::value_ptr(v));
-    return true;
+bool ShadingProgram::setUniform<float>(const std::string& name, float val1, float val2) {
+    return setUniform(name, glm::vec2(val1, val2));
 }
 
 template<>
-bool ShadingProgram::setUniform<glm::vec3>(const std::string& name, glm::vec3 val) {
-    glm::vec3 v(val);
-    GLint uid = glGetUniformLocation(id_, name.c_str());
-    if (uid < 0)
-        return false;
-    glUniform3fv(uid, 1, glm::value_ptr(v));
-    return true;
+bool ShadingProgram::setUniform<float>(const std::string& name, float val1, float val2, float val3) {
+    return setUniform(name, glm::vec3(val1, val2, val3));
 }
 
 template<>
 bool ShadingProgram::setUniform<glm::vec4>(const std::string& name, glm::vec4 val) {
-    glm::vec4 v(val);
-    GLint uid = glGetUniformLocation(id_, name.c_str());
-    if (uid < 0)
-        return false;
-    glUniform4fv(uid, 1, glm::value_ptr(v));
+    Uniform *u = uniform(name);
+    if (u == nullptr)
+        return pending_ != nullptr;
+    if (u->changed(glm::value_ptr(val), sizeof(val)))
+        glUniform4fv(u->location, 1, glm::value_ptr(val));
     return true;
 }
 
 template<>
 bool ShadingProgram::setUniform<glm::mat4>(const std::string& name, glm::mat4 val) {
-    glm::mat4 m(val);
-    GLint uid = glGetUniformLocation(id_, name.c_str());
-    if (uid < 0)
-        return false;
-    glUniformMatrix4fv(uid, 1, GL_FALSE, glm::value_ptr(m));
+    Uniform *u = uniform(name);
+    if (u == nullptr)
+        return pending_ != nullptr;
+    if (u->changed(glm::value_ptr(val), sizeof(val)))
+        glUniformMatrix4fv(u->location, 1, GL_FALSE, glm::value_ptr(val));
     return true;
 }
 
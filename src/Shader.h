@@ -1,9 +1,11 @@
 #ifndef __SHADER_H_
 #define __SHADER_H_
 
+#include <atomic>
 #include <future>
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include <glm/glm.hpp>
 
 // Forward declare classes referenced
@@ -15,6 +17,14 @@ class ShadingProgram
 public:
     // create GLSL Program from resource file (if exist) or code of vertex and fragment shaders
     ShadingProgram(const std::string& vertex = "", const std::string& fragment = "");
+    // a copy compiles the same code (it does not share the program)
+    ShadingProgram(const ShadingProgram &other);
+    ShadingProgram& operator=(const ShadingProgram &) = delete;
+    ~ShadingProgram();
+
+    // get capabilities of the OpenGL context once created, and forget it before destroyed
+    static void initialize();
+    static void terminate();
 
     // Update GLSL Program with vertex and fragment program
     // If a promise is given, it is filled during compilation with the compilation log.
@@ -25,10 +35,18 @@ public:
     static void enduse();
     void reset();
 
+    // true while the program is waiting for compilation
+    inline bool compiling() const { return need_compile_ || pending_ != nullptr; }
+    // true if a program is linked and can be used
+    inline bool linked() const { return id_ != 0; }
+
     template<typename T> bool setUniform(const std::string& name, T val);
     template<typename T> bool setUniform(const std::string& name, T val1, T val2);
     template<typename T> bool setUniform(const std::string& name, T val1, T val2, T val3);
 
+    // count of glUniform calls (unchanged values are not uploaded)
+    static std::atomic<uint> uniform_calls_;
+
 private:
     unsigned int id_;
     bool need_compile_;
@@ -37,6 +55,40 @@ private:
     std::string fragment_;
     std::promise<std::string> *promise_;
 
+    // locations of active uniforms, resolved at link time,
+    // with the last value uploaded to each of them
+    struct Uniform {
+        int location;
+        size_t size;
+        unsigned char value[sizeof(glm::mat4)];
+        Uniform(int l = -1) : location(l), size(0) {}
+        bool changed(const void *v, size_t s);
+    };
+    Uniform *uniform(const std::string& name);
+
+    // GL program linked from a vertex and a fragment code, shared by
+    // all ShadingProgram with the same code, and stored in binary cache
+    struct Program {
+        unsigned int id;
+        unsigned int shaders[2];
+        uint64_t key;
+        uint references;
+        bool linked;
+        bool success;
+        std::string log;
+        std::unordered_map<std::string, Uniform> uniforms;
+        Program() : id(0), key(0), references(1), linked(false), success(false) { shaders[0] = shaders[1] = 0; }
+    };
+    Program *program_;
+    Program *pending_;
+    bool finish(bool wait = false);
+
+    static std::unordered_map<uint64_t, Program *> &programs_;
+    static Program *acquire(const std::string& vertex_code, const std::string& fragment_code);
+    static void release(Program *p);
+    static bool link(Program *p, bool wait = false);
+    static void resolveUniforms(Program *p);
+
     static ShadingProgram *currentProgram_;
 };
 
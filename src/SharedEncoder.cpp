@@ -0,0 +1,362 @@
+/*
+ * This file is part of vimix - video live mixer
+ *
+ * **Copyright** (C) 2019-2023 Bruno Herbelin <bruno.herbelin@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+**/
+
+
+#include <vector>
+
+// gstreamer
+#include <gst/gstformat.h>
+#include <gst/video/video.h>
+
+#include "Log.h"
+#include "GstToolkit.h"
+#include "Settings.h"
+#include "Recorder.h"
+
+#include "SharedEncoder.h"
+
+std::mutex SharedEncoder::access_;
+std::list<SharedEncoder *> SharedEncoder::encoders_;
+std::string SharedEncoder::encoder_;
+
+// same as H264 realtime profile of VideoRecorder
+std::vector< std::pair<std::string, std::string> > shared_encoder_alternatives_ {
+    {"nvh264enc", "video/x-raw, format=RGBA ! nvh264enc rc-mode=1 zerolatency=true ! video/x-h264, profile=(string)main ! "},
+    {"vaapih264enc", "video/x-raw, format=NV12 ! vaapih264enc rate-control=cqp init-qp=26 ! video/x-h264, profile=(string)main ! "},
+    {"vtenc_h264_hw", "video/x-raw, format=I420 ! vtenc_h264_hw realtime=1 allow-frame-reordering=0 ! "},
+    {"x264enc", "video/x-raw, format=I420 ! x264enc tune=\"zerolatency\" pass=4 quantizer=22 speed-preset=2 ! video/x-h264, profile=baseline ! "}
+};
+
+bool SharedEncoder::enabled()
+{
+    // select encoder on first run
+    static std::once_flag _tested;
+    std::call_once(_tested, []() {
+        encoder_.clear();
+        for (auto config = shared_encoder_alternatives_.cbegin();
+             config != shared_encoder_alternatives_.cend() && encoder_.empty(); ++config) {
+            // hardware accelerated encoders only if enabled
+            if ( !Settings::application.render.gpu_decoding && config->first != shared_encoder_alternatives_.back().first)
+                continue;
+            if ( GstToolkit::has_feature(config->first) )
+                encoder_ = config->second;
+        }
+        if (encoder_.empty())
+            Log::Info("Shared H264 encoder not available.");
+    });
+
+    return Settings::application.record.shared_encoding && !encoder_.empty();
+}
+
+void SharedEncoder::subscribe(FrameGrabber *grabber, gint fps, const std::string &profile)
+{
+    if (grabber == nullptr || !enabled())
+        return;
+
+    const std::string &p = profile.empty() ? encoder_ : profile;
+
+    std::lock_guard<std::mutex> lock(access_);
+
+    // find an encoder running at the same framerate with the same profile
+    SharedEncoder *encoder = nullptr;
+    for (auto it = encoders_.begin(); it != encoders_.end() && encoder == nullptr; ++it) {
+        if ( (*it)->fps_ == fps && (*it)->profile_ == p && !(*it)->closing_ && !(*it)->finished() )
+            encoder = *it;
+    }
+    // otherwise create one
+    if (encoder == nullptr) {
+        encoder = new SharedEncoder(fps, p);
+        encoders_.push_back(encoder);
+    }
+
+    // the new subscriber needs a key frame to start
+    encoder->subscribers_.push_back(grabber);
+    encoder->keyframe_request_ = true;
+    grabber->encoder_ = encoder;
+    grabber->encoded_ = true;
+}
+
+void SharedEncoder::unsubscribe(FrameGrabber *grabber)
+{
+    std::lock_guard<std::mutex> lock(access_);
+
+    SharedEncoder *encoder = grabber->encoder_;
+    if (encoder != nullptr) {
+        encoder->subscribers_.remove(grabber);
+        // stop encoding when nobody listens
+        if (encoder->subscribers_.empty())
+            encoder->closing_ = true;
+        grabber->encoder_ = nullptr;
+        // wait for a sample being given to the grabber
+        std::lock_guard<std::mutex> delivery(encoder->delivery_);
+    }
+}
+
+void SharedEncoder::grabFrame(GstBuffer *buffer, GstCaps *caps)
+{
+    // NB: encoders are created in any thread, but deleted only here
+    std::list<SharedEncoder *> encoders;
+    access_.lock();
+    encoders = encoders_;
+    access_.unlock();
+
+    if (encoders.empty())
+        return;
+
+    for (auto it = encoders.begin(); it != encoders.end(); ++it)
+        (*it)->addFrame(buffer, caps);
+
+    // remove finished encoders
+    std::list<SharedEncoder *> finished;
+    std::list<FrameGrabber *> orphans;
+    access_.lock();
+    for (auto it = encoders_.begin(); it != encoders_.end(); ) {
+        if ( (*it)->finished() ) {
+            // subscribers loose their encoder
+            for (auto sub = (*it)->subscribers_.begin(); sub != (*it)->subscribers_.end(); ++sub)
+                (*sub)->encoder_ = nullptr;
+            orphans.splice(orphans.end(), (*it)->subscribers_);
+            finished.push_back(*it);
+            it = encoders_.erase(it);
+        }
+        else
+            ++it;
+    }
+    access_.unlock();
+
+    // delete outside of lock (stops the streaming thread)
+    for (auto it = finished.begin(); it != finished.end(); ++it)
+        delete *it;
+
+    // subscribers cannot continue without encoder
+    for (auto it = orphans.begin(); it != orphans.end(); ++it) {
+        Log::Warning("Frame capture interrupted because the shared encoder stopped.");
+        (*it)->stop();
+    }
+}
+
+void SharedEncoder::clearAll()
+{
+    access_.lock();
+    std::list<SharedEncoder *> encoders = encoders_;
+    encoders_.clear();
+    for (auto it = encoders.begin(); it != encoders.end(); ++it) {
+        for (auto sub = (*it)->subscribers_.begin(); sub != (*it)->subscribers_.end(); ++sub)
+            (*sub)->encoder_ = nullptr;
+        (*it)->subscribers_.clear();
+    }
+    access_.unlock();
+
+    for (auto it = encoders.begin(); it != encoders.end(); ++it)
+        delete *it;
+}
+
+size_t SharedEncoder::count()
+{
+    std::lock_guard<std::mutex> lock(access_);
+    return encoders_.size();
+}
+
+SharedEncoder::SharedEncoder(gint fps, const std::string &profile) : FrameGrabber(),
+    fps_(fps), profile_(profile), closing_(false), keyframe_request_(false)
+{
+    fps_ = MAXI(fps_, 1);
+    frame_duration_ = gst_util_uint64_scale_int (1, GST_SECOND, fps_);
+}
+
+SharedEncoder::~SharedEncoder()
+{
+    // stop streaming thread before deleting subscribers list
+    if (pipeline_ != nullptr) {
+        GstState state = GST_STATE_NULL;
+        gst_element_set_state (pipeline_, state);
+        gst_element_get_state (pipeline_, &state, NULL, GST_CLOCK_TIME_NONE);
+    }
+}
+
+void SharedEncoder::addFrame(GstBuffer *buffer, GstCaps *caps)
+{
+    // nobody subscribed before the first frame: no need to start
+    if (closing_ && pipeline_ == nullptr && !initializer_.valid()) {
+        finished_ = true;
+        return;
+    }
+
+    // a new subscriber waits for a key frame
+    if (active_ && keyframe_request_) {
+        keyframe_request_ = false;
+        GstEvent *event = gst_video_event_new_downstream_force_key_unit(timestamp_,
+                                                                        GST_CLOCK_TIME_NONE,
+                                                                        GST_CLOCK_TIME_NONE,
+                                                                        TRUE,
+                                                                        frame_count_ / keyframe_count_);
+        gst_element_send_event(GST_ELEMENT(src_), event);
+    }
+
+    FrameGrabber::addFrame(buffer, caps);
+
+    // stop encoding when nobody listens
+    if (closing_ && active_)
+        stop();
+}
+
+std::string SharedEncoder::init(GstCaps *caps)
+{
+    // ignore
+    if (caps == nullptr)
+        return std::string("Shared encoder : Invalid caps");
+
+    // apply settings
+    buffering_size_ = MAX( MIN_BUFFER_SIZE, VideoRecorder::buffering_preset_value[Settings::application.record.buffering_mode]);
+    timestamp_on_clock_ = false;
+    keyframe_count_ = fps_;
+
+    // create a gstreamer pipeline
+    std::string description = "appsrc name=src ! videoconvert ! queue ! ";
+    description += profile_;
+    description += "h264parse config-interval=-1 ! ";
+    description += format();
+    description += " ! appsink name=sink";
+
+    // parse pipeline descriptor
+    GError *error = NULL;
+    pipeline_ = gst_parse_launch (description.c_str(), &error);
+    if (error != NULL) {
+        std::string msg = std::string("Shared encoder : Could not construct pipeline ") + description + "\n" + std::string(error->message);
+        g_clear_error (&error);
+        return msg;
+    }
+
+    // setup app sink giving encoded samples to subscribers
+    GstElement *sink = gst_bin_get_by_name (GST_BIN (pipeline_), "sink");
+    if (sink) {
+        g_object_set (G_OBJECT (sink), "sync", FALSE, NULL);
+
+        GstAppSinkCallbacks callbacks;
+#if GST_VERSION_MINOR > 18 && GST_VERSION_MAJOR > 0
+        callbacks.new_event = NULL;
+#if GST_VERSION_MINOR > 23
+        callbacks.propose_allocation = NULL;
+#endif
+#endif
+        callbacks.eos = NULL;
+        callbacks.new_preroll = NULL;
+        callbacks.new_sample = callback_new_sample;
+        gst_app_sink_set_callbacks (GST_APP_SINK(sink), &callbacks, this, NULL);
+        gst_app_sink_set_emit_signals (GST_APP_SINK(sink), false);
+        gst_object_unref (sink);
+    }
+    else {
+        return std::string("Shared encoder : Failed to configure encoder.");
+    }
+
+    // setup custom app source
+    src_ = GST_APP_SRC( gst_bin_get_by_name (GST_BIN (pipeline_), "src") );
+    if (src_) {
+
+        g_object_set (G_OBJECT (src_),
+                      "is-live", TRUE,
+                      "format", GST_FORMAT_TIME,
+                      NULL);
+
+        // configure stream
+        gst_app_src_set_stream_type( src_, GST_APP_STREAM_TYPE_STREAM);
+        gst_app_src_set_latency( src_, -1, 0);
+
+        // Set buffer size
+        gst_app_src_set_max_bytes( src_, buffering_size_);
+
+        // specify encoding framerate in the given caps
+        GstCaps *tmp = gst_caps_copy( caps );
+        GValue v = G_VALUE_INIT;
+        g_value_init (&v, GST_TYPE_FRACTION);
+        gst_value_set_fraction (&v, fps_, 1);
+        gst_caps_set_value(tmp, "framerate", &v);
+        g_value_unset (&v);
+
+        // instruct src to use the caps
+        caps_ = gst_caps_copy( tmp );
+        gst_app_src_set_caps (src_, caps_);
+        gst_caps_unref (tmp);
+
+        // setup callbacks
+        GstAppSrcCallbacks callbacks;
+        callbacks.need_data = FrameGrabber::callback_need_data;
+        callbacks.enough_data = FrameGrabber::callback_enough_data;
+        callbacks.seek_data = NULL; // stream type is not seekable
+        gst_app_src_set_callbacks (src_, &callbacks, this, NULL);
+
+    }
+    else {
+        return std::string("Shared encoder : Failed to configure frame grabber.");
+    }
+
+    // start encoding
+    GstStateChangeReturn ret = gst_element_set_state (pipeline_, GST_STATE_PLAYING);
+    if (ret == GST_STATE_CHANGE_FAILURE) {
+        return std::string("Shared encoder : Failed to start encoder.");
+    }
+
+    // all good
+    initialized_ = true;
+
+    return std::string("Shared H264 encoder started at ") + std::to_string(fps_) + " FPS";
+}
+
+void SharedEncoder::terminate()
+{
+    Log::Info("Shared H264 encoder : %ld frames encoded in %s.", frame_count_,
+              GstToolkit::time_to_string(duration_, GstToolkit::TIME_STRING_READABLE).c_str());
+}
+
+std::string SharedEncoder::info() const
+{
+    if (!initialized_)
+        return "Initializing";
+    if (active_)
+        return std::string("Shared H264 encoding ") + std::to_string(fps_) + " FPS";
+    else
+        return "Inactive";
+}
+
+GstFlowReturn SharedEncoder::callback_new_sample (GstAppSink *sink, gpointer p)
+{
+    GstFlowReturn ret = GST_FLOW_OK;
+
+    // get the encoded sample
+    GstSample *sample = gst_app_sink_pull_sample(sink);
+    if (sample != NULL) {
+        SharedEncoder *encoder = static_cast<SharedEncoder *>(p);
+        if (encoder) {
+            // give the sample to all subscribers, without blocking access to
+            // encoders (unsubscribe waits for the delivery to complete)
+            access_.lock();
+            std::list<FrameGrabber *> subscribers = encoder->subscribers_;
+            std::lock_guard<std::mutex> delivery(encoder->delivery_);
+            access_.unlock();
+            for (auto it = subscribers.begin(); it != subscribers.end(); ++it)
+                (*it)->addEncodedSample(sample);
+        }
+        gst_sample_unref (sample);
+    }
+    else
+        ret = GST_FLOW_FLUSHING;
+
+    return ret;
+}
@@ -0,0 +1,73 @@
+#ifndef SHAREDENCODER_H
+#define SHAREDENCODER_H
+
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <string>
+
+#include <gst/app/gstappsink.h>
+
+#include "FrameGrabber.h"
+
+/**
+ * @brief The SharedEncoder converts and encodes the frames grabbed
+ * once in H264, for all the frame grabbers subscribed to it.
+ *
+ * Frame grabbers encoding H264 at the same framerate and with the same
+ * encoder profile (e.g. a video recording and a peer to peer stream)
+ * subscribe to the same encoder, and
+ * only keep their muxer and sink in their own pipeline. The encoded
+ * samples given to a subscriber start with a key frame, and their
+ * timestamps start at zero.
+ *
+ * Shared encoders are created on subscription and stopped when they
+ * have no subscriber left. They are fed by FrameGrabbing::grabFrame.
+ */
+class SharedEncoder : public FrameGrabber
+{
+public:
+    // true if grabbers shall subscribe to shared encoders (Settings record.shared_encoding)
+    static bool enabled();
+
+    // caps of the encoded samples given to subscribers
+    static const char *format() { return "video/x-h264, stream-format=(string)byte-stream, alignment=(string)au"; }
+
+    // subscribe the grabber to the encoder running at fps with the given
+    // encoder profile (created if needed). The profile is a pipeline description
+    // of the encoder; default is the H264 Realtime profile of the VideoRecorder
+    static void subscribe(FrameGrabber *grabber, gint fps, const std::string &profile = std::string());
+    static void unsubscribe(FrameGrabber *grabber);
+
+    // give the frame to all encoders (only FrameGrabbing)
+    static void grabFrame(GstBuffer *buffer, GstCaps *caps);
+    static void clearAll();
+    static size_t count();
+
+    std::string info() const override;
+
+private:
+    SharedEncoder(gint fps, const std::string &profile);
+    ~SharedEncoder();
+
+    void addFrame(GstBuffer *buffer, GstCaps *caps) override;
+    std::string init(GstCaps *caps) override;
+    void terminate() override;
+
+    gint fps_;
+    std::string profile_;
+    std::list<FrameGrabber *> subscribers_;
+    std::mutex delivery_;
+    std::atomic<bool> closing_;
+    std::atomic<bool> keyframe_request_;
+
+    // gstreamer callback
+    static GstFlowReturn callback_new_sample (GstAppSink *, gpointer);
+
+    // all shared encoders
+    static std::mutex access_;
+    static std::list<SharedEncoder *> encoders_;
+    static std::string encoder_;
+};
+
+#endif // SHAREDENCODER_H
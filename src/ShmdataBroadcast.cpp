@@ -92,7 +92,14 @@ std::string ShmdataBroadcast::init(GstCaps *caps)
         return std::string("Shared Memory Broadcast : Invalid caps");
 
     // create a gstreamer pipeline
-    std::string description = "appsrc name=src ! queue ! ";
+    std::string description = "appsrc name=src ! ";
+
+    // shared memory clients expect RGB frames: convert frames grabbed in YUV
+    const gchar *format = gst_structure_get_string(gst_caps_get_structure(caps, 0), "format");
+    if (format && g_strcmp0(format, "I420") == 0)
+        description += "videoconvert ! video/x-raw, format=RGB ! ";
+
+    description += "queue ! ";
 
     // complement pipeline with sink
     description += shm_sink_[method_] + " name=sink";
@@ -194,7 +201,17 @@ std::string ShmdataBroadcast::gst_pipeline() const
     if (method_ == SHM_SHMSINK){
         pipeline += " is-live=true";
         pipeline += " ! ";
-        pipeline += std::string( gst_caps_to_string(caps_) );
+        // caps of the frames in shared memory (RGB if converted from YUV)
+        GstCaps *shared = gst_caps_copy(caps_);
+        GstStructure *s = gst_caps_get_structure(shared, 0);
+        if (g_strcmp0(gst_structure_get_string(s, "format"), "I420") == 0) {
+            gst_structure_set(s, "format", G_TYPE_STRING, "RGB", NULL);
+            gst_structure_remove_field(s, "colorimetry");
+        }
+        gchar *str = gst_caps_to_string(shared);
+        pipeline += std::string( str );
+        g_free(str);
+        gst_caps_unref(shared);
         pipeline = std::regex_replace(pipeline, std::regex("\\(int\\)"), "");
         pipeline = std::regex_replace(pipeline, std::regex("\\(fraction\\)"), "");
         pipeline = std::regex_replace(pipeline, std::regex("\\(string\\)"), "");
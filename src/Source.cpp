@@ -117,7 +117,7 @@ SourceCore& SourceCore::operator= (SourceCore const& other)
 
 
 Source::Source(uint64_t id) : SourceCore(), id_(id), ready_(false), symbol_(nullptr),
-    active_(true), locked_(false), need_update_(SourceUpdate_None), dt_(16.f), workspace_(WORKSPACE_CENTRAL)
+    active_(true), locked_(false), prepared_(false), need_update_(SourceUpdate_None), dt_(16.f), workspace_(WORKSPACE_CENTRAL)
 {
     // create unique id
     if (id_ == 0)
@@ -768,7 +768,7 @@ void Source::finish(SourceCallback *callback)
     }
 }
 
-void Source::updateCallbacks(float dt)
+void Source::updateCallbacks(float dt, bool concurrent)
 {
     // lock access to callbacks list
     access_callbacks_.lock();
@@ -778,6 +778,12 @@ void Source::updateCallbacks(float dt)
     {
         SourceCallback *callback = *iter;
 
+        // only call the callbacks of the requested kind
+        if (callback->concurrent() != concurrent) {
+            ++iter;
+            continue;
+        }
+
         // call update on callbacks
         callback->update(this, dt);
         need_update_ |= Source::SourceUpdate_Render;
@@ -805,6 +811,135 @@ CloneSource *Source::clone(uint64_t id)
     return s;
 }
 
+void Source::updateRender()
+{
+    // do not update next frame
+    need_update_ &= ~SourceUpdate_Render;
+
+    // ADJUST alpha based on MIXING node
+    // read position of the mixing node and interpret this as transparency of render output
+    glm::vec2 dist = glm::vec2(groups_[View::MIXING]->translation_);
+    // use the sinusoidal transfer function to compute alpha
+    float __a = SourceCore::alphaFromCordinates(dist.x, dist.y);
+    // audio update in case if depends on alpha
+    setAudioVolumeFactor(Source::VOLUME_ALPHA, __a);
+    // apply alpha
+    blendingshader_->color = glm::vec4(1.f, 1.f, 1.f, __a);
+    mixingshader_->color = blendingshader_->color;
+
+    // adjust scale of mixing icon : smaller if not active
+    groups_[View::MIXING]->scale_ = glm::vec3(MIXING_ICON_SCALE) - ( active_ ? glm::vec3(0.f, 0.f, 0.f) : glm::vec3(0.03f, 0.03f, 0.f) );
+    // change stippling intensity of source in mixing view to indicate if shown in scene
+    mixingshader_->stipple = (blendingshader_->color.a > 0.f) ? 1.f : 0.75f;
+
+    // MODIFY geometry based on GEOMETRY node
+    groups_[View::RENDERING]->translation_ = groups_[View::GEOMETRY]->translation_;
+    groups_[View::RENDERING]->rotation_ = groups_[View::GEOMETRY]->rotation_;
+    glm::vec3 s = groups_[View::GEOMETRY]->scale_;
+    // avoid any null scale
+    s.x = CLAMP_SCALE(s.x);
+    s.y = CLAMP_SCALE(s.y);
+    s.z = 1.f;
+    groups_[View::GEOMETRY]->scale_ = s;
+    groups_[View::RENDERING]->scale_ = s;
+
+    // MODIFY CROP projection based on GEOMETRY crop
+    renderbuffer_->setProjectionArea( groups_[View::GEOMETRY]->crop_ );
+
+    // TODO : should it be applied to MIXING view?
+    // Mixing and layer icons scaled based on GEOMETRY crop
+    mixingsurface_->scale_.y = (groups_[View::GEOMETRY]->crop_[2]
+                                - groups_[View::GEOMETRY]->crop_[3]) * 0.5f;
+    mixingsurface_->scale_.x = (groups_[View::GEOMETRY]->crop_[1]
+                                - groups_[View::GEOMETRY]->crop_[0]) * 0.5f * renderbuffer_->aspectRatio();
+    mixingsurface_->update(dt_);
+
+    // update nodes distortion
+    blendingshader_->iNodes = groups_[View::GEOMETRY]->data_;
+
+    handles_[View::GEOMETRY][Handles::NODE_LOWER_LEFT]->translation_.x = groups_[View::GEOMETRY]->data_[0].x;
+    handles_[View::GEOMETRY][Handles::NODE_LOWER_LEFT]->translation_.y = groups_[View::GEOMETRY]->data_[0].y;
+    handles_[View::GEOMETRY][Handles::NODE_UPPER_LEFT]->translation_.x = groups_[View::GEOMETRY]->data_[1].x;
+    handles_[View::GEOMETRY][Handles::NODE_UPPER_LEFT]->translation_.y = groups_[View::GEOMETRY]->data_[1].y;
+    handles_[View::GEOMETRY][Handles::NODE_LOWER_RIGHT]->translation_.x = groups_[View::GEOMETRY]->data_[2].x;
+    handles_[View::GEOMETRY][Handles::NODE_LOWER_RIGHT]->translation_.y = groups_[View::GEOMETRY]->data_[2].y;
+    handles_[View::GEOMETRY][Handles::NODE_UPPER_RIGHT]->translation_.x = groups_[View::GEOMETRY]->data_[3].x;
+    handles_[View::GEOMETRY][Handles::NODE_UPPER_RIGHT]->translation_.y = groups_[View::GEOMETRY]->data_[3].y;
+
+//        handles_[View::GEOMETRY][Handles::ROUNDING]->translation_.x = - groups_[View::GEOMETRY]->data_[0].z;
+    handles_[View::GEOMETRY][Handles::ROUNDING]->translation_.x = - groups_[View::GEOMETRY]->data_[0].w;
+
+    // Layers icons are displayed in Perspective (diagonal)
+    groups_[View::LAYER]->translation_.x = -groups_[View::LAYER]->translation_.z;
+    groups_[View::LAYER]->translation_.y = groups_[View::LAYER]->translation_.x / LAYER_PERSPECTIVE;
+
+    // Update workspace based on depth, and
+    // adjust vertical position of icon depending on workspace
+    if (groups_[View::LAYER]->translation_.x < -LAYER_FOREGROUND) {
+        groups_[View::LAYER]->translation_.y -= 0.3f;
+        workspace_ = Source::WORKSPACE_FOREGROUND;
+    }
+    else if (groups_[View::LAYER]->translation_.x < -LAYER_BACKGROUND) {
+        groups_[View::LAYER]->translation_.y -= 0.15f;
+        workspace_ = Source::WORKSPACE_CENTRAL;
+    }
+    else
+        workspace_ = Source::WORKSPACE_BACKGROUND;
+
+    // MODIFY depth based on LAYER node
+    groups_[View::MIXING]->translation_.z = groups_[View::LAYER]->translation_.z;
+    groups_[View::GEOMETRY]->translation_.z = groups_[View::LAYER]->translation_.z;
+    groups_[View::RENDERING]->translation_.z = groups_[View::LAYER]->translation_.z;
+
+    // MODIFY texture projection based on APPEARANCE node
+    // UV to node coordinates
+    static glm::mat4 UVtoScene = GlmToolkit::transform(glm::vec3(1.f, -1.f, 0.f),
+                                                       glm::vec3(0.f, 0.f, 0.f),
+                                                       glm::vec3(-2.f, 2.f, 1.f));
+    // Aspect Ratio correction transform : coordinates of Appearance Frame are scaled by render buffer width
+    glm::mat4 Ar = glm::scale(glm::identity<glm::mat4>(), glm::vec3(renderbuffer_->aspectRatio(), 1.f, 1.f) );
+    // Translation : same as Appearance Frame (modified by Ar)
+    glm::mat4 Tra = glm::translate(glm::identity<glm::mat4>(), groups_[View::TEXTURE]->translation_);
+    // Scaling : inverse scaling (larger UV when smaller Appearance Frame)
+    glm::vec2 scale =  glm::vec2(groups_[View::TEXTURE]->scale_.x,groups_[View::TEXTURE]->scale_.y);
+    scale = glm::sign(scale) * glm::max( glm::vec2(glm::epsilon<float>()), glm::abs(scale));
+    glm::mat4 Sca = glm::scale(glm::identity<glm::mat4>(), glm::vec3(scale, 1.f));
+    // Rotation : same angle than Appearance Frame, inverted axis
+    glm::mat4 Rot = glm::rotate(glm::identity<glm::mat4>(), groups_[View::TEXTURE]->rotation_.z, glm::vec3(0.f, 0.f, -1.f) );
+    // Combine transformations (non transitive) in this order:
+    // 1. switch to Scene coordinate system
+    // 2. Apply the aspect ratio correction
+    // 3. Apply the translation
+    // 4. Apply the rotation (centered after translation)
+    // 5. Revert aspect ration correction
+    // 6. Apply the Scaling (independent of aspect ratio)
+    // 7. switch back to UV coordinate system
+    texturesurface_->shader()->iTransform = glm::inverse(UVtoScene) * glm::inverse(Sca) * glm::inverse(Ar) * Rot * Tra * Ar * UVtoScene;
+
+    // inform mixing group (in update)
+    need_update_ |= SourceUpdate_Group;
+}
+
+void Source::prepare(float dt)
+{
+    // keep delta-t
+    dt_ = dt;
+
+    // if update is possible
+    if (renderbuffer_ && mixingsurface_ && maskbuffer_)
+    {
+        // call active callbacks which do not need the rendering thread
+        updateCallbacks(dt, true);
+
+        // update nodes if needed
+        if (need_update_ & SourceUpdate_Render)
+            updateRender();
+    }
+
+    // do not do it again in update
+    prepared_ = true;
+}
+
 void Source::update(float dt)
 {
     // keep delta-t
@@ -813,116 +948,18 @@ void Source::update(float dt)
     // if update is possible
     if (renderbuffer_ && mixingsurface_ && maskbuffer_)
     {
-        // call active callbacks
-        updateCallbacks(dt);
+        // call active callbacks (if not done in prepare)
+        if (!prepared_)
+            updateCallbacks(dt, true);
+        updateCallbacks(dt, false);
 
         // update nodes if needed
         if (need_update_ & SourceUpdate_Render)
-        {
-            // do not update next frame
-            need_update_ &= ~SourceUpdate_Render;
-
-            // ADJUST alpha based on MIXING node
-            // read position of the mixing node and interpret this as transparency of render output
-            glm::vec2 dist = glm::vec2(groups_[View::MIXING]->translation_);
-            // use the sinusoidal transfer function to compute alpha
-            float __a = SourceCore::alphaFromCordinates(dist.x, dist.y);
-            // audio update in case if depends on alpha
-            setAudioVolumeFactor(Source::VOLUME_ALPHA, __a);
-            // apply alpha
-            blendingshader_->color = glm::vec4(1.f, 1.f, 1.f, __a);
-            mixingshader_->color = blendingshader_->color;
-
-            // adjust scale of mixing icon : smaller if not active
-            groups_[View::MIXING]->scale_ = glm::vec3(MIXING_ICON_SCALE) - ( active_ ? glm::vec3(0.f, 0.f, 0.f) : glm::vec3(0.03f, 0.03f, 0.f) );
-            // change stippling intensity of source in mixing view to indicate if shown in scene
-            mixingshader_->stipple = (blendingshader_->color.a > 0.f) ? 1.f : 0.75f;
-
-            // MODIFY geometry based on GEOMETRY node
-            groups_[View::RENDERING]->translation_ = groups_[View::GEOMETRY]->translation_;
-            groups_[View::RENDERING]->rotation_ = groups_[View::GEOMETRY]->rotation_;
-            glm::vec3 s = groups_[View::GEOMETRY]->scale_;
-            // avoid any null scale
-            s.x = CLAMP_SCALE(s.x);
-            s.y = CLAMP_SCALE(s.y);
-            s.z = 1.f;
-            groups_[View::GEOMETRY]->scale_ = s;
-            groups_[View::RENDERING]->scale_ = s;
-
-            // MODIFY CROP projection based on GEOMETRY crop
-            renderbuffer_->setProjectionArea( groups_[View::GEOMETRY]->crop_ );
-
-            // TODO : should it be applied to MIXING view?
-            // Mixing and layer icons scaled based on GEOMETRY crop
-            mixingsurface_->scale_.y = (groups_[View::GEOMETRY]->crop_[2]
-                                        - groups_[View::GEOMETRY]->crop_[3]) * 0.5f;
-            mixingsurface_->scale_.x = (groups_[View::GEOMETRY]->crop_[1]
-                                        - groups_[View::GEOMETRY]->crop_[0]) * 0.5f * renderbuffer_->aspectRatio();
-            mixingsurface_->update(dt_);
-
-            // update nodes distortion
-            blendingshader_->iNodes = groups_[View::GEOMETRY]->data_;
-
-            handles_[View::GEOMETRY][Handles::NODE_LOWER_LEFT]->translation_.x = groups_[View::GEOMETRY]->data_[0].x;
-            handles_[View::GEOMETRY][Handles::NODE_LOWER_LEFT]->translation_.y = groups_[View::GEOMETRY]->data_[0].y;
-            handles_[View::GEOMETRY][Handles::NODE_UPPER_LEFT]->translation_.x = groups_[View::GEOMETRY]->data_[1].x;
-            handles_[View::GEOMETRY][Handles::NODE_UPPER_LEFT]->translation_.y = groups_[View::GEOMETRY]->data_[1].y;
-            handles_[View::GEOMETRY][Handles::NODE_LOWER_RIGHT]->translation_.x = groups_[View::GEOMETRY]->data_[2].x;
-            handles_[View::GEOMETRY][Handles::NODE_LOWER_RIGHT]->translation_.y = groups_[View::GEOMETRY]->data_[2].y;
-            handles_[View::GEOMETRY][Handles::NODE_UPPER_RIGHT]->translation_.x = groups_[View::GEOMETRY]->data_[3].x;
-            handles_[View::GEOMETRY][Handles::NODE_UPPER_RIGHT]->translation_.y = groups_[View::GEOMETRY]->data_[3].y;
-
-//            handles_[View::GEOMETRY][Handles::ROUNDING]->translation_.x = - groups_[View::GEOMETRY]->data_[0].z;
-            handles_[View::GEOMETRY][Handles::ROUNDING]->translation_.x = - groups_[View::GEOMETRY]->data_[0].w;
-
-            // Layers icons are displayed in Perspective (diagonal)
-            groups_[View::LAYER]->translation_.x = -groups_[View::LAYER]->translation_.z;
-            groups_[View::LAYER]->translation_.y = groups_[View::LAYER]->translation_.x / LAYER_PERSPECTIVE;
-
-            // Update workspace based on depth, and
-            // adjust vertical position of icon depending on workspace
-            if (groups_[View::LAYER]->translation_.x < -LAYER_FOREGROUND) {
-                groups_[View::LAYER]->translation_.y -= 0.3f;
-                workspace_ = Source::WORKSPACE_FOREGROUND;
-            }
-            else if (groups_[View::LAYER]->translation_.x < -LAYER_BACKGROUND) {
-                groups_[View::LAYER]->translation_.y -= 0.15f;
-                workspace_ = Source::WORKSPACE_CENTRAL;
-            }
-            else
-                workspace_ = Source::WORKSPACE_BACKGROUND;
-
-            // MODIFY depth based on LAYER node
-            groups_[View::MIXING]->translation_.z = groups_[View::LAYER]->translation_.z;
-            groups_[View::GEOMETRY]->translation_.z = groups_[View::LAYER]->translation_.z;
-            groups_[View::RENDERING]->translation_.z = groups_[View::LAYER]->translation_.z;
-
-            // MODIFY texture projection based on APPEARANCE node
-            // UV to node coordinates
-            static glm::mat4 UVtoScene = GlmToolkit::transform(glm::vec3(1.f, -1.f, 0.f),
-                                                               glm::vec3(0.f, 0.f, 0.f),
-                                                               glm::vec3(-2.f, 2.f, 1.f));
-            // Aspect Ratio correction transform : coordinates of Appearance Frame are scaled by render buffer width
-            glm::mat4 Ar = glm::scale(glm::identity<glm::mat4>(), glm::vec3(renderbuffer_->aspectRatio(), 1.f, 1.f) );
-            // Translation : same as Appearance Frame (modified by Ar)
-            glm::mat4 Tra = glm::translate(glm::identity<glm::mat4>(), groups_[View::TEXTURE]->translation_);
-            // Scaling : inverse scaling (larger UV when smaller Appearance Frame)
-            glm::vec2 scale =  glm::vec2(groups_[View::TEXTURE]->scale_.x,groups_[View::TEXTURE]->scale_.y);
-            scale = glm::sign(scale) * glm::max( glm::vec2(glm::epsilon<float>()), glm::abs(scale));
-            glm::mat4 Sca = glm::scale(glm::identity<glm::mat4>(), glm::vec3(scale, 1.f));
-            // Rotation : same angle than Appearance Frame, inverted axis
-            glm::mat4 Rot = glm::rotate(glm::identity<glm::mat4>(), groups_[View::TEXTURE]->rotation_.z, glm::vec3(0.f, 0.f, -1.f) );
-            // Combine transformations (non transitive) in this order:
-            // 1. switch to Scene coordinate system
-            // 2. Apply the aspect ratio correction
-            // 3. Apply the translation
-            // 4. Apply the rotation (centered after translation)
-            // 5. Revert aspect ration correction
-            // 6. Apply the Scaling (independent of aspect ratio)
-            // 7. switch back to UV coordinate system
-            texturesurface_->shader()->iTransform = glm::inverse(UVtoScene) * glm::inverse(Sca) * glm::inverse(Ar) * Rot * Tra * Ar * UVtoScene;
-
-            // inform mixing group
+            updateRender();
+
+        // inform mixing group
+        if (need_update_ & SourceUpdate_Group) {
+            need_update_ &= ~SourceUpdate_Group;
             if (mixinggroup_)
                 mixinggroup_->setAction(MixingGroup::ACTION_UPDATE);
         }
@@ -988,6 +1025,8 @@ void Source::update(float dt)
 
     }
 
+    // next frame needs to be prepared again
+    prepared_ = false;
 }
 
 FrameBuffer *Source::frame() const
@@ -148,7 +148,8 @@ public:
         SourceUpdate_Render    = 1 << 1,
         SourceUpdate_Mask      = 1 << 2,
         SourceUpdate_Mask_fill = 1 << 3,
-        SourceUpdate_Audio     = 1 << 4
+        SourceUpdate_Audio     = 1 << 4,
+        SourceUpdate_Group     = 1 << 5
     };
     typedef int UpdateFlags;
     inline void touch (UpdateFlags f = SourceUpdate_Render) { need_update_ |= f; }
@@ -156,6 +157,10 @@ public:
     // informs if its ready (i.e. initialized)
     inline bool ready () const  { return ready_; }
 
+    // a Source can be prepared before update, outside of the rendering thread
+    // (callbacks and attributes only, no OpenGL; sources can be prepared concurrently)
+    void prepare (float dt);
+
     // a Source shall be updated before displayed (Mixing, Geometry and Layer)
     virtual void update (float dt);
 
@@ -371,6 +376,7 @@ protected:
     // update
     bool  active_;
     bool  locked_;
+    bool  prepared_;
     UpdateFlags   need_update_;
     float dt_;
     Workspace  workspace_;
@@ -378,7 +384,8 @@ protected:
     // callbacks
     std::list<SourceCallback *> update_callbacks_;
     std::mutex access_callbacks_;
-    void updateCallbacks(float dt);
+    void updateCallbacks(float dt, bool concurrent);
+    void updateRender();
 
     // clones
     CloneList clones_;
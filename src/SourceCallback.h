@@ -65,6 +65,9 @@ public:
     virtual SourceCallback *reverse (Source *) const { return nullptr; }
     virtual CallbackType type () const { return CALLBACK_GENERIC; }
     virtual void accept (Visitor& v);
+    // true if the callback only interpolates attributes of the source, and can be
+    // updated outside of the rendering thread (not for media control or OpenGL)
+    virtual bool concurrent () const { return false; }
 
     inline void reset () { status_ = PENDING; }
     inline void finish () { status_ = FINISHED; }
@@ -146,6 +149,7 @@ public:
     SourceCallback *reverse(Source *s) const override;
     CallbackType type () const override { return CALLBACK_ALPHA; }
     void accept (Visitor& v) override;
+    bool concurrent () const override { return true; }
 };
 
 class Loom : public SourceCallback
@@ -167,6 +171,7 @@ public:
     SourceCallback *clone() const override;
     CallbackType type () const override { return CALLBACK_LOOM; }
     void accept (Visitor& v) override;
+    bool concurrent () const override { return true; }
 };
 
 class Lock : public SourceCallback
@@ -299,6 +304,7 @@ public:
     void update (Source *s, float dt) override;
     SourceCallback *clone () const override;
     CallbackType type () const override { return CALLBACK_RESETGEO; }
+    bool concurrent () const override { return true; }
 };
 
 class SetGeometry : public SourceCallback
@@ -324,6 +330,7 @@ public:
     SourceCallback *reverse(Source *s) const override;
     CallbackType type () const override { return CALLBACK_GEOMETRY; }
     void accept (Visitor& v) override;
+    bool concurrent () const override { return true; }
 };
 
 class Grab : public SourceCallback
@@ -344,6 +351,7 @@ public:
     SourceCallback *clone () const override;
     CallbackType type () const override { return CALLBACK_GRAB; }
     void accept (Visitor& v) override;
+    bool concurrent () const override { return true; }
 };
 
 class Resize : public SourceCallback
@@ -364,6 +372,7 @@ public:
     SourceCallback *clone () const override;
     CallbackType type () const override { return CALLBACK_RESIZE; }
     void accept (Visitor& v) override;
+    bool concurrent () const override { return true; }
 };
 
 class Turn : public SourceCallback
@@ -384,6 +393,7 @@ public:
     SourceCallback *clone () const override;
     CallbackType type () const override { return CALLBACK_TURN; }
     void accept (Visitor& v) override;
+    bool concurrent () const override { return true; }
 };
 
 class SetBrightness : public ValueSourceCallback
@@ -393,6 +403,7 @@ class SetBrightness : public ValueSourceCallback
 public:
     SetBrightness (float v = 0.f, float ms = 0.f, bool revert = false);
     CallbackType type () const override { return CALLBACK_BRIGHTNESS; }
+    bool concurrent () const override { return true; }
 };
 
 class SetContrast : public ValueSourceCallback
@@ -402,6 +413,7 @@ class SetContrast : public ValueSourceCallback
 public:
     SetContrast (float v = 0.f, float ms = 0.f, bool revert = false);
     CallbackType type () const override { return CALLBACK_CONTRAST; }
+    bool concurrent () const override { return true; }
 };
 
 class SetSaturation : public ValueSourceCallback
@@ -411,6 +423,7 @@ class SetSaturation : public ValueSourceCallback
 public:
     SetSaturation (float v = 0.f, float ms = 0.f, bool revert = false);
     CallbackType type () const override { return CALLBACK_SATURATION; }
+    bool concurrent () const override { return true; }
 };
 
 class SetHue : public ValueSourceCallback
@@ -420,6 +433,7 @@ class SetHue : public ValueSourceCallback
 public:
     SetHue (float v = 0.f, float ms = 0.f, bool revert = false);
     CallbackType type () const override { return CALLBACK_HUE; }
+    bool concurrent () const override { return true; }
 };
 
 class SetThreshold : public ValueSourceCallback
@@ -429,6 +443,7 @@ class SetThreshold : public ValueSourceCallback
 public:
     SetThreshold (float v = 0.f, float ms = 0.f, bool revert = false);
     CallbackType type () const override { return CALLBACK_THRESHOLD; }
+    bool concurrent () const override { return true; }
 };
 
 class SetInvert : public ValueSourceCallback
@@ -438,6 +453,7 @@ class SetInvert : public ValueSourceCallback
 public:
     SetInvert (float v = 0.f, float ms = 0.f, bool revert = false);
     CallbackType type () const override { return CALLBACK_INVERT; }
+    bool concurrent () const override { return true; }
 };
 
 class SetPosterize : public ValueSourceCallback
@@ -447,6 +463,7 @@ class SetPosterize : public ValueSourceCallback
 public:
     SetPosterize (float v = 0.f, float ms = 0.f, bool revert = false);
     CallbackType type () const override { return CALLBACK_POSTERIZE; }
+    bool concurrent () const override { return true; }
 };
 
 class SetGamma : public SourceCallback
@@ -472,6 +489,7 @@ public:
     SourceCallback *reverse(Source *s) const override;
     CallbackType type () const override { return CALLBACK_GAMMA; }
     void accept (Visitor& v) override;
+    bool concurrent () const override { return true; }
 };
 
 class SetFilter : public SourceCallback
@@ -1928,6 +1928,8 @@ void SourceControlWindow::RenderSingleSource(Source *s)
                 if (sts && s->playing()) {
                     ImGui::SetCursorScreenPos(imgarea.GetTL() + ImVec2(imgarea.GetWidth() - 1.5f * buttons_height_, 0.5f * tooltip_height));
                     ImGui::Text("%.1f Hz", sts->stream()->updateFrameRate());
+                    if (ImGui::IsItemHovered())
+                        ImGui::SetTooltip("Texture upload %.2f ms", sts->stream()->uploadTime());
                 }
             }
             else
@@ -2124,6 +2126,8 @@ void SourceControlWindow::RenderMediaPlayer(MediaSource *ms)
             if ( mediaplayer_active_->isPlaying()) {
                 ImGui::SetCursorScreenPos(imgarea.GetTL() + ImVec2( imgarea.GetWidth() - 1.5f * buttons_height_, 0.667f * tooltip_height));
                 ImGui::Text("%.1f Hz", mediaplayer_active_->updateFrameRate());
+                if (ImGui::IsItemHovered())
+                    ImGui::SetTooltip("Texture upload %.2f ms", mediaplayer_active_->uploadTime());
             }
         }
     }
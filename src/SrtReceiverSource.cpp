@@ -57,7 +57,8 @@ void SrtReceiverSource::setConnection(const std::string &ip, const std::string &
 
     std::string description = "srtsrc uri=" + uri() + " ! queue ! decodebin ! videoconvert";
 
-    // open gstreamer
+    // open gstreamer (opaque frames can be converted on GPU)
+    stream_->setYuvTexturing(true);
     stream_->open(description);
     stream_->play(true);
 
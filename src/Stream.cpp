@@ -28,6 +28,9 @@
 #include "Visitor.h"
 #include "BaseToolkit.h"
 #include "GstToolkit.h"
+#include "Settings.h"
+#include "YuvConverter.h"
+#include "TextureUploader.h"
 
 #include "Stream.h"
 
@@ -38,7 +41,7 @@ std::list<GstElement*> Stream::registered_;
 #endif
 
 
-Stream::Stream()
+Stream::Stream() : frames_(N_FRAME, true)
 {
     // create unique id
     id_ = BaseToolkit::uniqueId();
@@ -58,19 +61,15 @@ Stream::Stream()
     rewind_on_disable_ = false;
     decoder_name_ = "";
 
-    // start index in frame_ stack
-    write_index_ = 0;
-    last_index_ = 0;
-
     // no PBO by default
-    pbo_[0] = pbo_[1] = 0;
-    pbo_size_ = 0;
-    pbo_index_ = 0;
-    pbo_next_index_ = 0;
+    uploader_ = nullptr;
 
     // OpenGL texture
     textureindex_ = 0;
     textureinitialized_ = false;
+    yuv_texturing_ = false;
+    yuv_ = nullptr;
+    v_frame_caps_ = nullptr;
 }
 
 Stream::~Stream()
@@ -261,13 +260,17 @@ void Stream::execute_open()
     gst_pipeline_set_auto_flush_bus( GST_PIPELINE(pipeline_), true);
 
     // GstCaps *caps = gst_static_caps_get (&frame_render_caps);
-    std::string capstring = "video/x-raw,format=RGBA,width="+ std::to_string(width_) +
-            ",height=" + std::to_string(height_);
+    // (planar YUV if accepted by the stream and converted on GPU)
+    bool yuv = yuv_texturing_ && Settings::application.render.yuv_texturing;
+    std::string capstring = std::string("video/x-raw,format=") + (yuv ? YuvConverter::format() : "RGBA") +
+            ",width=" + std::to_string(width_) + ",height=" + std::to_string(height_);
     GstCaps *caps = gst_caps_from_string(capstring.c_str());
     if (!caps || !gst_video_info_from_caps (&v_frame_video_info_, caps)) {
         fail("Could not configure video frame info");
         return;
     }
+    // (actual video info read from the caps of the first frame)
+    gst_caps_replace(&v_frame_caps_, NULL);
 
     // setup appsink
     GstElement *sink = gst_bin_get_by_name (GST_BIN (pipeline_), "sink");
@@ -279,6 +282,8 @@ void Stream::execute_open()
     // instruct sink to use the required caps
     gst_app_sink_set_caps (GST_APP_SINK(sink), caps);
     gst_caps_unref (caps);
+    if (yuv && yuv_ == nullptr)
+        yuv_ = new YuvConverter;
 
     // Instruct appsink to drop old buffers when the maximum amount of queued buffers is reached.
     gst_app_sink_set_max_buffers( GST_APP_SINK(sink), 30);
@@ -418,18 +423,14 @@ void Stream::close()
     // un-ready
     opened_ = false;
 
+#ifdef STREAM_DEBUG
+    if (frames_.dropped() + frames_.skipped() > 0)
+        Log::Info("Stream %s Dropped %lu and skipped %lu late frames out of %lu.", std::to_string(id_).c_str(),
+                  (unsigned long) frames_.dropped(), (unsigned long) frames_.skipped(), (unsigned long) frames_.pushed());
+#endif
     // cleanup eventual remaining frame memory
-    for(guint i = 0; i < N_FRAME; ++i){
-        frame_[i].access.lock();
-        if (frame_[i].buffer) {
-            gst_buffer_unref(frame_[i].buffer);
-            frame_[i].buffer = NULL;
-        }
-        frame_[i].status = INVALID;
-        frame_[i].access.unlock();
-    }
-    write_index_ = 0;
-    last_index_ = 0;
+    frames_.clear();
+    gst_caps_replace(&v_frame_caps_, NULL);
 
     // clean up GST
     if (pipeline_ != nullptr) {
@@ -446,10 +447,16 @@ void Stream::close()
         textureindex_ = 0;
     }
 
-    // cleanup picture buffer
-    if (pbo_[0]) {
-        glDeleteBuffers(2, pbo_);
-        pbo_[0] = 0;
+    // cleanup picture buffers
+    if (uploader_) {
+        delete uploader_;
+        uploader_ = nullptr;
+    }
+
+    // cleanup YUV conversion
+    if (yuv_) {
+        delete yuv_;
+        yuv_ = nullptr;
     }
 }
 
@@ -471,7 +478,7 @@ float Stream::aspectRatio() const
 
 void Stream::enable(bool on)
 {
-    if ( !opened_ || pipeline_ == nullptr || !textureinitialized_)
+    if ( !opened_ || !textureinitialized_)
         return;
 
     if ( enabled_ != on ) {
@@ -492,10 +499,12 @@ void Stream::enable(bool on)
             requested_state = desired_state_;
         }
 
-        //  apply state change
-        GstStateChangeReturn ret = gst_element_set_state (pipeline_, requested_state);
-        if (ret == GST_STATE_CHANGE_FAILURE)
-            fail("Failed to enable");
+        //  apply state change (a stream without pipeline only keeps the state)
+        if ( pipeline_ != nullptr ) {
+            GstStateChangeReturn ret = gst_element_set_state (pipeline_, requested_state);
+            if (ret == GST_STATE_CHANGE_FAILURE)
+                fail("Failed to enable");
+        }
 
     }
 }
@@ -590,7 +599,7 @@ GstClockTime Stream::position()
     return position_;
 }
 
-void Stream::init_texture(guint index)
+void Stream::init_texture(GstBuffer *buf)
 {
     glActiveTexture(GL_TEXTURE0);
     if (textureindex_)
@@ -599,33 +608,29 @@ void Stream::init_texture(guint index)
     glBindTexture(GL_TEXTURE_2D, textureindex_);
     glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width_, height_);
 
-    // fill texture with frame at given index
-    if (frame_[index].buffer) {
-        GstMapInfo map;
-        gst_buffer_map(frame_[index].buffer, &map, GST_MAP_READ);
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, map.data);
-        gst_buffer_unmap(frame_[index].buffer, &map);
-    }
-
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
+    // fill texture with given buffer
+    if (buf) {
+        GstMapInfo map;
+        gst_buffer_map(buf, &map, GST_MAP_READ);
+        if (yuv_)
+            yuv_->convert(v_frame_video_info_, map.data, textureindex_);
+        else
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, map.data);
+        gst_buffer_unmap(buf, &map);
+    }
+
     // use Pixel Buffer Objects only for performance needs of videos
     if (!single_frame_) {
 
-        // set pbo image size
-        pbo_size_ = height_ * width_ * 4;
-
-        // create pixel buffer objects,
-        if (pbo_[0])
-            glDeleteBuffers(2, pbo_);
-        glGenBuffers(2, pbo_);
-
-        // should be good to go
-        pbo_index_ = 0;
-        pbo_next_index_ = 1;
+        // create ring of pixel buffer objects for frames of that size
+        if (uploader_ == nullptr)
+            uploader_ = new TextureUploader;
+        uploader_->configure( yuv_ ? GST_VIDEO_INFO_SIZE(&v_frame_video_info_) : height_ * width_ * 4 );
 
 #ifdef STREAM_DEBUG
         Log::Info("Stream %s Use Pixel Buffer Object texturing.", std::to_string(id_).c_str());
@@ -639,55 +644,36 @@ void Stream::init_texture(guint index)
 }
 
 
-void Stream::fill_texture(guint index)
+void Stream::fill_texture(GstBuffer *buf)
 {
     // is this the first frame ?
     if ( !textureinitialized_ || !textureindex_)
     {
         // initialize texture
-        // (this also fills the texture with frame at index)
-        init_texture(index);
+        // (this also fills the texture with the buffer)
+        init_texture(buf);
     }
     else {
         // Use GST mapping to access pointer to RGBA data
         GstMapInfo map;
-        gst_buffer_map(frame_[index].buffer, &map, GST_MAP_READ);
+        gst_buffer_map(buf, &map, GST_MAP_READ);
 
         // bind texture for writing
         glBindTexture(GL_TEXTURE_2D, textureindex_);
 
-        // use dual Pixel Buffer Object
-        if (pbo_size_ > 0 && map.size == pbo_size_) {
-
-            // In dual PBO mode, increment current index first then get the next index
-            pbo_index_ = (pbo_index_ + 1) % 2;
-            pbo_next_index_ = (pbo_index_ + 1) % 2;
-
-            // bind PBO to read pixels
-            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_[pbo_index_]);
-            // copy pixels from PBO to texture object
-            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, 0);
-            // bind the next PBO to write pixels
-            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_[pbo_next_index_]);
-#ifdef USE_GL_BUFFER_SUBDATA
-            glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, pbo_size_, map.data);
-#else
-            // update data directly on the mapped buffer \
-            // NB : equivalent but faster than glBufferSubData (memmove instead of memcpy ?) \
-            // See http://www.songho.ca/opengl/gl_pbo.html#map for more details
-            glBufferData(GL_PIXEL_UNPACK_BUFFER, pbo_size_, 0, GL_STREAM_DRAW);
-
-            // map the buffer object into client's memory
-            GLubyte* ptr = (GLubyte*) glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
-            if (ptr)
-                memmove(ptr, map.data, pbo_size_);
-
-            // release pointer to mapping buffer
-            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
-#endif
-
-    // done with PBO
-            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        // use ring of Pixel Buffer Objects
+        if (uploader_ && uploader_->bind(map.data, map.size)) {
+            // copy pixels from bound PBO to texture object
+            if (yuv_)
+                yuv_->convert(v_frame_video_info_, nullptr, textureindex_);
+            else
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+            // done with PBO
+            uploader_->unbind();
+        }
+        else if (yuv_) {
+            // without PBO, upload and convert planes
+            yuv_->convert(v_frame_video_info_, map.data, textureindex_);
         }
         else {
             // without PBO, use standard opengl (slower)
@@ -699,7 +685,7 @@ void Stream::fill_texture(guint index)
         glBindTexture(GL_TEXTURE_2D, 0);
 
         // unmap buffer to let it free
-        gst_buffer_unmap (frame_[index].buffer, &map);
+        gst_buffer_unmap (buf, &map);
     }
 }
 
@@ -737,59 +723,39 @@ void Stream::update()
         return;
 
     // local variables before trying to update
-    guint read_index = 0;
+    FrameRing::Frame frame;
     bool need_loop = false;
 
-    // locked access to current index
-    index_lock_.lock();
-    // get the last frame filled from fill_frame()
-    read_index = last_index_;
-    // Do NOT miss and jump directly to a pre-roll
-    for (guint i = 0; i < N_FRAME; ++i) {
-        if (frame_[i].status == PREROLL) {
-            read_index = i;
-            break;
-        }
-    }
-    // unlock access to index change
-    index_lock_.unlock();
-
-    // lock frame while reading it
-    frame_[read_index].access.lock();
-
-    // do not fill a frame twice
-    if (frame_[read_index].status != INVALID ) {
+    // get the most recent frame filled from fill_frame()
+    // (NB: the frame ring does NOT jump over a pre-roll)
+    if ( frames_.pull(frame) ) {
 
         // is this an End-of-Stream frame ?
-        if (frame_[read_index].status == EOS )
+        if (frame.status == FrameRing::EOS )
         {
-            // will execute seek command below (after unlock)
+            // will execute seek command below
             need_loop = true;
         }
         // otherwise just fill non-empty SAMPLE or PREROLL
-        else if (frame_[read_index].is_new)
+        else if (frame.buffer)
         {
-            // fill the texture with the frame at reading index
-            fill_texture(read_index);
+            // video info of the caps negotiated for this frame (colorimetry, range, strides)
+            update_video_info(frame.caps);
 
-            // double update for pre-roll frame and dual PBO (ensure frame is displayed now)
-            if (frame_[read_index].status == PREROLL && pbo_size_ > 0)
-                fill_texture(read_index);
+            // fill the texture with the frame
+            // (uploaded immediately: no need to double update for pre-roll)
+            fill_texture(frame.buffer);
 
             // free frame
-            frame_[read_index].is_new = false;
+            gst_buffer_unref(frame.buffer);
         }
+        if (frame.caps)
+            gst_caps_unref(frame.caps);
 
         // we just displayed a vframe : set position time to frame PTS
-        position_ = frame_[read_index].position;
-
-        // avoid reading it again
-        frame_[read_index].status = INVALID;
+        position_ = frame.position;
     }
 
-    // unkock frame after reading it
-    frame_[read_index].access.unlock();
-
     if (need_loop) {
         // stop on end of stream
         play(false);
@@ -807,61 +773,43 @@ double Stream::updateFrameRate() const
     return timecount_.frameRate();
 }
 
-
-// CALLBACKS
-
-bool Stream::fill_frame(GstBuffer *buf, FrameStatus status)
+double Stream::uploadTime() const
 {
-//    Log::Info("Stream fill frame");
+    return uploader_ ? uploader_->uploadTime() : 0.0;
+}
 
-    // Do NOT overwrite an unread EOS
-    if ( frame_[write_index_].status == EOS )
-        write_index_ = (write_index_ + 1) % N_FRAME;
+void Stream::update_video_info(GstCaps *caps)
+{
+    // the caps given to the appsink are only those requested; read the
+    // actual video info from the caps of the samples when they change
+    if (caps == NULL || caps == v_frame_caps_)
+        return;
 
-    // lock access to frame
-    frame_[write_index_].access.lock();
+    GstVideoInfo info;
+    if ( gst_video_info_from_caps(&info, caps) )
+        v_frame_video_info_ = info;
+    gst_caps_replace(&v_frame_caps_, caps);
+}
 
-    // always empty frame before filling it again
-    if (frame_[write_index_].buffer) {
-        gst_buffer_unref(frame_[write_index_].buffer);
-        frame_[write_index_].buffer = NULL;
-    }
 
-    // accept status of frame received
-    frame_[write_index_].status = status;
+// CALLBACKS
 
+bool Stream::fill_frame(GstBuffer *buf, FrameRing::Status status, GstCaps *caps)
+{
     // a buffer is given (not EOS)
     if (buf != NULL) {
-
-        // copy the buffer in the frame
-        frame_[write_index_].buffer = gst_buffer_copy(buf);
-
-        // indicate to update loop that buffer is new
-        frame_[write_index_].is_new = true;
-
-        // set presentation time stamp
-        frame_[write_index_].position = buf->pts;
+        // give the buffer to update loop, with presentation time stamp
+        // (a late frame is dropped if update loop did not read previous ones)
+        frames_.push(buf, status, buf->pts, caps);
     }
-    // else; null buffer for EOS: give a position
+    // else; null buffer for EOS
     else {
-        frame_[write_index_].status = EOS;
+        frames_.push(NULL, FrameRing::EOS, GST_CLOCK_TIME_NONE);
 #ifdef STREAM_DEBUG
         Log::Info("Stream %s Reached End Of Stream", std::to_string(id_).c_str());
 #endif
     }
 
-    // unlock access to frame
-    frame_[write_index_].access.unlock();
-
-    // lock access to change current index (very quick)
-    index_lock_.lock();
-    // indicate update() that this is the last frame filled (and unlocked)
-    last_index_ = write_index_;
-    // unlock access to index change
-    index_lock_.unlock();
-    // for writing, we will access the next in stack
-    write_index_ = (write_index_ + 1) % N_FRAME;
-
     // calculate actual FPS of update
     timecount_.tic();
 
@@ -872,7 +820,7 @@ void Stream::callback_end_of_stream (GstAppSink *, gpointer p)
 {
     Stream *m = static_cast<Stream *>(p);
     if (m && m->opened_) {
-        m->fill_frame(NULL, Stream::EOS);
+        m->fill_frame(NULL, FrameRing::EOS);
     }
 }
 
@@ -893,7 +841,7 @@ GstFlowReturn Stream::callback_new_preroll (GstAppSink *sink, gpointer p)
             GstBuffer *buf = gst_sample_get_buffer (sample);
 
             // fill frame from buffer
-            if ( !m->fill_frame(buf, Stream::PREROLL) )
+            if ( !m->fill_frame(buf, FrameRing::PREROLL, gst_sample_get_caps(sample)) )
                 ret = GST_FLOW_ERROR;
         }
     }
@@ -927,7 +875,7 @@ GstFlowReturn Stream::callback_new_sample (GstAppSink *sink, gpointer p)
             GstBuffer *buf = gst_sample_get_buffer (sample) ;
 
             // fill frame with buffer
-            if ( !m->fill_frame(buf, Stream::SAMPLE) )
+            if ( !m->fill_frame(buf, FrameRing::SAMPLE, gst_sample_get_caps(sample)) )
                 ret = GST_FLOW_ERROR;
         }
     }
@@ -11,8 +11,12 @@
 #include <gst/pbutils/pbutils.h>
 #include <gst/app/gstappsink.h>
 
+#include "FrameRing.h"
+
 // Forward declare classes referenced
 class Visitor;
+class YuvConverter;
+class TextureUploader;
 
 #define N_FRAME 3
 #define TIMEOUT 10
@@ -121,6 +125,16 @@ public:
      * measured during play
      * */
     double updateFrameRate() const;
+    /**
+     * Get average time spent uploading frames
+     * to texture, in milliseconds
+     * */
+    double uploadTime() const;
+    /**
+     * Get the stack of decoded frames
+     * (for statistics on late frames)
+     * */
+    inline const FrameRing &frames() const { return frames_; }
     /**
      * Get frame width
      * */
@@ -151,6 +165,12 @@ public:
      * */
     inline void setRewindOnDisabled(bool on) { rewind_on_disable_ = on; }
     inline bool rewindOnDisabled() const { return rewind_on_disable_; }
+    /**
+     * Option to receive frames in planar YUV, converted to RGB on GPU
+     * (only for streams without alpha; applied at next open)
+     * */
+    inline void setYuvTexturing(bool on) { yuv_texturing_ = on; }
+    inline bool yuvTexturing() const { return yuv_texturing_; }
     /**
      * Get logs
      * */
@@ -186,6 +206,7 @@ protected:
     GstElement *pipeline_;
     GstBus *bus_;
     GstVideoInfo v_frame_video_info_;
+    GstCaps *v_frame_caps_;
     std::atomic<bool> opened_;
     std::atomic<bool> failed_;
     bool enabled_;
@@ -205,36 +226,14 @@ protected:
     TimeCounter timecount_;
 
     // frame stack
-    typedef enum  {
-        SAMPLE = 0,
-        PREROLL = 1,
-        EOS = 2,
-        INVALID = 3
-    } FrameStatus;
-
-    struct Frame {
-        GstBuffer *buffer;
-        FrameStatus status;
-        bool is_new;
-        GstClockTime position;
-        std::mutex access;
-
-        Frame() {
-            buffer = NULL;
-            is_new = false;
-            status = INVALID;
-            position = GST_CLOCK_TIME_NONE;
-        }
-    };
-    Frame frame_[N_FRAME];
-    guint write_index_;
-    guint last_index_;
-    std::mutex index_lock_;
+    FrameRing frames_;
 
     // for PBO
-    guint pbo_[2];
-    guint pbo_index_, pbo_next_index_;
-    guint pbo_size_;
+    TextureUploader *uploader_;
+
+    // for GPU colorspace conversion
+    bool yuv_texturing_;
+    YuvConverter *yuv_;
 
     // gst pipeline control
     virtual void execute_open();
@@ -243,9 +242,10 @@ protected:
 
     // gst frame filling
     bool textureinitialized_;
-    void init_texture(guint index);
-    void fill_texture(guint index);
-    bool fill_frame(GstBuffer *buf, FrameStatus status);
+    void init_texture(GstBuffer *buf);
+    void fill_texture(GstBuffer *buf);
+    bool fill_frame(GstBuffer *buf, FrameRing::Status status, GstCaps *caps = NULL);
+    void update_video_info(GstCaps *caps);
     std::condition_variable initialized_;
     static void timeout_initialize(Stream *str);
 
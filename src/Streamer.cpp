@@ -43,6 +43,7 @@
 #include "Log.h"
 #include "Connection.h"
 #include "NetworkToolkit.h"
+#include "SharedEncoder.h"
 
 #include "Streamer.h"
 
@@ -386,15 +387,22 @@ std::string VideoStreamer::init(GstCaps *caps)
     }
 
     // create a gstreamer pipeline
-    std::string description = "appsrc name=src ! videoconvert ! ";
+    std::string description = "appsrc name=src ! ";
 
     // prevent eroneous protocol values
     if (config_.protocol < 0 || config_.protocol >= NetworkToolkit::DEFAULT)
         config_.protocol = NetworkToolkit::UDP_RAW;
 
+    // special case H264: can use a shared encoder
+    bool shared = config_.protocol == NetworkToolkit::UDP_H264 && SharedEncoder::enabled();
+    if (shared)
+        description += "h264parse ! rtph264pay aggregate-mode=1 ! udpsink name=sink";
+    else
+        description += "videoconvert ! ";
+
     // special case H264: can be Hardware accelerated
-    bool found_harware_acceleration = false;
-    if (config_.protocol == NetworkToolkit::UDP_H264 && Settings::application.render.gpu_decoding) {
+    bool found_harware_acceleration = shared;
+    if (!shared && config_.protocol == NetworkToolkit::UDP_H264 && Settings::application.render.gpu_decoding) {
         for (auto config = NetworkToolkit::stream_h264_send_pipeline.cbegin();
              config != NetworkToolkit::stream_h264_send_pipeline.cend() && !found_harware_acceleration; ++config) {
             if ( GstToolkit::has_feature(config->first) ) {
@@ -457,9 +465,15 @@ std::string VideoStreamer::init(GstCaps *caps)
         gst_caps_set_value(tmp, "framerate", &v);
         g_value_unset (&v);
 
-        // instruct src to use the caps
+        // instruct src to use the caps (encoded caps if shared)
         caps_ = gst_caps_copy( tmp );
-        gst_app_src_set_caps (src_, caps_);
+        if (shared) {
+            GstCaps *encoded = gst_caps_from_string( SharedEncoder::format() );
+            gst_app_src_set_caps (src_, encoded);
+            gst_caps_unref (encoded);
+        }
+        else
+            gst_app_src_set_caps (src_, caps_);
         gst_caps_unref (tmp);
 
         // setup callbacks
@@ -480,6 +494,10 @@ std::string VideoStreamer::init(GstCaps *caps)
         return std::string("Video Streamer : Failed to start frame grabber.");
     }
 
+    // receive frames from the shared encoder
+    if (shared)
+        SharedEncoder::subscribe(this, STREAMING_FPS);
+
     // all good
     initialized_ = true;
 
@@ -0,0 +1,162 @@
+/*
+ * This file is part of vimix - video live mixer
+ *
+ * **Copyright** (C) 2019-2023 Bruno Herbelin <bruno.herbelin@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include <cstring>
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#include "Log.h"
+
+#include "TextureUploader.h"
+
+// maximum time to wait for the GPU to release a buffer (ns)
+#define TEXTURE_UPLOADER_TIMEOUT 100000000
+
+TextureUploader::TextureUploader(guint depth) : depth_(MAX(depth, 1)), size_(0), index_(0),
+    persistent_(false), upload_time_(0.0)
+{
+
+}
+
+TextureUploader::~TextureUploader()
+{
+    release();
+}
+
+void TextureUploader::release()
+{
+    for (guint i = 0; i < buffers_.size(); ++i) {
+        if (fences_[i])
+            glDeleteSync( (GLsync) fences_[i] );
+        if (mapped_[i]) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers_[i]);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (!buffers_.empty())
+        glDeleteBuffers(buffers_.size(), buffers_.data());
+
+    buffers_.clear();
+    fences_.clear();
+    mapped_.clear();
+    size_ = 0;
+}
+
+void TextureUploader::allocate(bool persistent)
+{
+    persistent_ = persistent;
+    buffers_.resize(depth_, 0);
+    fences_.resize(depth_, nullptr);
+    mapped_.resize(depth_, nullptr);
+
+    glGenBuffers(depth_, buffers_.data());
+    for (guint i = 0; i < depth_; ++i) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers_[i]);
+        if (persistent_) {
+            // immutable storage, mapped once for all
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_PIXEL_UNPACK_BUFFER, size_, 0, flags);
+            mapped_[i] = (guint8 *) glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size_, flags);
+        }
+        else
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, size_, 0, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    index_ = 0;
+}
+
+void TextureUploader::configure(guint size)
+{
+    if (size == size_ && !buffers_.empty())
+        return;
+
+    release();
+    size_ = size;
+    if (size_ < 1)
+        return;
+
+    // use persistent mapping if available
+    allocate( GLAD_GL_ARB_buffer_storage && glBufferStorage != nullptr );
+
+    // fallback to map & unmap if persistent mapping failed
+    if (persistent_ && std::find(mapped_.begin(), mapped_.end(), nullptr) != mapped_.end()) {
+        release();
+        size_ = size;
+        allocate(false);
+    }
+}
+
+bool TextureUploader::bind(const guint8 *data, guint size)
+{
+    if (buffers_.empty() || size != size_ || data == nullptr)
+        return false;
+
+    start_ = std::chrono::steady_clock::now();
+
+    // next buffer in ring
+    index_ = (index_ + 1) % depth_;
+
+    // wait for the GPU to be done with previous upload from this buffer
+    if (fences_[index_]) {
+        GLsync fence = (GLsync) fences_[index_];
+        if ( glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, TEXTURE_UPLOADER_TIMEOUT) == GL_TIMEOUT_EXPIRED )
+            Log::Warning("Texture upload waited more than %d ms for GPU.", TEXTURE_UPLOADER_TIMEOUT / 1000000);
+        glDeleteSync(fence);
+        fences_[index_] = nullptr;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers_[index_]);
+
+    if (persistent_) {
+        // write directly into the mapped buffer
+        memcpy(mapped_[index_], data, size_);
+    }
+    else {
+#ifdef USE_GL_BUFFER_SUBDATA
+        glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, size_, data);
+#else
+        // the fence guarantees the buffer is not in use: no need to synchronize
+        GLubyte* ptr = (GLubyte*) glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size_,
+                                                   GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        if (ptr == nullptr) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return false;
+        }
+        memcpy(ptr, data, size_);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+#endif
+    }
+
+    return true;
+}
+
+void TextureUploader::unbind()
+{
+    // protect buffer from being written before GPU has read it
+    fences_[index_] = (void *) glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    // smoothed measure of time spent uploading
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start_;
+    upload_time_ = upload_time_ > 0.0 ? 0.9 * upload_time_ + 0.1 * elapsed.count() : elapsed.count();
+}
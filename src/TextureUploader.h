@@ -0,0 +1,59 @@
+#ifndef TEXTUREUPLOADER_H
+#define TEXTUREUPLOADER_H
+
+#include <vector>
+#include <chrono>
+
+#include <glib.h>
+
+#define TEXTURE_UPLOADER_DEPTH 3
+
+/**
+ * @brief The TextureUploader copies video frames into a ring of
+ * OpenGL Pixel Buffer Objects to upload them asynchronously into textures.
+ *
+ * Each buffer is guarded by a fence, so that it is written again only once
+ * the GPU finished reading it. When the OpenGL driver supports it, the
+ * buffers are persistently mapped, avoiding to map and unmap every frame.
+ *
+ * The time spent uploading is measured to identify sources blocking rendering.
+ */
+class TextureUploader
+{
+public:
+    TextureUploader(guint depth = TEXTURE_UPLOADER_DEPTH);
+    ~TextureUploader();
+
+    // (re)allocate pixel buffers for frames of given size (bytes)
+    // Must be called in OpenGL context
+    void configure(guint size);
+    inline guint size() const { return size_; }
+    inline bool persistent() const { return persistent_; }
+
+    // Copy data in the next pixel buffer and bind it for unpacking; the caller then
+    // reads pixels from offset 0 (e.g. glTexSubImage2D) and calls unbind().
+    // Returns false (nothing bound) if data cannot be uploaded
+    // Must be called in OpenGL context
+    bool bind(const guint8 *data, guint size);
+    void unbind();
+
+    // average time spent uploading a frame, in milliseconds
+    inline double uploadTime() const { return upload_time_; }
+
+private:
+    void allocate(bool persistent);
+    void release();
+
+    guint depth_;
+    guint size_;
+    guint index_;
+    bool persistent_;
+    std::vector<guint> buffers_;
+    std::vector<void *> fences_;
+    std::vector<guint8 *> mapped_;
+
+    std::chrono::steady_clock::time_point start_;
+    double upload_time_;
+};
+
+#endif // TEXTUREUPLOADER_H
@@ -0,0 +1,144 @@
+/*
+ * This file is part of vimix - video live mixer
+ *
+ * **Copyright** (C) 2019-2024 Bruno Herbelin <bruno.herbelin@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include <algorithm>
+
+#include "ThreadPool.h"
+
+
+ThreadPool::ThreadPool() : count_(0), next_(0), running_(0), batch_(0), terminate_(false)
+{
+    // keep one core for the calling thread
+    unsigned int n = std::thread::hardware_concurrency();
+    n = n > 1 ? std::min(n - 1, (unsigned int) MAX_WORKER_THREADS) : 0;
+
+    for (unsigned int i = 0; i < n; ++i)
+        workers_.emplace_back(ThreadPool::work, this);
+
+    // at least one background thread
+    n = std::max(std::min(n / 2, (unsigned int) MAX_BACKGROUND_THREADS), 1u);
+    for (unsigned int i = 0; i < n; ++i)
+        background_.emplace_back(ThreadPool::serve, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    // stop all workers
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<std::mutex> lock_tasks(tasks_mutex_);
+        terminate_ = true;
+    }
+    wakeup_.notify_all();
+    tasks_wakeup_.notify_all();
+
+    for (auto it = workers_.begin(); it != workers_.end(); ++it)
+        it->join();
+    for (auto it = background_.begin(); it != background_.end(); ++it)
+        it->join();
+}
+
+void ThreadPool::run()
+{
+    // take the next job index until all were taken
+    size_t i = next_++;
+    while ( i < count_ ) {
+        job_(i);
+        i = next_++;
+    }
+}
+
+void ThreadPool::work(ThreadPool *pool)
+{
+    uint64_t batch = 0;
+
+    std::unique_lock<std::mutex> lock(pool->mutex_);
+    while (true) {
+        // wait for a new batch of jobs
+        pool->wakeup_.wait(lock, [&]{ return pool->terminate_ || pool->batch_ != batch; });
+        if (pool->terminate_)
+            break;
+        batch = pool->batch_;
+
+        // do jobs
+        lock.unlock();
+        pool->run();
+        lock.lock();
+
+        // inform caller when last worker finished
+        if ( --pool->running_ == 0 )
+            pool->done_.notify_one();
+    }
+}
+
+void ThreadPool::parallel_for(size_t count, std::function<void(size_t)> job)
+{
+    // not worth dispatching
+    if ( workers_.empty() || count < 2 ) {
+        for (size_t i = 0; i < count; ++i)
+            job(i);
+        return;
+    }
+
+    // set new batch and wakeup workers
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = job;
+        count_ = count;
+        next_ = 0;
+        running_ = workers_.size();
+        ++batch_;
+    }
+    wakeup_.notify_all();
+
+    // the calling thread works too
+    run();
+
+    // wait for all workers to end
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&]{ return running_ == 0; });
+    job_ = nullptr;
+}
+
+void ThreadPool::enqueue(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex_);
+        tasks_.push_back( std::move(task) );
+    }
+    tasks_wakeup_.notify_one();
+}
+
+void ThreadPool::serve(ThreadPool *pool)
+{
+    std::unique_lock<std::mutex> lock(pool->tasks_mutex_);
+    while (true) {
+        // wait for a task
+        pool->tasks_wakeup_.wait(lock, [&]{ return pool->terminate_ || !pool->tasks_.empty(); });
+        if (pool->terminate_)
+            break;
+        std::function<void()> task = std::move( pool->tasks_.front() );
+        pool->tasks_.pop_front();
+
+        // do task
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define MAX_WORKER_THREADS 16
+#define MAX_BACKGROUND_THREADS 4
+
+/**
+ * @brief The ThreadPool class runs jobs in parallel on a fixed set of worker threads
+ *
+ * parallel_for(count, job) calls job(i) for every i in [0, count[
+ * on the workers and on the calling thread, and returns when all are done.
+ *
+ * async(task) runs task on one of a few background threads, in order
+ * of submission, and gives its result in a std::future.
+ *
+ * Jobs are executed outside of the rendering thread: they shall not
+ * use OpenGL, and shall not call parallel_for.
+ */
+class ThreadPool
+{
+    // Private Constructor
+    ThreadPool();
+    ThreadPool(ThreadPool const& copy) = delete;
+    ThreadPool& operator=(ThreadPool const& copy) = delete;
+
+public:
+
+    static ThreadPool& manager ()
+    {
+        // The only instance
+        static ThreadPool _instance;
+        return _instance;
+    }
+    ~ThreadPool();
+
+    // number of worker threads
+    inline size_t size () const { return workers_.size(); }
+
+    // blocking call of job(i), for i from 0 to count-1
+    void parallel_for (size_t count, std::function<void(size_t)> job);
+
+    // non-blocking call of task(), with its result given in the future
+    template<typename F>
+    auto async (F &&task) -> std::future<decltype(task())>
+    {
+        auto t = std::make_shared< std::packaged_task<decltype(task())()> >( std::forward<F>(task) );
+        auto ret = t->get_future();
+        enqueue( [t]{ (*t)(); } );
+        return ret;
+    }
+
+private:
+    void run ();
+    static void work (ThreadPool *pool);
+    void enqueue (std::function<void()> task);
+    static void serve (ThreadPool *pool);
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::condition_variable done_;
+    std::function<void(size_t)> job_;
+    size_t count_;
+    std::atomic<size_t> next_;
+    size_t running_;
+    uint64_t batch_;
+    bool terminate_;
+
+    std::vector<std::thread> background_;
+    std::mutex tasks_mutex_;
+    std::condition_variable tasks_wakeup_;
+    std::deque< std::function<void()> > tasks_;
+};
+
+#endif // THREADPOOL_H
@@ -253,8 +253,15 @@ void TimerMetronomeWindow::Render()
             ImGui::SetCursorScreenPos(circle_botom_right);
             ImGuiToolkit::Icon(16, 5, np > 0);
             if (ImGui::IsItemHovered()){
-                snprintf(text_buf, 24, np < 1 ? "Ableton Link\nNo peer" : "Ableton Link\n%d peer%c", np, np < 2 ? ' ' : 's' );
-                ImGuiToolkit::ToolTip(text_buf);
+                std::string tooltip = np < 1 ? "Ableton Link\nNo peer" : "Ableton Link\n" + std::to_string(np) + (np < 2 ? " peer" : " peers");
+                // delay of execution of synchronized actions
+                Metronome::Statistics stats = Metronome::manager().statistics();
+                if (stats.count > 0) {
+                    char stats_buf[64];
+                    snprintf(stats_buf, 64, "\nSync delay %.2f ms (jitter %.2f ms)", stats.mean / 1000.0, stats.jitter / 1000.0);
+                    tooltip += stats_buf;
+                }
+                ImGuiToolkit::ToolTip(tooltip.c_str());
             }
         }
 
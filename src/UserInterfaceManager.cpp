@@ -27,6 +27,7 @@
 #include <sstream>
 #include <fstream>
 #include <regex>
+#include <algorithm>
 
 // ImGui
 #include "imgui.h"
@@ -51,6 +52,7 @@
 
 #include "defines.h"
 #include "Settings.h"
+#include "DelayFilter.h"
 #include "Log.h"
 #include "SystemToolkit.h"
 #include "DialogToolkit.h"
@@ -63,6 +65,7 @@
 #include "ControlManager.h"
 #include "ActionManager.h"
 #include "Resource.h"
+#include "Shader.h"
 #include "Connection.h"
 #include "SessionCreator.h"
 #include "Mixer.h"
@@ -79,6 +82,7 @@
 #include "MousePointer.h"
 #include "Playlist.h"
 #include "Audio.h"
+#include "Profiler.h"
 
 #include "UserInterfaceManager.h"
 
@@ -87,6 +91,7 @@
 void ShowAboutGStreamer(bool* p_open);
 void ShowAboutOpengl(bool* p_open);
 void ShowSandbox(bool* p_open);
+void ShowProfiler(bool* p_open);
 void SetMouseCursor(ImVec2 mousepos, View::Cursor c = View::Cursor());
 
 
@@ -868,6 +873,8 @@ void Spinner(const ImU32 &color)
 
 void UserInterface::NewFrame()
 {
+    PROFILE_SCOPE("ui", "new frame");
+
     // Start the Dear ImGui frame
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
@@ -953,6 +960,8 @@ void UserInterface::NewFrame()
 
 void UserInterface::Render()
 {
+    PROFILE_SCOPE("ui", "render");
+
     // navigator bar first
     navigator.Render();
 
@@ -1503,7 +1512,9 @@ enum MetricsFlags_
     Metrics_gpu        = 4,
     Metrics_session    = 8,
     Metrics_runtime    = 16,
-    Metrics_lifetime   = 32
+    Metrics_lifetime   = 32,
+    Metrics_nodes      = 64,
+    Metrics_uniforms   = 128
 };
 
 void UserInterface::RenderMetrics(bool *p_open, int* p_corner, int *p_mode)
@@ -1635,6 +1646,38 @@ void UserInterface::RenderMetrics(bool *p_open, int* p_corner, int *p_mode)
             ImGuiToolkit::ToolTip("Accumulated runtime of vimix\nsince its installation");
     }
 
+    if (*p_mode & Metrics_nodes) {
+        // count of node transforms computed since previous frame
+        static uint previous_count = 0;
+        uint count = Node::transform_updates_;
+        ImGuiToolkit::PushFont(ImGuiToolkit::FONT_BOLD);
+        snprintf(dummy_str, 256, "%u", count - previous_count);
+        ImGui::SetNextItemWidth(_width);
+        ImGui::InputText("##dummy4", dummy_str, IM_ARRAYSIZE(dummy_str), ImGuiInputTextFlags_ReadOnly);
+        ImGui::PopFont();
+        ImGui::SameLine(0, IMGUI_SAME_LINE);
+        ImGui::Text("Nodes");
+        if (ImGui::IsItemHovered())
+            ImGuiToolkit::ToolTip("Number of nodes which transform\nchanged in the last frame");
+        previous_count = count;
+    }
+
+    if (*p_mode & Metrics_uniforms) {
+        // count of glUniform calls since previous frame
+        static uint previous_count = 0;
+        uint count = ShadingProgram::uniform_calls_;
+        ImGuiToolkit::PushFont(ImGuiToolkit::FONT_BOLD);
+        snprintf(dummy_str, 256, "%u", count - previous_count);
+        ImGui::SetNextItemWidth(_width);
+        ImGui::InputText("##dummy5", dummy_str, IM_ARRAYSIZE(dummy_str), ImGuiInputTextFlags_ReadOnly);
+        ImGui::PopFont();
+        ImGui::SameLine(0, IMGUI_SAME_LINE);
+        ImGui::Text("Uniforms");
+        if (ImGui::IsItemHovered())
+            ImGuiToolkit::ToolTip("Number of shader uniforms\nuploaded in the last frame");
+        previous_count = count;
+    }
+
     ImGui::PopStyleVar();
 
     if (ImGui::BeginPopup("metrics_menu"))
@@ -1653,6 +1696,10 @@ void UserInterface::RenderMetrics(bool *p_open, int* p_corner, int *p_mode)
             *p_mode ^= Metrics_runtime;
         if (ImGui::MenuItem( "Lifetime", NULL, *p_mode & Metrics_lifetime))
             *p_mode ^= Metrics_lifetime;
+        if (ImGui::MenuItem( "Nodes updated", NULL, *p_mode & Metrics_nodes))
+            *p_mode ^= Metrics_nodes;
+        if (ImGui::MenuItem( "Uniforms uploaded", NULL, *p_mode & Metrics_uniforms))
+            *p_mode ^= Metrics_uniforms;
 
         ImGui::Separator();
 
@@ -1724,7 +1771,7 @@ void UserInterface::RenderSourceToolbar(bool *p_open, int* p_border, int *p_mode
                 if (ImGuiToolkit::TextButton( ICON_FA_BULLSEYE , "Alpha")) {
                     s->call(new SetAlpha(1.f), true);
                     info << "Alpha " << std::fixed << std::setprecision(3) << 0.f;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Alpha");
                 }
                 ImGui::SameLine(0, IMGUI_SAME_LINE);
                 ImGui::SetNextItemWidth(sliderwidth);
@@ -1734,11 +1781,11 @@ void UserInterface::RenderSourceToolbar(bool *p_open, int* p_border, int *p_mode
                     v = CLAMP(v + 0.1f * io.MouseWheel, 0.f, 100.f);
                     s->call(new SetAlpha(v*0.01f), true);
                     info << "Alpha " << std::fixed << std::setprecision(3) << v*0.01f;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Alpha");
                 }
                 if ( ImGui::IsItemDeactivatedAfterEdit() ) {
                     info << "Alpha " << std::fixed << std::setprecision(3) << v*0.01f;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Alpha");
                 }
 
                 ImGui::SameLine(0, IMGUI_SAME_LINE);
@@ -1752,7 +1799,7 @@ void UserInterface::RenderSourceToolbar(bool *p_open, int* p_border, int *p_mode
                     n->translation_.y = 0.f;
                     s->touch();
                     info << "Position " << std::setprecision(3) << n->translation_.x << ", " << n->translation_.y;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Position");
                 }
                 // Position X
                 v = n->translation_.x * (0.5f * out.y);
@@ -1767,11 +1814,11 @@ void UserInterface::RenderSourceToolbar(bool *p_open, int* p_border, int *p_mode
                     n->translation_.x = v / (0.5f * out.y);
                     s->touch();
                     info << "Position " << std::setprecision(3) << n->translation_.x << ", " << n->translation_.y;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Position");
                 }
                 if ( ImGui::IsItemDeactivatedAfterEdit() ){
                     info << "Position " << std::setprecision(3) << n->translation_.x << ", " << n->translation_.y;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Position");
                 }
                 // Position Y
                 v = n->translation_.y * (0.5f * out.y);
@@ -1786,11 +1833,11 @@ void UserInterface::RenderSourceToolbar(bool *p_open, int* p_border, int *p_mode
                     n->translation_.y = v / (0.5f * out.y);
                     s->touch();
                     info << "Position " << std::setprecision(3) << n->translation_.x << ", " << n->translation_.y;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Position");
                 }
                 if ( ImGui::IsItemDeactivatedAfterEdit() ){
                     info << "Position " << std::setprecision(3) << n->translation_.x << ", " << n->translation_.y;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Position");
                 }
                 ImGui::SameLine(0, IMGUI_SAME_LINE);
                 ImGui::Text("|");
@@ -1804,7 +1851,7 @@ void UserInterface::RenderSourceToolbar(bool *p_open, int* p_border, int *p_mode
                     n->scale_.y = 1.f;
                     s->touch();
                     info << "Scale " << std::setprecision(3) << n->scale_.x << ", " << n->scale_.y;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Scale");
                 }
                 float ar_scale = n->scale_.x / n->scale_.y;
                 // SCALE X
@@ -1826,11 +1873,11 @@ void UserInterface::RenderSourceToolbar(bool *p_open, int* p_border, int *p_mode
                         n->scale_.y = n->scale_.x / ar_scale;
                     s->touch();
                     info << "Scale " << std::setprecision(3) << n->scale_.x << " x " << n->scale_.y;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Scale");
                 }
                 if ( ImGui::IsItemDeactivatedAfterEdit() ){
                     info << "Scale " << std::setprecision(3) << n->scale_.x << " x " << n->scale_.y;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Scale");
                 }
                 // SCALE LOCK ASPECT RATIO
                 ImGui::SameLine(0, 0);
@@ -1856,11 +1903,11 @@ void UserInterface::RenderSourceToolbar(bool *p_open, int* p_border, int *p_mode
                         n->scale_.x = n->scale_.y * ar_scale;
                     s->touch();
                     info << "Scale " << std::setprecision(3) << n->scale_.x << " x " << n->scale_.y;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Scale");
                 }
                 if ( ImGui::IsItemDeactivatedAfterEdit() ){
                     info << "Scale " << std::setprecision(3) << n->scale_.x << " x " << n->scale_.y;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Scale");
                 }
 
                 ImGui::SameLine(0, IMGUI_SAME_LINE);
@@ -1874,7 +1921,7 @@ void UserInterface::RenderSourceToolbar(bool *p_open, int* p_border, int *p_mode
                     n->rotation_.z = 0.f;
                     s->touch();
                     info << "Angle " << std::setprecision(3) << n->rotation_.z * 180.f / M_PI;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Angle");
                 }
                 float v_deg = n->rotation_.z * 360.0f / (2.f*M_PI);
                 ImGui::SameLine(0, IMGUI_SAME_LINE);
@@ -1888,11 +1935,11 @@ void UserInterface::RenderSourceToolbar(bool *p_open, int* p_border, int *p_mode
                     n->rotation_.z = v_deg * (2.f*M_PI) / 360.0f;
                     s->touch();
                     info << "Angle " << std::setprecision(3) << n->rotation_.z * 180.f / M_PI;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Angle");
                 }
                 if ( ImGui::IsItemDeactivatedAfterEdit() ) {
                     info << "Angle " << std::setprecision(3) << n->rotation_.z * 180.f / M_PI;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Angle");
                 }
 
                 ImGui::SameLine(0, 2 * IMGUI_SAME_LINE);
@@ -1950,17 +1997,17 @@ void UserInterface::RenderSourceToolbar(bool *p_open, int* p_border, int *p_mode
                     v = CLAMP(v + 0.1f * io.MouseWheel, 0.f, 100.f);
                     s->call(new SetAlpha(v*0.01f), true);
                     info << "Alpha " << std::fixed << std::setprecision(3) << v*0.01f;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Alpha");
                 }
                 if ( ImGui::IsItemDeactivatedAfterEdit() ) {
                     info << "Alpha " << std::fixed << std::setprecision(3) << v*0.01f;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Alpha");
                 }
                 ImGui::SameLine(0, IMGUI_SAME_LINE);
                 if (ImGuiToolkit::TextButton("Alpha")) {
                     s->call(new SetAlpha(1.f), true);
                     info << "Alpha " << std::fixed << std::setprecision(3) << 0.f;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Alpha");
                 }
 
                 //
@@ -1978,11 +2025,11 @@ void UserInterface::RenderSourceToolbar(bool *p_open, int* p_border, int *p_mode
                     n->translation_.x = v / (0.5f * out.y);
                     s->touch();
                     info << "Position " << std::setprecision(3) << n->translation_.x << ", " << n->translation_.y;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Position");
                 }
                 if ( ImGui::IsItemDeactivatedAfterEdit() ){
                     info << "Position " << std::setprecision(3) << n->translation_.x << ", " << n->translation_.y;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Position");
                 }
                 // Position Y
                 v = n->translation_.y * (0.5f * out.y);
@@ -1997,11 +2044,11 @@ void UserInterface::RenderSourceToolbar(bool *p_open, int* p_border, int *p_mode
                     n->translation_.y = v / (0.5f * out.y);
                     s->touch();
                     info << "Position " << std::setprecision(3) << n->translation_.x << ", " << n->translation_.y;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Position");
                 }
                 if ( ImGui::IsItemDeactivatedAfterEdit() ){
                     info << "Position " << std::setprecision(3) << n->translation_.x << ", " << n->translation_.y;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Position");
                 }
                 ImGui::SameLine(0, IMGUI_SAME_LINE);
                 if (ImGuiToolkit::TextButton("Pos")) {
@@ -2009,7 +2056,7 @@ void UserInterface::RenderSourceToolbar(bool *p_open, int* p_border, int *p_mode
                     n->translation_.y = 0.f;
                     s->touch();
                     info << "Position " << std::setprecision(3) << n->translation_.x << ", " << n->translation_.y;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Position");
                 }
 
                 //
@@ -2034,11 +2081,11 @@ void UserInterface::RenderSourceToolbar(bool *p_open, int* p_border, int *p_mode
                         n->scale_.y = n->scale_.x / ar_scale;
                     s->touch();
                     info << "Scale " << std::setprecision(3) << n->scale_.x << " x " << n->scale_.y;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Scale");
                 }
                 if ( ImGui::IsItemDeactivatedAfterEdit() ){
                     info << "Scale " << std::setprecision(3) << n->scale_.x << " x " << n->scale_.y;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Scale");
                 }
                 // SCALE LOCK ASPECT RATIO
                 ImGui::SameLine(0, 0);
@@ -2064,11 +2111,11 @@ void UserInterface::RenderSourceToolbar(bool *p_open, int* p_border, int *p_mode
                         n->scale_.x = n->scale_.y * ar_scale;
                     s->touch();
                     info << "Scale " << std::setprecision(3) << n->scale_.x << " x " << n->scale_.y;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Scale");
                 }
                 if ( ImGui::IsItemDeactivatedAfterEdit() ){
                     info << "Scale " << std::setprecision(3) << n->scale_.x << " x " << n->scale_.y;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Scale");
                 }
                 ImGui::SameLine(0, IMGUI_SAME_LINE);
                 if (ImGuiToolkit::TextButton("Size")) {
@@ -2076,7 +2123,7 @@ void UserInterface::RenderSourceToolbar(bool *p_open, int* p_border, int *p_mode
                     n->scale_.y = 1.f;
                     s->touch();
                     info << "Scale " << std::setprecision(3) << n->scale_.x << ", " << n->scale_.y;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Scale");
                 }
 
                 //
@@ -2093,18 +2140,18 @@ void UserInterface::RenderSourceToolbar(bool *p_open, int* p_border, int *p_mode
                     n->rotation_.z = v_deg * (2.f*M_PI) / 360.0f;
                     s->touch();
                     info << "Angle " << std::setprecision(3) << n->rotation_.z * 180.f / M_PI;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Angle");
                 }
                 if ( ImGui::IsItemDeactivatedAfterEdit() ) {
                     info << "Angle " << std::setprecision(3) << n->rotation_.z * 180.f / M_PI;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Angle");
                 }
                 ImGui::SameLine(0, IMGUI_SAME_LINE);
                 if (ImGuiToolkit::TextButton("Angle")) {
                     n->rotation_.z = 0.f;
                     s->touch();
                     info << "Angle " << std::setprecision(3) << n->rotation_.z * 180.f / M_PI;
-                    Action::manager().store(info.str());
+                    Action::manager().store(info.str(), s->id(), "Angle");
                 }
 
                 ImGui::PopStyleVar();
@@ -2312,6 +2359,7 @@ ToolBox::ToolBox()
     show_demo_window = false;
     show_icons_window = false;
     show_sandbox = false;
+    show_profiler = false;
 }
 
 void ToolBox::Render()
@@ -2356,6 +2404,10 @@ void ToolBox::Render()
                 else
                     csv_file_.close();
             }
+            if (ImGui::MenuItem("Profiler", nullptr, &show_profiler) )
+                Profiler::manager().setEnabled(show_profiler);
+            if (ImGui::MenuItem("Trace 10 s", nullptr, false, !Profiler::manager().tracing()) )
+                Profiler::manager().trace(10.f);
             ImGui::EndMenu();
         }
         ImGui::EndMenuBar();
@@ -2445,6 +2497,10 @@ void ToolBox::Render()
         ImGuiToolkit::ShowIconsWindow(&show_icons_window);
     if (show_sandbox)
         ShowSandbox(&show_sandbox);
+    if (show_profiler) {
+        ShowProfiler(&show_profiler);
+        Profiler::manager().setEnabled(show_profiler);
+    }
     if (show_demo_window)
         ImGui::ShowDemoWindow(&show_demo_window);
 
@@ -4982,10 +5038,13 @@ void Navigator::RenderMainPannelSession()
         }
 
         ImGui::SetCursorPos( ImVec2( pannel_width_ IMGUI_RIGHT_ALIGN, pos_bot.y - 2.f * ImGui::GetFrameHeightWithSpacing()));
-        ImGuiToolkit::HelpToolTip("History of actions (latest on top). "
-                                 "Double-clic on an action to restore its status.\n\n"
-                                 ICON_FA_MAP_MARKED_ALT "  Enable Show in view to automatically "
-                                 "navigate to the view when the action is undone/redone.");
+        std::string _history_help = "History of actions (latest on top). "
+                                    "Double-clic on an action to restore its status.\n\n"
+                                    ICON_FA_MAP_MARKED_ALT "  Enable Show in view to automatically "
+                                    "navigate to the view when the action is undone/redone.\n\n"
+                                    "Memory used " + BaseToolkit::byte_to_string( Action::manager().memory() )
+                                    + " / " + BaseToolkit::byte_to_string( (long) Settings::application.action_history_memory * 1048576 );
+        ImGuiToolkit::HelpToolTip(_history_help.c_str());
         // toggle button for shhow in view
         ImGui::SetCursorPos( ImVec2( pannel_width_ IMGUI_RIGHT_ALIGN, pos_bot.y - ImGui::GetFrameHeightWithSpacing()) );
         ImGuiToolkit::ButtonToggle(ICON_FA_MAP_MARKED_ALT, &Settings::application.action_history_follow_view, "Show in view");
@@ -5740,6 +5799,19 @@ void Navigator::RenderMainPannelSettings()
     if (ImGuiToolkit::TextButton("Priority"))
         Settings::application.record.priority_mode = 0;
 
+    ImGuiToolkit::Indication("Convert frames to YUV 4:2:0 with the graphics card before "
+                             "recording or streaming; reduces the load on the CPU "
+                             "(only for RGB output with a width multiple of 8). "
+                             "Shared memory and loopback outputs remain in RGB.", ICON_FA_MICROCHIP);
+    ImGui::SameLine(0);
+    ImGuiToolkit::ButtonSwitch( "GPU color conversion", &Settings::application.record.gpu_conversion);
+
+    ImGuiToolkit::Indication("Encode frames only once in H264 when recording "
+                             "(H264 Realtime without audio), broadcasting and "
+                             "streaming at the same framerate.", ICON_FA_LINK);
+    ImGui::SameLine(0);
+    ImGuiToolkit::ButtonSwitch( "Shared encoder", &Settings::application.record.shared_encoding);
+
     //
     // AUDIO
     //
@@ -5955,10 +6027,42 @@ void Navigator::RenderMainPannelSettings()
     }
     ImGui::Spacing();
 
+    // memory for long delays
+    char delaybuf[512];
+    snprintf(delaybuf, 512, "RAM reserved for delays longer than %.0f s;\n"
+             "%lu MB currently used.", DELAY_FILTER_GPU_MAX,
+             (unsigned long) (DelayFilter::memory() / 1048576));
+    ImGuiToolkit::Indication(delaybuf, ICON_FILTER_DELAY);
+    ImGui::SameLine(0);
+    ImGui::SetCursorPosX(width_);
+    ImGui::SetNextItemWidth(IMGUI_RIGHT_ALIGN);
+    ImGui::SliderInt("##DelayMemory", &Settings::application.render.delay_memory, 64, 16384, "%d MB", ImGuiSliderFlags_Logarithmic);
+    ImGui::SameLine(0, IMGUI_SAME_LINE);
+    if (ImGuiToolkit::TextButton("Delay RAM"))
+        Settings::application.render.delay_memory = 2048;
+    ImGuiToolkit::Indication("If enabled, frames of long delays are compressed in JPEG "
+                             "(uses more CPU, but much less RAM).", ICON_FA_COMPRESS_ALT);
+    ImGui::SameLine(0);
+    ImGuiToolkit::ButtonSwitch( "Compress delays", &Settings::application.render.delay_compression);
+    ImGuiToolkit::Indication("If enabled, sources playing the same video file with the same "
+                             "timeline and speed share one decoder.", ICON_FA_CLONE);
+    ImGui::SameLine(0);
+    ImGuiToolkit::ButtonSwitch( "Shared decoding", &Settings::application.render.shared_decoding);
+    ImGuiToolkit::Indication("If enabled, pattern sources are generated by the graphics card "
+                             "instead of gstreamer (applies to new patterns).", ICON_SOURCE_PATTERN);
+    ImGui::SameLine(0);
+    ImGuiToolkit::ButtonSwitch( "GPU patterns", &Settings::application.render.gpu_patterns);
+    ImGuiToolkit::Indication("If enabled, sessions are saved in a compact binary format "
+                             "that loads faster (same .mix extension, not readable as text).", ICON_FA_FILE_ARCHIVE);
+    ImGui::SameLine(0);
+    ImGuiToolkit::ButtonSwitch( "Binary sessions", &Settings::application.save_binary);
+    ImGui::Spacing();
+
     static bool need_restart = false;
     static bool vsync = (Settings::application.render.vsync > 0);
     static bool multi = (Settings::application.render.multisampling > 0);
     static bool gpu = Settings::application.render.gpu_decoding;
+    static bool yuv = Settings::application.render.yuv_texturing;
     static bool audio = Settings::application.accept_audio;
     bool change = false;
     // hardware support deserves more explanation
@@ -5970,6 +6074,12 @@ void Navigator::RenderMainPannelSettings()
     else
         ImGui::TextDisabled("Hardware en/decoding unavailable");
 
+    // YUV texturing deserves more explanation
+    ImGuiToolkit::Indication("If enabled, videos are decoded in YUV and converted "
+                             "to RGB by the graphics card (faster, but without alpha).", yuv ? 13 : 14, 2);
+    ImGui::SameLine(0);
+    change |= ImGuiToolkit::ButtonSwitch( "GPU color conversion", &yuv);
+
     // audio support deserves more explanation
     ImGuiToolkit::Indication("If enabled, tries to find audio in openned videos "
                              "and allows recording audio.", audio ? ICON_FA_VOLUME_UP : ICON_FA_VOLUME_MUTE);
@@ -5984,6 +6094,7 @@ void Navigator::RenderMainPannelSettings()
         need_restart = ( vsync != (Settings::application.render.vsync > 0) ||
                         multi != (Settings::application.render.multisampling > 0) ||
                         gpu != Settings::application.render.gpu_decoding ||
+                        yuv != Settings::application.render.yuv_texturing ||
                         audio != Settings::application.accept_audio );
     }
     if (need_restart) {
@@ -5992,6 +6103,7 @@ void Navigator::RenderMainPannelSettings()
             Settings::application.render.vsync = vsync ? 1 : 0;
             Settings::application.render.multisampling = multi ? 3 : 0;
             Settings::application.render.gpu_decoding = gpu;
+            Settings::application.render.yuv_texturing = yuv;
             Settings::application.accept_audio = audio;
             if (UserInterface::manager().TryClose())
                 Rendering::manager().close();
@@ -6359,6 +6471,61 @@ void Thumbnail::Render(float width)
 
 #include <glm/gtc/type_ptr.hpp>
 
+void ShowProfiler(bool* p_open)
+{
+    ImGui::SetNextWindowSize(ImVec2(560, 400), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin( ICON_FA_STOPWATCH "  Profiler", p_open))
+    {
+        ImGui::End();
+        return;
+    }
+
+    // scopes sorted by 95th percentile
+    std::vector<Profiler::Statistics> stats = Profiler::manager().statistics();
+    std::sort(stats.begin(), stats.end(), [](const Profiler::Statistics &a, const Profiler::Statistics &b) {
+        return a.p95 > b.p95;
+    });
+
+    ImGui::Text("Time per frame (ms) over the last %d frames", PROFILER_FRAMES);
+    if (Profiler::manager().tracing()) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1.0f,0.6f,0.0f,1.0f), ICON_FA_CIRCLE " tracing");
+    }
+    ImGui::Separator();
+
+    ImGuiToolkit::PushFont(ImGuiToolkit::FONT_MONO);
+    ImGui::Columns(6, "profiler", false);
+    ImGui::SetColumnWidth(0, ImGui::GetWindowWidth() - 5.f * 70.f);
+    for (int c = 1; c < 6; ++c)
+        ImGui::SetColumnWidth(c, 70.f);
+    const char *header[6] = {"Scope", "mean", "p50", "p95", "p99", "max"};
+    for (int c = 0; c < 6; ++c) {
+        ImGui::TextDisabled("%s", header[c]);
+        ImGui::NextColumn();
+    }
+    for (auto s = stats.begin(); s != stats.end(); ++s) {
+        ImGui::Text("%s %s%s", s->category.c_str(), s->name.c_str(), s->gpu ? " (GPU)" : "");
+        ImGui::NextColumn();
+        const float v[5] = { s->mean, s->p50, s->p95, s->p99, s->max };
+        for (int c = 0; c < 5; ++c) {
+            ImGui::Text("%6.2f", v[c]);
+            ImGui::NextColumn();
+        }
+    }
+    ImGui::Columns(1);
+    ImGui::PopFont();
+
+    // OSC control queue, last frame and since start
+    ImGui::Separator();
+    Control::QueueStatistics osc = Control::manager().queueStatistics();
+    ImGui::Text("OSC  %lu packets (%lu messages), latency %.2f ms (max %.2f)",
+                (unsigned long) osc.depth, (unsigned long) osc.messages, osc.latency_mean, osc.latency_max);
+    ImGui::TextDisabled("     %lu received, %lu dropped, %lu coalesced",
+                (unsigned long) osc.received, (unsigned long) osc.dropped, (unsigned long) osc.coalesced);
+
+    ImGui::End();
+}
+
 void ShowSandbox(bool* p_open)
 {
     ImGui::SetNextWindowSize(ImVec2(400, 260), ImGuiCond_FirstUseEver);
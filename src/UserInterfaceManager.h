@@ -122,6 +122,7 @@ class ToolBox
     bool show_demo_window;
     bool show_icons_window;
     bool show_sandbox;
+    bool show_profiler;
 
 public:
     ToolBox();
@@ -30,6 +30,7 @@
 #include "Log.h"
 #include "GstToolkit.h"
 #include "Settings.h"
+#include "SharedEncoder.h"
 
 #include "VideoBroadcast.h"
 
@@ -112,11 +113,16 @@ std::string VideoBroadcast::init(GstCaps *caps)
         return std::string("Video Broadcast : Invalid caps");
 
     // create a gstreamer pipeline
-    std::string description = "appsrc name=src ! videoconvert ! ";
-
-    // complement pipeline with encoder
-    description += VideoBroadcast::srt_encoder_;
-    description += "video/x-h264, profile=high ! queue ! h264parse config-interval=-1 ! mpegtsmux alignment=7 ! ";
+    std::string description = "appsrc name=src ! ";
+
+    // complement pipeline with encoder (unless shared)
+    bool shared = SharedEncoder::enabled();
+    if (!shared) {
+        description += "videoconvert ! ";
+        description += VideoBroadcast::srt_encoder_;
+        description += "video/x-h264, profile=high ! queue ! ";
+    }
+    description += "h264parse config-interval=-1 ! mpegtsmux alignment=7 ! ";
 
     // complement pipeline with sink
     description += VideoBroadcast::srt_sink_ + " name=sink";
@@ -162,9 +168,15 @@ std::string VideoBroadcast::init(GstCaps *caps)
         gst_caps_set_value(tmp, "framerate", &v);
         g_value_unset (&v);
 
-        // instruct src to use the caps
+        // instruct src to use the caps (encoded caps if shared)
         caps_ = gst_caps_copy( tmp );
-        gst_app_src_set_caps (src_, caps_);
+        if (shared) {
+            GstCaps *encoded = gst_caps_from_string( SharedEncoder::format() );
+            gst_app_src_set_caps (src_, encoded);
+            gst_caps_unref (encoded);
+        }
+        else
+            gst_app_src_set_caps (src_, caps_);
         gst_caps_unref (tmp);
 
         // setup callbacks
@@ -185,6 +197,10 @@ std::string VideoBroadcast::init(GstCaps *caps)
         return std::string("Video Broadcast : Failed to start frame grabber.");
     }
 
+    // receive frames from the shared encoder
+    if (shared)
+        SharedEncoder::subscribe(this, BROADCAST_FPS, VideoBroadcast::srt_encoder_ + "video/x-h264, profile=high ! ");
+
     // all good
     initialized_ = true;
 
@@ -0,0 +1,157 @@
+/*
+ * This file is part of vimix - video live mixer
+ *
+ * **Copyright** (C) 2019-2023 Bruno Herbelin <bruno.herbelin@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include <glad/glad.h>
+
+#include "Log.h"
+#include "Shader.h"
+#include "FrameBuffer.h"
+#include "RenderingManager.h"
+
+#include "YuvConverter.h"
+
+YuvConverter::YuvConverter() : width_(0), height_(0), target_(0),
+    framebuffer_(0), vao_(0), conversion_(1.f), program_(nullptr)
+{
+    planes_[0] = planes_[1] = planes_[2] = 0;
+    colorimetry_ = { GST_VIDEO_COLOR_RANGE_UNKNOWN, GST_VIDEO_COLOR_MATRIX_UNKNOWN,
+                     GST_VIDEO_TRANSFER_UNKNOWN, GST_VIDEO_COLOR_PRIMARIES_UNKNOWN };
+}
+
+YuvConverter::~YuvConverter()
+{
+    if (planes_[0])
+        glDeleteTextures(3, planes_);
+    if (framebuffer_)
+        glDeleteFramebuffers(1, &framebuffer_);
+    if (vao_)
+        glDeleteVertexArrays(1, &vao_);
+    if (program_)
+        delete program_;
+}
+
+void YuvConverter::configure(const GstVideoInfo &info, guint target)
+{
+    // first time initialization
+    if (program_ == nullptr) {
+        program_ = new ShadingProgram("shaders/yuv420.vs", "shaders/yuv2rgb.fs");
+        // empty vertex array: the vertex shader generates the vertices
+        glGenVertexArrays(1, &vao_);
+        glGenFramebuffers(1, &framebuffer_);
+    }
+
+    // (re)create one single channel texture per plane
+    if ( width_ != GST_VIDEO_INFO_WIDTH(&info) || height_ != GST_VIDEO_INFO_HEIGHT(&info) ) {
+        width_  = GST_VIDEO_INFO_WIDTH(&info);
+        height_ = GST_VIDEO_INFO_HEIGHT(&info);
+
+        if (planes_[0])
+            glDeleteTextures(3, planes_);
+        glGenTextures(3, planes_);
+        for (guint i = 0; i < 3; ++i) {
+            glBindTexture(GL_TEXTURE_2D, planes_[i]);
+            glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, GST_VIDEO_INFO_COMP_WIDTH(&info, i), GST_VIDEO_INFO_COMP_HEIGHT(&info, i));
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    // attach the target RGBA texture to the framebuffer
+    if ( target_ != target ) {
+        target_ = target;
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target_, 0);
+        if ( glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE )
+            Log::Warning("YUV texture conversion cannot render into texture %d.", target_);
+        FrameBuffer::release();
+    }
+
+    // colorimetry matrix (defaults to BT.601 if unknown)
+    colorimetry_ = GST_VIDEO_INFO_COLORIMETRY(&info);
+    gdouble Kr = 0.299, Kb = 0.114;
+    gst_video_color_matrix_get_Kr_Kb( GST_VIDEO_INFO_COLORIMETRY(&info).matrix, &Kr, &Kb);
+    const gdouble Kg = 1.0 - Kr - Kb;
+    const bool full = GST_VIDEO_INFO_COLORIMETRY(&info).range == GST_VIDEO_COLOR_RANGE_0_255;
+    const float ys = full ? 1.f : 255.f / 219.f;
+    const float yo = full ? 0.f : 16.f / 255.f;
+    const float cs = full ? 1.f : 255.f / 224.f;
+    const float co = 128.f / 255.f;
+    const float rv = cs * 2.0 * (1.0 - Kr);
+    const float gu = cs * 2.0 * Kb * (1.0 - Kb) / Kg;
+    const float gv = cs * 2.0 * Kr * (1.0 - Kr) / Kg;
+    const float bu = cs * 2.0 * (1.0 - Kb);
+    // NB: glm matrices are column major
+    conversion_ = glm::mat4( ys,   ys,  ys,  0.f,
+                             0.f, -gu,  bu,  0.f,
+                             rv,  -gv,  0.f, 0.f,
+                             -ys * yo - rv * co,
+                             -ys * yo + (gu + gv) * co,
+                             -ys * yo - bu * co,  1.f );
+}
+
+void YuvConverter::convert(const GstVideoInfo &info, const guint8 *data, guint target)
+{
+    if ( target != target_ || width_ != GST_VIDEO_INFO_WIDTH(&info) || height_ != GST_VIDEO_INFO_HEIGHT(&info)
+         || !gst_video_colorimetry_is_equal(&colorimetry_, &GST_VIDEO_INFO_COLORIMETRY(&info)) )
+        configure(info, target);
+
+    // upload each plane (from memory or from bound pixel unpack buffer)
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (guint i = 0; i < 3; ++i) {
+        glBindTexture(GL_TEXTURE_2D, planes_[i]);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, GST_VIDEO_INFO_PLANE_STRIDE(&info, i));
+        const GLvoid *plane = reinterpret_cast<const GLvoid *>( reinterpret_cast<uintptr_t>(data) + GST_VIDEO_INFO_PLANE_OFFSET(&info, i) );
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, GST_VIDEO_INFO_COMP_WIDTH(&info, i), GST_VIDEO_INFO_COMP_HEIGHT(&info, i),
+                        GL_RED, GL_UNSIGNED_BYTE, plane);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    // draw in the target texture
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    RenderingAttrib attrib;
+    attrib.viewport = glm::ivec2(width_, height_);
+    attrib.clear_color = glm::vec4(0.f);
+    Rendering::manager().pushAttrib(attrib);
+    glDisable(GL_BLEND);
+
+    // render full screen with conversion shader reading the planes
+    program_->use();
+    program_->setUniform("iChannel2", 2);
+    program_->setUniform("iResolution", glm::vec3(width_, height_, 0.f));
+    program_->setUniform("iConversion", conversion_);
+    for (guint i = 0; i < 3; ++i) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, planes_[i]);
+    }
+    glBindVertexArray(vao_);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    for (guint i = 3; i > 0; --i) {
+        glActiveTexture(GL_TEXTURE0 + i - 1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    ShadingProgram::enduse();
+
+    Rendering::manager().popAttrib();
+    FrameBuffer::release();
+}
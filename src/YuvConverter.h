@@ -0,0 +1,43 @@
+#ifndef YUVCONVERTER_H
+#define YUVCONVERTER_H
+
+#include <glm/glm.hpp>
+#include <gst/video/video.h>
+
+class ShadingProgram;
+
+/**
+ * @brief The YuvConverter uploads the planes of an I420 video frame
+ * into single channel textures, and converts them on GPU into an
+ * RGBA texture. This avoids the colorspace conversion on CPU and
+ * uploads 12 bits per pixel instead of 32.
+ */
+class YuvConverter
+{
+public:
+    YuvConverter();
+    ~YuvConverter();
+
+    // format of frames to negotiate with gstreamer
+    static const char *format() { return "I420"; }
+
+    // Upload the frame given by data and render it into the target RGBA texture,
+    // with the strides, colorimetry and range of the video info of the frame.
+    // If a pixel unpack buffer is bound, data is an offset in the buffer (nullptr for 0).
+    // Must be called in OpenGL context
+    void convert(const GstVideoInfo &info, const guint8 *data, guint target);
+
+private:
+    void configure(const GstVideoInfo &info, guint target);
+
+    guint width_, height_;
+    guint target_;
+    guint planes_[3];
+    guint framebuffer_;
+    guint vao_;
+    GstVideoColorimetry colorimetry_;
+    glm::mat4 conversion_;
+    ShadingProgram *program_;
+};
+
+#endif // YUVCONVERTER_H
@@ -32,6 +32,10 @@
 #include "Connection.h"
 #include "Metronome.h"
 #include "Audio.h"
+#include "MediaInfoCache.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "Benchmark.h"
 
 #if defined(APPLE)
 extern "C"{
@@ -73,6 +77,10 @@ int main(int argc, char *argv[])
     int helpRequested = 0;
     int fontsizeRequested = 0;
     std::string settingsRequested;
+    std::string logfileRequested;
+    float traceRequested = 0.f;
+    int benchmarkRequested = 0;
+    Benchmark::Configuration benchmark;
     int ret = -1;
 
     for (int i = 1; i < argc; ++i) {
@@ -93,6 +101,49 @@ int main(int argc, char *argv[])
                 fprintf(stderr, "Error: filename missing after --settings\n");
                 helpRequested = 1;
             }
+        } else if (strcmp(argv[i], "--logfile") == 0 || strcmp(argv[i], "-G") == 0) {
+            // get log file argument
+            if (i + 1 < argc) {
+                logfileRequested = argv[i + 1];
+                i++; // Skip the next argument since it's already processed
+            } else {
+                fprintf(stderr, "Error: filename missing after --logfile\n");
+                helpRequested = 1;
+            }
+        } else if (strcmp(argv[i], "--trace") == 0 || strcmp(argv[i], "-P") == 0) {
+            // get trace duration argument
+            if (i + 1 < argc) {
+                traceRequested = atof(argv[i + 1]);
+                i++; // Skip the next argument since it's already processed
+            } else {
+                fprintf(stderr, "Error: duration missing after --trace\n");
+                helpRequested = 1;
+            }
+        } else if (strcmp(argv[i], "--benchmark") == 0 || strcmp(argv[i], "-B") == 0) {
+            // get benchmark duration argument, in frames or in seconds (e.g. 10s)
+            benchmarkRequested = 1;
+            if (i + 1 < argc) {
+                const char *d = argv[i + 1];
+                if (d[0] != '\0' && d[strlen(d) - 1] == 's')
+                    benchmark.seconds = atof(d);
+                else
+                    benchmark.frames = atoi(d);
+                i++; // Skip the next argument since it's already processed
+            } else {
+                fprintf(stderr, "Error: duration missing after --benchmark\n");
+                helpRequested = 1;
+            }
+        } else if (strcmp(argv[i], "--framerate") == 0 || strcmp(argv[i], "-R") == 0) {
+            // get fixed framerate argument
+            if (i + 1 < argc) {
+                benchmark.fps = atof(argv[i + 1]);
+                i++; // Skip the next argument since it's already processed
+            } else {
+                fprintf(stderr, "Error: framerate missing after --framerate\n");
+                helpRequested = 1;
+            }
+        } else if (strcmp(argv[i], "--record") == 0 || strcmp(argv[i], "-O") == 0) {
+            benchmark.record = true;
         } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-H") == 0) {
             helpRequested = 1;
         } else if (strcmp(argv[i], "--fontsize") == 0 || strcmp(argv[i], "-F") == 0) {
@@ -147,18 +198,29 @@ int main(int argc, char *argv[])
 
     if (helpRequested) {
         printf("Usage: %s [-H, --help] [-V, --version] [-F, --fontsize] [-L, --headless]\n"
-               "               [-S, --settings] [-T, --test] [-C, --clean] [filename]\n",
+               "               [-S, --settings] [-G, --logfile] [-P, --trace] [-T, --test] [-C, --clean]\n"
+               "               [-B, --benchmark] [-R, --framerate] [-O, --record] [filename]\n",
                argv[0]);
         printf("Options:\n");
         printf("  --help       : Display usage information\n");
         printf("  --version    : Display version information\n");
         printf("  --fontsize   : Force rendering font size to specified value, e.g., '-F 25'\n");
         printf("  --settings   : Run with given settings file, e.g., '-S settingsfile.xml'\n");
+        printf("  --logfile    : Also write logs to given file, e.g., '-G vimix.log'\n");
+        printf("  --trace      : Save a profiling trace of the first seconds, e.g., '-P 10'\n");
         printf("  --headless   : Run without GUI (only if output windows configured)\n");
         printf("  --test       : Run rendering test and return\n");
         printf("  --clean      : Reset user settings\n");
+        printf("  --benchmark  : Render session without display for frames or seconds, e.g., '-B 600' or '-B 10s'\n");
+        printf("  --framerate  : Benchmark with fixed time step at given framerate, e.g., '-R 60'\n");
+        printf("  --record     : Benchmark recording frames in a video file\n");
         printf("Filename:\n");
         printf("  vimix session file (.mix extension)\n");
+        printf("  or name of benchmark reference session (all if omitted):");
+        std::list<std::string> references = Benchmark::references();
+        for (auto r = references.begin(); r != references.end(); ++r)
+            printf(" %s", r->c_str());
+        printf("\n");
         ret = 0;ret = 0;
     }
 
@@ -168,12 +230,37 @@ int main(int argc, char *argv[])
     if (!_openfile.empty())
         printf("Openning '%s' ...\n", _openfile.c_str());
 
+    ///
+    /// Logs
+    ///
+    Log::SetThreadName("main");
+    if ( !logfileRequested.empty() && !Log::SetFile(logfileRequested) )
+        fprintf(stderr, "Error: cannot write logs to %s\n", logfileRequested.c_str());
+
     ///
     /// Settings
     ///
     Settings::Load( settingsRequested );
     Settings::application.executable = std::string(argv[0]);
 
+    ///
+    /// BENCHMARK (offscreen, without user interface)
+    ///
+    if (benchmarkRequested) {
+        const Settings::WindowConfig &winset = Settings::application.windows[0];
+        if ( !Rendering::manager().initHeadless( glm::ivec2(winset.w, winset.h) ) )
+            return 1;
+        gst_debug_set_default_threshold (GST_LEVEL_ERROR);
+        if (traceRequested > 0.f)
+            Profiler::manager().trace(traceRequested);
+        benchmark.session = _openfile;
+        ret = Benchmark::run(benchmark);
+        Mixer::manager().clear();
+        Rendering::manager().terminate();
+        Log::SetFile("");
+        return ret;
+    }
+
     /// lock to inform an instance is running
     Settings::Lock();
 
@@ -223,6 +310,11 @@ int main(int argc, char *argv[])
     if ( Settings::application.accept_audio )
         Audio::manager().initialize();
 
+    ///
+    /// MEDIA INFO CACHE INIT
+    ///
+    MediaInfoCache::manager().init();
+
     // callbacks to draw
     Rendering::manager().pushBackDrawCallback(prepare);
     Rendering::manager().pushBackDrawCallback(drawScene);
@@ -235,6 +327,10 @@ int main(int argc, char *argv[])
     // try to load file given in argument
     Mixer::manager().load(_openfile);
 
+    // profiling trace
+    if (traceRequested > 0.f)
+        Profiler::manager().trace(traceRequested);
+
     ///
     /// Main LOOP
     ///
@@ -251,6 +347,11 @@ int main(int argc, char *argv[])
     ///
     Mixer::manager().clear();
 
+    ///
+    /// MEDIA INFO CACHE TERMINATE
+    ///
+    MediaInfoCache::manager().terminate();
+
     ///
     /// RENDERING TERMINATE
     ///
@@ -279,6 +380,9 @@ int main(int argc, char *argv[])
     ///
     Settings::Save(UserInterface::manager().Runtime());
 
+    /// stop writing logs
+    Log::SetFile("");
+
     /// ok
     return 0;
 }
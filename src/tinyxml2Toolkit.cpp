@@ -27,6 +27,16 @@ using namespace tinyxml2;
 #include <glm/gtc/matrix_access.hpp>
 
 #include <string>
+#include <vector>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "SystemToolkit.h"
 #include "Log.h"
@@ -194,16 +204,28 @@ bool tinyxml2::XMLElementDecodeArray(const XMLElement *elem, void *array, uint a
     elem->QueryUnsignedAttribute("len", &len);
     if (len == arraysize)
     {
-        // read and decode the text field in <array>
-        gsize   decoded_size = 0;
-        guchar *decoded_array = g_base64_decode(elem->GetText(), &decoded_size);
-
         // if data is z-compressed (zbytes size is indicated)
         uint zbytes = 0;
         elem->QueryUnsignedAttribute("zbytes", &zbytes);
+
+        // read raw data of a binary container (see XMLFromBinary)
+        // or decode the base64 text field in <array>
+        gsize   decoded_size = 0;
+        guchar *decoded_array = nullptr;
+        const guchar *data = nullptr;
+        const XMLNode *content = elem->FirstChild();
+        if ( content && content->GetUserData() ) {
+            data = static_cast<const guchar *>( content->GetUserData() );
+            decoded_size = zbytes > 0 ? zbytes : len;
+        }
+        else {
+            decoded_array = g_base64_decode(elem->GetText(), &decoded_size);
+            data = decoded_array;
+        }
+
         if ( zbytes > 0) {
             // sanity check 1: decoded data size must match the buffer size
-            if ( decoded_array && zbytes == (uint) decoded_size ) {
+            if ( data && zbytes == (uint) decoded_size ) {
 
                 // allocate a temporary array for decompressing data
                 uLong  uncompressed_size = len;
@@ -211,7 +233,7 @@ bool tinyxml2::XMLElementDecodeArray(const XMLElement *elem, void *array, uint a
 
                 // zlib uncompress ((Bytef *dest, uLongf *destLen, const Bytef *source, uLong sourceLen));
                 uncompress((Bytef *)uncompressed_array, &uncompressed_size,
-                           (Bytef *)decoded_array, (uLong) zbytes) ;
+                           (const Bytef *)data, (uLong) zbytes) ;
 
                 // sanity check 2: decompressed data size must match array size
                 if ( uncompressed_array && len == uncompressed_size ){
@@ -228,9 +250,9 @@ bool tinyxml2::XMLElementDecodeArray(const XMLElement *elem, void *array, uint a
         // data is not z-compressed
         else {
             // copy the decoded data
-            if ( decoded_array && len == decoded_size ) {
+            if ( data && len == decoded_size ) {
                 // copy to target array
-                memcpy(array, decoded_array, len);
+                memcpy(array, data, len);
                 // success
                 ret = true;
             }
@@ -243,7 +265,501 @@ bool tinyxml2::XMLElementDecodeArray(const XMLElement *elem, void *array, uint a
     return ret;
 }
 
-bool tinyxml2::XMLSaveDoc(XMLDocument * const doc, std::string filename)
+//
+// Binary container of an XML tree
+//
+// header   { 'VMXB', version, number of chunks, reserved }
+// toc      { chunk id, reserved, offset, size } for each chunk
+// 'STRS'   count, offset of each string, null terminated strings
+// 'NODE'   count of top level nodes, then nodes in depth first order:
+//          { type, flags, number of attributes, value, number of children }
+//          followed by { name, value } string indices of attributes
+// 'BLOB'   count, { offset, size } of each blob, raw data
+//
+// Chunks are aligned on 8 bytes from the beginning of the file.
+//
+#define BINARY_VERSION 1
+#define BINARY_MAX_DEPTH 256
+
+namespace {
+
+const char binary_magic[4] = {'V','M','X','B'};
+const char chunk_strings[4] = {'S','T','R','S'};
+const char chunk_nodes[4]   = {'N','O','D','E'};
+const char chunk_blobs[4]   = {'B','L','O','B'};
+
+typedef enum {
+    BINARY_ELEMENT = 1,
+    BINARY_TEXT,
+    BINARY_CDATA,
+    BINARY_COMMENT,
+    BINARY_DECLARATION,
+    BINARY_UNKNOWN,
+    BINARY_BLOB
+} BinaryNodeType;
+
+struct BinaryHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t chunks;
+    uint32_t reserved;
+};
+
+struct BinaryChunk {
+    char id[4];
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct BinaryNode {
+    uint8_t  type;
+    uint8_t  flags;
+    uint16_t attributes;
+    uint32_t value;
+    uint32_t children;
+};
+
+struct BinaryBlob {
+    uint64_t offset;
+    uint64_t size;
+};
+
+template<typename T>
+void append(std::string &out, const T &v)
+{
+    out.append( reinterpret_cast<const char *>(&v), sizeof(T) );
+}
+
+void align(std::string &out)
+{
+    out.resize( (out.size() + 7) & ~((size_t) 7), '\0' );
+}
+
+class BinaryWriter
+{
+public:
+    BinaryWriter() : blob_count_(0) {}
+
+    void add(const XMLNode *node)
+    {
+        BinaryNode n = { 0, 0, 0, 0, 0 };
+        const XMLElement *elem = node->ToElement();
+        const XMLText *text = node->ToText();
+
+        if (elem) {
+            n.type = BINARY_ELEMENT;
+            n.value = string(elem->Name());
+            for (const XMLAttribute *a = elem->FirstAttribute(); a && n.attributes < UINT16_MAX; a = a->Next())
+                ++n.attributes;
+            for (const XMLNode *c = node->FirstChild(); c; c = c->NextSibling())
+                ++n.children;
+        }
+        else if (text) {
+            // base64 text of arrays is stored as raw blob
+            std::string blob;
+            if ( !text->CData() && node->Parent() && node->Parent()->ToElement()
+                 && strcmp(node->Parent()->ToElement()->Name(), "array") == 0
+                 && decode(text->Value(), blob) ) {
+                n.type = BINARY_BLOB;
+                n.value = blob_count_++;
+                BinaryBlob b = { (uint64_t) blobs_.size(), (uint64_t) blob.size() };
+                append(blob_index_, b);
+                blobs_.append(blob);
+            }
+            else {
+                n.type = text->CData() ? BINARY_CDATA : BINARY_TEXT;
+                n.value = string(text->Value());
+            }
+        }
+        else {
+            if (node->ToComment())
+                n.type = BINARY_COMMENT;
+            else if (node->ToDeclaration())
+                n.type = BINARY_DECLARATION;
+            else
+                n.type = BINARY_UNKNOWN;
+            n.value = string(node->Value());
+        }
+
+        append(nodes_, n);
+
+        if (elem) {
+            uint16_t i = 0;
+            for (const XMLAttribute *a = elem->FirstAttribute(); a && i < n.attributes; a = a->Next(), ++i) {
+                append(nodes_, string(a->Name()));
+                append(nodes_, string(a->Value()));
+            }
+            for (const XMLNode *c = node->FirstChild(); c; c = c->NextSibling())
+                add(c);
+        }
+    }
+
+    std::string result(uint32_t count)
+    {
+        // fill the content of chunks
+        std::string chunks[3];
+        append(chunks[0], (uint32_t) string_offsets_.size());
+        for (auto o = string_offsets_.begin(); o != string_offsets_.end(); ++o)
+            append(chunks[0], *o);
+        chunks[0].append(strings_);
+
+        append(chunks[1], count);
+        chunks[1].append(nodes_);
+
+        append(chunks[2], blob_count_);
+        append(chunks[2], (uint32_t) 0);
+        chunks[2].append(blob_index_);
+        chunks[2].append(blobs_);
+
+        // header and table of content
+        std::string out;
+        BinaryHeader h;
+        memcpy(h.magic, binary_magic, 4);
+        h.version = BINARY_VERSION;
+        h.chunks = 3;
+        h.reserved = 0;
+        append(out, h);
+
+        const char *ids[3] = { chunk_strings, chunk_nodes, chunk_blobs };
+        uint64_t offset = sizeof(BinaryHeader) + 3 * sizeof(BinaryChunk);
+        for (int i = 0; i < 3; ++i) {
+            offset = (offset + 7) & ~((uint64_t) 7);
+            BinaryChunk c;
+            memcpy(c.id, ids[i], 4);
+            c.reserved = 0;
+            c.offset = offset;
+            c.size = chunks[i].size();
+            append(out, c);
+            offset += c.size;
+        }
+
+        // chunks
+        for (int i = 0; i < 3; ++i) {
+            align(out);
+            out.append(chunks[i]);
+        }
+
+        return out;
+    }
+
+private:
+    uint32_t string(const char *str)
+    {
+        std::string s(str ? str : "");
+        auto it = index_.find(s);
+        if (it != index_.end())
+            return it->second;
+
+        uint32_t i = string_offsets_.size();
+        string_offsets_.push_back( (uint32_t) strings_.size() );
+        strings_.append(s);
+        strings_.push_back('\0');
+        index_[s] = i;
+        return i;
+    }
+
+    static bool decode(const char *text, std::string &blob)
+    {
+        if (text == nullptr || *text == '\0')
+            return false;
+
+        // NB: base64 is decoded as by XMLElementDecodeArray, which gets the same bytes
+        gsize len = 0;
+        guchar *decoded = g_base64_decode(text, &len);
+        bool ret = ( decoded != nullptr && len > 0 );
+        if (ret)
+            blob.assign( reinterpret_cast<const char *>(decoded), len );
+        g_free(decoded);
+        return ret;
+    }
+
+    std::unordered_map<std::string, uint32_t> index_;
+    std::vector<uint32_t> string_offsets_;
+    std::string strings_;
+    std::string nodes_;
+    std::string blob_index_;
+    std::string blobs_;
+    uint32_t blob_count_;
+};
+
+class BinaryReader
+{
+public:
+    BinaryReader(bool raw) : strings_(nullptr), strings_size_(0), string_count_(0),
+        nodes_(nullptr), nodes_size_(0), cursor_(0),
+        blobs_(nullptr), blobs_size_(0), blob_count_(0), raw_(raw) {}
+
+    bool open(const char *data, size_t size)
+    {
+        if ( !XMLIsBinary(data, size) )
+            return false;
+
+        BinaryHeader h;
+        memcpy(&h, data, sizeof(BinaryHeader));
+        if ( h.version > BINARY_VERSION || h.chunks > (size - sizeof(BinaryHeader)) / sizeof(BinaryChunk) )
+            return false;
+
+        // read table of content (ignore unknown chunks)
+        for (uint32_t i = 0; i < h.chunks; ++i) {
+            BinaryChunk c;
+            memcpy(&c, data + sizeof(BinaryHeader) + i * sizeof(BinaryChunk), sizeof(BinaryChunk));
+            if ( c.offset > size || c.size > size - c.offset )
+                return false;
+            if ( memcmp(c.id, chunk_strings, 4) == 0 ) {
+                strings_ = data + c.offset;
+                strings_size_ = c.size;
+            }
+            else if ( memcmp(c.id, chunk_nodes, 4) == 0 ) {
+                nodes_ = data + c.offset;
+                nodes_size_ = c.size;
+            }
+            else if ( memcmp(c.id, chunk_blobs, 4) == 0 ) {
+                blobs_ = data + c.offset;
+                blobs_size_ = c.size;
+            }
+        }
+
+        // validate strings: the last one must be null terminated
+        if ( !strings_ || strings_size_ < sizeof(uint32_t) )
+            return false;
+        memcpy(&string_count_, strings_, sizeof(uint32_t));
+        if ( string_count_ > (strings_size_ - sizeof(uint32_t)) / sizeof(uint32_t) )
+            return false;
+        size_t text_offset = sizeof(uint32_t) * (1 + string_count_);
+        if ( string_count_ > 0 && ( text_offset >= strings_size_ || strings_[strings_size_ - 1] != '\0') )
+            return false;
+
+        // validate blobs
+        if ( blobs_ ) {
+            if ( blobs_size_ < 2 * sizeof(uint32_t) )
+                return false;
+            memcpy(&blob_count_, blobs_, sizeof(uint32_t));
+            if ( blob_count_ > (blobs_size_ - 2 * sizeof(uint32_t)) / sizeof(BinaryBlob) )
+                return false;
+        }
+
+        return nodes_ != nullptr;
+    }
+
+    bool read(XMLNode *parent)
+    {
+        uint32_t count = 0;
+        cursor_ = 0;
+        if ( !get(count) )
+            return false;
+        for (uint32_t i = 0; i < count; ++i) {
+            if ( !add(parent, 0) )
+                return false;
+        }
+        return true;
+    }
+
+private:
+    template<typename T>
+    bool get(T &v)
+    {
+        if ( cursor_ + sizeof(T) > nodes_size_ )
+            return false;
+        memcpy(&v, nodes_ + cursor_, sizeof(T));
+        cursor_ += sizeof(T);
+        return true;
+    }
+
+    const char *string(uint32_t i) const
+    {
+        if ( i >= string_count_ )
+            return nullptr;
+        uint32_t offset = 0;
+        memcpy(&offset, strings_ + sizeof(uint32_t) * (1 + i), sizeof(uint32_t));
+        size_t o = sizeof(uint32_t) * (1 + string_count_) + offset;
+        if ( o >= strings_size_ )
+            return nullptr;
+        return strings_ + o;
+    }
+
+    bool blob(uint32_t i, const char *&data, size_t &size) const
+    {
+        if ( i >= blob_count_ )
+            return false;
+        BinaryBlob b;
+        memcpy(&b, blobs_ + 2 * sizeof(uint32_t) + i * sizeof(BinaryBlob), sizeof(BinaryBlob));
+        size_t data_offset = 2 * sizeof(uint32_t) + blob_count_ * sizeof(BinaryBlob);
+        if ( b.offset > blobs_size_ - data_offset || b.size > blobs_size_ - data_offset - b.offset )
+            return false;
+        data = blobs_ + data_offset + b.offset;
+        size = b.size;
+        return true;
+    }
+
+    // size of the raw data of an <array> element
+    static size_t arraySize(const XMLNode *parent)
+    {
+        const XMLElement *elem = parent->ToElement();
+        uint len = 0, zbytes = 0;
+        if ( elem && strcmp(elem->Name(), "array") == 0 ) {
+            elem->QueryUnsignedAttribute("len", &len);
+            elem->QueryUnsignedAttribute("zbytes", &zbytes);
+        }
+        return zbytes > 0 ? zbytes : len;
+    }
+
+    bool add(XMLNode *parent, int depth)
+    {
+        BinaryNode n;
+        if ( depth > BINARY_MAX_DEPTH || !get(n) )
+            return false;
+
+        XMLDocument *doc = parent->GetDocument();
+        XMLNode *node = nullptr;
+
+        if ( n.type == BINARY_BLOB ) {
+            const char *data = nullptr;
+            size_t size = 0;
+            if ( !blob(n.value, data, size) )
+                return false;
+            // give the raw data to XMLElementDecodeArray
+            if ( raw_ && size > 0 && size == arraySize(parent) ) {
+                node = doc->NewText( "" );
+                node->SetUserData( const_cast<char *>(data) );
+            }
+            // or restore the base64 text
+            else {
+                gchar *encoded = g_base64_encode( (const guchar *) data, size);
+                node = doc->NewText( encoded );
+                g_free(encoded);
+            }
+        }
+        else {
+            const char *value = string(n.value);
+            if ( !value )
+                return false;
+
+            switch (n.type) {
+            case BINARY_ELEMENT: {
+                XMLElement *elem = doc->NewElement(value);
+                for (uint16_t i = 0; i < n.attributes; ++i) {
+                    uint32_t a[2];
+                    if ( !get(a[0]) || !get(a[1]) || !string(a[0]) || !string(a[1]) ) {
+                        doc->DeleteNode(elem);
+                        return false;
+                    }
+                    elem->SetAttribute( string(a[0]), string(a[1]) );
+                }
+                node = elem;
+            }
+                break;
+            case BINARY_TEXT:
+            case BINARY_CDATA: {
+                XMLText *text = doc->NewText(value);
+                text->SetCData( n.type == BINARY_CDATA );
+                node = text;
+            }
+                break;
+            case BINARY_COMMENT:
+                node = doc->NewComment(value);
+                break;
+            case BINARY_DECLARATION:
+                node = doc->NewDeclaration(value);
+                break;
+            case BINARY_UNKNOWN:
+                node = doc->NewUnknown(value);
+                break;
+            default:
+                return false;
+            }
+        }
+
+        parent->InsertEndChild(node);
+
+        for (uint32_t i = 0; i < n.children; ++i) {
+            if ( !add(node, depth + 1) )
+                return false;
+        }
+
+        return true;
+    }
+
+    const char *strings_;
+    size_t strings_size_;
+    uint32_t string_count_;
+    const char *nodes_;
+    size_t nodes_size_;
+    size_t cursor_;
+    const char *blobs_;
+    size_t blobs_size_;
+    uint32_t blob_count_;
+    bool raw_;
+};
+
+}
+
+std::string tinyxml2::XMLToBinary(const XMLNode *node)
+{
+    BinaryWriter writer;
+    uint32_t count = 0;
+
+    if (node) {
+        for (const XMLNode *c = node->FirstChild(); c; c = c->NextSibling(), ++count)
+            writer.add(c);
+    }
+
+    return writer.result(count);
+}
+
+bool tinyxml2::XMLFromBinary(XMLNode *parent, const char *data, size_t size, bool raw)
+{
+    if (parent == nullptr || data == nullptr)
+        return false;
+
+    BinaryReader reader(raw);
+    return reader.open(data, size) && reader.read(parent);
+}
+
+bool tinyxml2::XMLIsBinary(const char *data, size_t size)
+{
+    return data != nullptr && size >= sizeof(BinaryHeader) && memcmp(data, binary_magic, 4) == 0;
+}
+
+int tinyxml2::XMLLoadDoc(XMLDocument * const doc, const std::string &filename, bool *binary)
+{
+    if (binary)
+        *binary = false;
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return XML_ERROR_FILE_NOT_FOUND;
+
+    // read the magic number to know if the file is binary
+    char magic[4] = {0};
+    struct stat st;
+    if ( ::read(fd, magic, 4) != 4 || memcmp(magic, binary_magic, 4) != 0 || fstat(fd, &st) != 0 ) {
+        ::close(fd);
+        return doc->LoadFile(filename.c_str());
+    }
+
+    // map binary file in memory
+    XMLError ret = XML_ERROR_FILE_READ_ERROR;
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data != MAP_FAILED) {
+        doc->Clear();
+        if ( XMLFromBinary(doc, (const char *) data, st.st_size) ) {
+            ret = XML_SUCCESS;
+            if (binary)
+                *binary = true;
+        }
+        else {
+            doc->Clear();
+            ret = XML_ERROR_PARSING;
+        }
+        munmap(data, st.st_size);
+    }
+
+    return ret;
+}
+
+bool tinyxml2::XMLSaveDoc(XMLDocument * const doc, std::string filename, bool binary)
 {
     XMLDeclaration *pDec = doc->NewDeclaration();
     doc->InsertFirstChild(pDec);
@@ -252,6 +768,19 @@ bool tinyxml2::XMLSaveDoc(XMLDocument * const doc, std::string filename)
     XMLComment *pComment = doc->NewComment(s.c_str());
     doc->InsertEndChild(pComment);
 
+    // save session in binary
+    if (binary) {
+        std::string data = XMLToBinary(doc);
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        if ( file.is_open() )
+            file.write(data.data(), data.size());
+        if ( !file.good() ) {
+            Log::Info("Binary file %s could not be written.", filename.c_str());
+            return false;
+        }
+        return true;
+    }
+
     // save session
     XMLError eResult = doc->SaveFile(filename.c_str());
     return !XMLResultError(eResult);
@@ -10,6 +10,7 @@ namespace tinyxml2 {
 
 class XMLDocument;
 class XMLElement;
+class XMLNode;
 
 XMLElement *XMLElementFromGLM(XMLDocument *doc, glm::ivec2 vector);
 XMLElement *XMLElementFromGLM(XMLDocument *doc, glm::vec2 vector);
@@ -26,7 +27,18 @@ void XMLElementToGLM(const XMLElement *elem, glm::mat4 &matrix);
 XMLElement *XMLElementEncodeArray(XMLDocument *doc, const void *array, uint arraysize);
 bool XMLElementDecodeArray(const tinyxml2::XMLElement *elem, void *array, uint arraysize);
 
-bool XMLSaveDoc(tinyxml2::XMLDocument * const doc, std::string filename);
+// Binary container (VMXB) of an XML tree: versioned, with a table of contents
+// of chunks (strings, nodes, blobs) that are read directly from memory.
+// The text of <array> elements is stored as raw bytes instead of base64.
+// If raw, arrays are read by XMLElementDecodeArray directly in data (their
+// text is left empty): data must outlive the tree, which is not to be saved.
+std::string XMLToBinary(const XMLNode *node);
+bool XMLFromBinary(XMLNode *parent, const char *data, size_t size, bool raw = false);
+bool XMLIsBinary(const char *data, size_t size);
+
+// Load a document saved in XML or in binary (detected by content)
+int  XMLLoadDoc(tinyxml2::XMLDocument * const doc, const std::string &filename, bool *binary = nullptr);
+bool XMLSaveDoc(tinyxml2::XMLDocument * const doc, std::string filename, bool binary = false);
 bool XMLResultError(int result, bool verbose = true);
 
 }